@@ -31,4 +31,6 @@ union elem
 
 typedef bool(*ioopm_eq_function)(elem_t a, elem_t b);
 
-typedef unsigned int(*ioopm_hash_function)(elem_t key);
\ No newline at end of file
+typedef unsigned int(*ioopm_hash_function)(elem_t key);
+
+typedef int(*ioopm_cmp_function)(elem_t a, elem_t b);
\ No newline at end of file
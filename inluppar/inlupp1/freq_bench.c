@@ -0,0 +1,537 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "tokenizer.h"
+#include "writer.h"
+
+/// Generates corpora of words drawn from a Zipf distribution and times freq_count on them,
+/// reporting wall time, peak memory, words per second and the number of allocations. The
+/// words per second can be saved as a baseline and compared against later, failing when
+/// they fall by more than a threshold. Usage:
+///   ./freq_bench.out [--sizes 10M,1G] [--skews 1.0,1.2] [--vocabulary N] [--runs N]
+///                    [--dir DIR] [--program PATH] [--baseline FILE] [--save FILE]
+///                    [--threshold T] [-- freq_count options]
+/// Sizes may end with K, M or G. A corpus is generated once and reused while its file is
+/// left in DIR.
+
+#define Delimiters "+-#@()[]{}.,:;!? \t\n\r"
+#define Default_Sizes "10M"
+#define Default_Skews "1.0"
+#define Default_Vocabulary 1000000
+#define Default_Runs 3
+#define Default_Threshold 0.1
+#define Max_Corpora 64
+#define Max_Program_Args 64
+#define Write_Buffer_Size (1 << 20)
+#define Words_Per_Line 12
+
+typedef struct bench_options bench_options_t;
+typedef struct alias_table alias_table_t;
+typedef struct result result_t;
+
+struct bench_options
+{
+    char *sizes;
+    char *skews;
+    size_t vocabulary;
+    int runs;
+    char *dir;
+    char *program;
+    char *baseline;         // the file of earlier results to compare against, or NULL
+    char *save;             // the file to save the results to, or NULL
+    double threshold;       // the largest fall in words per second allowed, as a fraction
+    char **program_args;    // the options passed on to freq_count
+    int program_arg_count;
+};
+
+// Draws from a discrete distribution in constant time (Vose's alias method): pick a
+// column at random, then keep it with its chance or take its alias
+struct alias_table
+{
+    double *chance;
+    uint32_t *alias;
+    size_t size;
+};
+
+struct result
+{
+    char name[64];
+    size_t bytes;
+    size_t words;
+    double seconds;         // the fastest run
+    long peak_rss;          // in KiB, the highest of the runs
+    long long allocations;  // -1 if they could not be counted
+};
+
+static double seconds_since(struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// xorshift64*, good enough for corpora and the same on every machine
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545f4914f6cdd1dull;
+}
+
+static double random_fraction(uint64_t *state)
+{
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// The table for word i having probability proportional to 1 / (i + 1)^skew
+static alias_table_t *zipf_table_create(size_t size, double skew)
+{
+    alias_table_t *table = calloc(1, sizeof(alias_table_t));
+    double *weight = calloc(size, sizeof(double));
+    uint32_t *small = calloc(size, sizeof(uint32_t));
+    uint32_t *large = calloc(size, sizeof(uint32_t));
+    size_t small_count = 0;
+    size_t large_count = 0;
+    double sum = 0;
+
+    table->chance = calloc(size, sizeof(double));
+    table->alias = calloc(size, sizeof(uint32_t));
+    table->size = size;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        weight[i] = pow(i + 1, -skew);
+        sum += weight[i];
+    }
+    // scaled so that the average column holds 1
+    for (size_t i = 0; i < size; i++)
+    {
+        weight[i] *= size / sum;
+        if (weight[i] < 1)
+        {
+            small[small_count++] = i;
+        }
+        else
+        {
+            large[large_count++] = i;
+        }
+    }
+
+    // every small column is filled up from a large one
+    while (small_count > 0 && large_count > 0)
+    {
+        uint32_t low = small[--small_count];
+        uint32_t high = large[large_count - 1];
+
+        table->chance[low] = weight[low];
+        table->alias[low] = high;
+        weight[high] -= 1 - weight[low];
+        if (weight[high] < 1)
+        {
+            large_count--;
+            small[small_count++] = high;
+        }
+    }
+    // what is left is 1 up to rounding
+    while (large_count > 0)
+    {
+        table->chance[large[--large_count]] = 1;
+    }
+    while (small_count > 0)
+    {
+        table->chance[small[--small_count]] = 1;
+    }
+
+    free(large);
+    free(small);
+    free(weight);
+    return table;
+}
+
+static void zipf_table_destroy(alias_table_t *table)
+{
+    free(table->alias);
+    free(table->chance);
+    free(table);
+}
+
+static size_t zipf_draw(alias_table_t *table, uint64_t *state)
+{
+    size_t column = next_random(state) % table->size;
+    return random_fraction(state) < table->chance[column] ? column : table->alias[column];
+}
+
+// Makes up word i of the vocabulary from a hash of i: 1 to 12 lower case letters, short
+// words more likely, so that the frequent words tend to be short as in real text
+static size_t vocabulary_word(size_t i, char *word)
+{
+    uint64_t state = (i + 1) * 0x9e3779b97f4a7c15ull;
+    size_t length = 1 + next_random(&state) % 6 + next_random(&state) % 7;
+
+    for (size_t k = 0; k < length; k++)
+    {
+        word[k] = 'a' + next_random(&state) % 26;
+    }
+    return length;
+}
+
+// Writes a corpus of at least bytes bytes to path, with Words_Per_Line words per line
+// separated by spaces and now and then a comma or a full stop
+static bool corpus_generate(char *path, size_t bytes, double skew, size_t vocabulary)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0)
+    {
+        perror(path);
+        return false;
+    }
+
+    alias_table_t *table = zipf_table_create(vocabulary, skew);
+    ioopm_writer_t *writer = ioopm_writer_create(fd, Write_Buffer_Size);
+    uint64_t state = 42;
+    size_t written = 0;
+    char word[16];
+
+    for (size_t n = 1; written < bytes; n++)
+    {
+        size_t length = vocabulary_word(zipf_draw(table, &state), word);
+        uint64_t separator = next_random(&state) % 32;
+
+        word[length++] = n % Words_Per_Line == 0 ? '\n' : separator == 0 ? ',' : separator == 1 ? '.' : ' ';
+        ioopm_writer_bytes(writer, word, length);
+        written += length;
+    }
+
+    bool ok = ioopm_writer_destroy(writer);
+    zipf_table_destroy(table);
+    close(fd);
+    return ok;
+}
+
+static void skip_word(const char *word, size_t length, void *extra)
+{
+}
+
+// Counts the words of a file like freq_count does, for the words per second
+static size_t corpus_words(char *path)
+{
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    size_t words = 0;
+
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        char *text = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (text != MAP_FAILED)
+        {
+            ioopm_tokenizer_t *tokenizer = ioopm_tokenizer_create(Delimiters);
+
+            madvise(text, info.st_size, MADV_SEQUENTIAL);
+            words = ioopm_tokenize(tokenizer, text, info.st_size, skip_word, NULL);
+            ioopm_tokenizer_destroy(tokenizer);
+            munmap(text, info.st_size);
+        }
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return words;
+}
+
+// Runs freq_count once on a corpus with its output thrown away. Returns false if it
+// could not be run or failed.
+static bool run_program(bench_options_t *options, char *corpus, result_t *result)
+{
+    char *argv[Max_Program_Args + 3];
+    int argc = 0;
+    int counter[2];
+    bool counting = access("./malloc_count.so", R_OK) == 0 && pipe(counter) == 0;
+    struct timespec start;
+
+    argv[argc++] = options->program;
+    for (int i = 0; i < options->program_arg_count; i++)
+    {
+        argv[argc++] = options->program_args[i];
+    }
+    argv[argc++] = corpus;
+    argv[argc] = NULL;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pid_t child = fork();
+
+    if (child == 0)
+    {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+
+        if (counting)
+        {
+            char fd[16];
+            close(counter[0]);
+            snprintf(fd, sizeof(fd), "%d", counter[1]);
+            setenv("MALLOC_COUNT_FD", fd, 1);
+            setenv("LD_PRELOAD", "./malloc_count.so", 1);
+        }
+        execv(options->program, argv);
+        perror(options->program);
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    long long allocations = -1;
+
+    if (counting)
+    {
+        char text[32] = {0};
+        close(counter[1]);
+        // the count is written when the program exits, so this also waits for it
+        if (read(counter[0], text, sizeof(text) - 1) > 0)
+        {
+            allocations = atoll(text);
+        }
+        close(counter[0]);
+    }
+    if (child < 0 || wait4(child, &status, 0, &usage) < 0)
+    {
+        perror("freq-bench");
+        return false;
+    }
+
+    double seconds = seconds_since(&start);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "freq-bench: %s failed on %s\n", options->program, corpus);
+        return false;
+    }
+    if (result->seconds == 0 || seconds < result->seconds)
+    {
+        result->seconds = seconds;
+    }
+    if (usage.ru_maxrss > result->peak_rss)
+    {
+        result->peak_rss = usage.ru_maxrss;
+    }
+    result->allocations = allocations;
+    return true;
+}
+
+// Reads a size like 512K, 10M or 2G, returning 0 if text is not one
+static size_t parse_size(const char *text)
+{
+    char *end;
+    double size = strtod(text, &end);
+
+    switch (*end)
+    {
+    case 'K': size *= 1 << 10; end++; break;
+    case 'M': size *= 1 << 20; end++; break;
+    case 'G': size *= 1 << 30; end++; break;
+    }
+    return *end == '\0' && size >= 1 ? size : 0;
+}
+
+// Returns the words per second of a corpus in a baseline file, or 0 if it is not there
+static double baseline_lookup(char *path, char *name)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+    double found = 0;
+
+    if (f == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        char line_name[64];
+        double words_per_second;
+
+        if (line[0] != '#' && sscanf(line, "%63s %lf", line_name, &words_per_second) == 2 && strcmp(line_name, name) == 0)
+        {
+            found = words_per_second;
+        }
+    }
+    fclose(f);
+    return found;
+}
+
+static bool save_results(char *path, result_t *results, int count, bench_options_t *options)
+{
+    FILE *f = fopen(path, "w");
+
+    if (f == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    fprintf(f, "# corpus words-per-second, from %s", options->program);
+    for (int i = 0; i < options->program_arg_count; i++)
+    {
+        fprintf(f, " %s", options->program_args[i]);
+    }
+    fprintf(f, "\n");
+    for (int i = 0; i < count; i++)
+    {
+        fprintf(f, "%s %.0f\n", results[i].name, results[i].words / results[i].seconds);
+    }
+    return fclose(f) == 0;
+}
+
+// Reads the options, returning false for an unknown or malformed one
+static bool parse_options(int argc, char *argv[], bench_options_t *options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+
+        if (strcmp(argv[i], "--") == 0)
+        {
+            options->program_args = argv + i + 1;
+            options->program_arg_count = argc - i - 1;
+            return options->program_arg_count <= Max_Program_Args;
+        }
+        else if (strcmp(argv[i], "--sizes") == 0 && has_value)
+        {
+            options->sizes = argv[++i];
+        }
+        else if (strcmp(argv[i], "--skews") == 0 && has_value)
+        {
+            options->skews = argv[++i];
+        }
+        else if (strcmp(argv[i], "--vocabulary") == 0 && has_value)
+        {
+            options->vocabulary = parse_size(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--runs") == 0 && has_value)
+        {
+            options->runs = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--dir") == 0 && has_value)
+        {
+            options->dir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--program") == 0 && has_value)
+        {
+            options->program = argv[++i];
+        }
+        else if (strcmp(argv[i], "--baseline") == 0 && has_value)
+        {
+            options->baseline = argv[++i];
+        }
+        else if (strcmp(argv[i], "--save") == 0 && has_value)
+        {
+            options->save = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && has_value)
+        {
+            options->threshold = atof(argv[++i]);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return options->vocabulary > 0 && options->vocabulary <= UINT32_MAX && options->runs > 0;
+}
+
+int main(int argc, char *argv[])
+{
+    bench_options_t options = {.sizes = Default_Sizes, .skews = Default_Skews, .vocabulary = Default_Vocabulary,
+                               .runs = Default_Runs, .dir = "/tmp", .program = "./freq_count.out",
+                               .baseline = NULL, .save = NULL, .threshold = Default_Threshold,
+                               .program_args = NULL, .program_arg_count = 0};
+    result_t results[Max_Corpora];
+    int count = 0;
+    int status = 0;
+
+    if (!parse_options(argc, argv, &options))
+    {
+        puts("Usage: freq-bench [--sizes 10M,1G] [--skews 1.0,1.2] [--vocabulary N] [--runs N] [--dir DIR] [--program PATH] [--baseline FILE] [--save FILE] [--threshold T] [-- freq_count options]");
+        return 2;
+    }
+
+    printf("%-24s %9s %5s %10s %10s %12s %12s\n", "corpus", "MiB", "runs", "wall (s)", "peak MiB", "words/s", "allocations");
+
+    char sizes[256];
+    snprintf(sizes, sizeof(sizes), "%s", options.sizes);
+    for (char *size_text = strtok(sizes, ","); size_text != NULL; size_text = strtok(NULL, ","))
+    {
+        char skews[256];
+        char *skew_rest;
+        snprintf(skews, sizeof(skews), "%s", options.skews);
+
+        for (char *skew_text = strtok_r(skews, ",", &skew_rest); skew_text != NULL && count < Max_Corpora; skew_text = strtok_r(NULL, ",", &skew_rest))
+        {
+            size_t bytes = parse_size(size_text);
+            double skew = atof(skew_text);
+            result_t *result = &results[count];
+            char path[512];
+            struct stat info;
+
+            if (bytes == 0 || !(skew > 0))
+            {
+                fprintf(stderr, "freq-bench: bad size %s or skew %s\n", size_text, skew_text);
+                return 2;
+            }
+
+            *result = (result_t) {.seconds = 0, .peak_rss = 0, .allocations = -1};
+            snprintf(result->name, sizeof(result->name), "zipf-%s-%s-%zu", size_text, skew_text, options.vocabulary);
+            snprintf(path, sizeof(path), "%s/freq_bench-%s.txt", options.dir, result->name);
+
+            if ((stat(path, &info) != 0 || (size_t) info.st_size < bytes) && !corpus_generate(path, bytes, skew, options.vocabulary))
+            {
+                return 2;
+            }
+            stat(path, &info);
+            result->bytes = info.st_size;
+            result->words = corpus_words(path);
+
+            for (int run = 0; run < options.runs; run++)
+            {
+                if (!run_program(&options, path, result))
+                {
+                    return 2;
+                }
+            }
+
+            double words_per_second = result->words / result->seconds;
+            printf("%-24s %9.1f %5d %10.3f %10.1f %12.0f %12lld", result->name, result->bytes / 1048576.0, options.runs,
+                   result->seconds, result->peak_rss / 1024.0, words_per_second, result->allocations);
+
+            double baseline = options.baseline != NULL ? baseline_lookup(options.baseline, result->name) : 0;
+            if (baseline > 0)
+            {
+                double change = words_per_second / baseline - 1;
+                bool regressed = change < -options.threshold;
+
+                printf("  %+.1f%% vs baseline%s", 100 * change, regressed ? "  REGRESSION" : "");
+                status = regressed ? 1 : status;
+            }
+            printf("\n");
+            count++;
+        }
+    }
+
+    if (options.save != NULL && !save_results(options.save, results, count, &options))
+    {
+        status = 2;
+    }
+    return status;
+}
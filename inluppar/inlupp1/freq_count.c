@@ -2,28 +2,259 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
 #include "hash_table.h"
 #include "linked_list.h"
+#include "vector.h"
 #include "common.h"
 #include "iterator.h"
+#include "tokenizer.h"
+#include "thread_pool.h"
+#include "queue.h"
+#include "string_sort.h"
+#include "writer.h"
+#include "sketch.h"
+#include "word_index.h"
+#include "ngram.h"
+#include "radix_tree.h"
 
 #define Delimiters "+-#@()[]{}.,:;!? \t\n\r"
+#define Output_Buffer_Size (1 << 16)
+#define Stream_Block_Size (1 << 16)
+#define Approx_Top 100
+#define Stats_Chunk (1 << 20)
+#define Range_Min (1 << 16)
+#define Range_Max (1 << 23)
+#define Ranges_Per_Thread 8
 
-static int cmp_stringp(const void *p1, const void *p2)
+enum format
 {
-    return strcmp(*(char *const *)p1, *(char *const *)p2);
-}
+    FORMAT_PLAIN,   // word: count
+    FORMAT_TSV,     // word<tab>count
+    FORMAT_JSON,    // an array of {"word": word, "count": count}
+};
 
-void sort_keys(char *keys[], size_t no_keys)
+enum phase
 {
-    qsort(keys, no_keys, sizeof(char *), cmp_stringp);
-}
+    PHASE_READ,         // mapping files or reading standard input
+    PHASE_TOKENIZE,     // finding the words
+    PHASE_INSERT,       // hashing and counting the words
+    PHASE_COUNT,        // tokenizing and counting where they are not timed apart
+    PHASE_MERGE,        // merging the tables of the threads of -j
+    PHASE_EXTRACT,      // taking the counted words out into an array
+    PHASE_SORT,         // sorting the words or picking the most frequent
+    PHASE_OUTPUT,       // formatting and writing the counts
+    PHASES,
+};
+
+static const char *phase_names[] = {"read", "tokenize", "insert", "count", "merge", "extract", "sort", "output"};
+
+typedef struct options options_t;
+typedef struct slice slice_t;
+typedef struct count_task count_task_t;
+typedef struct merge_task merge_task_t;
+typedef struct parallel_count parallel_count_t;
+typedef struct file_range file_range_t;
+typedef struct file_queue file_queue_t;
+typedef struct range_task range_task_t;
+typedef struct top_list top_list_t;
+typedef struct stream stream_t;
+typedef struct approx_count approx_count_t;
+typedef struct counts counts_t;
+typedef enum format format_t;
+typedef enum phase phase_t;
+typedef struct slice_batch slice_batch_t;
+typedef struct stats stats_t;
+
+struct options
+{
+    bool mmap;      // map each file into memory and count the words straight from the mapping
+    bool normalize; // count words in lower case and with invalid UTF-8 replaced, implies mmap
+    bool parallel;  // count mapped files with several threads
+    size_t jobs;    // the number of threads, 0 for one per processor
+    size_t top;     // print only this many of the most frequent words, 0 for all words
+    format_t format;
+    size_t snapshot_words;      // print the counts so far every this many words read from standard input, 0 for never
+    double snapshot_seconds;    // and every this many seconds, 0 for never
+    bool approx;                // count in fixed memory with sketches instead of a table of every word
+    double epsilon;             // with --approx, how much too high a count may be as a fraction of all words
+    double delta;               // and the probability that it is off by more than that
+    double distinct_error;      // the relative standard error of the number of different words
+    char *index;                // the file the counts of each file are saved to and reused from, or NULL
+    size_t ngram;               // count sequences of this many words instead of single words, 1 for words
+    bool trie;                  // count in a radix tree that lists the words in order without sorting
+    stats_t *stats;             // collects the time of every phase with --stats, or NULL
+};
+
+// With --stats the time of every phase, and the numbers to give their rates
+struct stats
+{
+    double seconds[PHASES];
+    size_t laps[PHASES];        // how often every phase ran, since a short one may take 0 seconds
+    double start;               // when the run started
+    size_t bytes;               // read from files and standard input
+    size_t resizes;             // of the tables of -j, which are gone at the end
+};
+
+// A word in the text of a file, which is not '\0' terminated
+struct slice
+{
+    const char *start;
+    size_t length;
+};
+
+// The words found in a part of a file, before they are counted
+struct slice_batch
+{
+    slice_t *slices;
+    size_t count;
+    size_t capacity;
+};
+
+// The most frequent words seen so far, as a min-heap with the lowest ranked word at the root
+struct top_list
+{
+    ioopm_string_entry_t *heap;
+    size_t size;
+    size_t capacity;
+};
+
+// With --approx the words are counted by summaries of a fixed size instead of a table
+struct approx_count
+{
+    ioopm_count_min_t *counts;
+    ioopm_hyperloglog_t *distinct;
+    ioopm_heavy_hitters_t *top;     // the most frequent words with their estimated counts
+};
+
+// Where the words are counted: in ht, or by the one of the others that is not NULL
+struct counts
+{
+    ioopm_hash_table_t *ht;
+    approx_count_t *approx;     // with --approx
+    ioopm_ngram_count_t *ngram; // the n-grams instead of the words with --ngram
+    ioopm_radix_tree_t *tree;   // with --trie
+};
+
+// Standard input read in blocks, with the snapshots printed while it is counted
+struct stream
+{
+    counts_t *counts;
+    options_t *options;
+    size_t words;               // the words read so far
+    size_t next_snapshot;       // the number of words at the next snapshot by words
+    double next_deadline;       // the time of the next snapshot by time
+    bool failed;                // a snapshot could not be written
+};
+
+// With -j every file is split into one byte range per thread. Each thread counts its
+// range into tables of its own, one for every shard of the words, and each shard is
+// then merged by one thread.
+struct count_task
+{
+    ioopm_hash_table_t **shards;  // the tables of this task, one per shard
+    size_t shard_count;
+    ioopm_tokenizer_t *tokenizer;
+    const char *text;             // the range counted by this task
+    size_t length;
+};
+
+struct merge_task
+{
+    ioopm_hash_table_t **shard;   // the shard of the first task, the same shard of task t is t * stride further on
+    size_t stride;
+    size_t count;
+};
+
+struct parallel_count
+{
+    ioopm_thread_pool_t *pool;
+    size_t threads;
+    count_task_t *tasks;          // one per thread
+    ioopm_hash_table_t **tables;  // the shards of every task after each other
+};
+
+// With -j the files are cut into byte ranges that are shared out to the threads, each
+// file to the thread with the fewest bytes so far. Every thread counts the ranges in its
+// own deque in order, then steals the last ranges from the deques of the others, so the
+// end of a large file is counted by every thread instead of the one it was given to.
+struct file_range
+{
+    char *filename;
+    size_t start;                   // the range holds the words that start from start up to end
+    size_t end;
+    size_t owner;                   // the thread whose deque the range is in
+};
+
+struct file_queue
+{
+    file_range_t *ranges;           // the ranges of every thread after each other, in file order
+    size_t range_count;
+    ioopm_steal_deque_t **deques;   // the indexes of the ranges of every thread
+    size_t threads;
+};
+
+struct range_task
+{
+    file_queue_t *queue;
+    count_task_t *count;            // the tables of the thread
+    size_t thread;
+};
 
 static void free_keys(elem_t key, elem_t *value_ignored, void *extra)
 {
     free(key.string); 
 }
 
+static double monotonic_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// The time a phase starts, which is not read without --stats
+static double stats_now(stats_t *stats)
+{
+    return stats != NULL ? monotonic_seconds() : 0;
+}
+
+// Adds the time since start to a phase and returns the time now, when the next phase
+// starts
+static double stats_lap(stats_t *stats, phase_t phase, double start)
+{
+    if (stats == NULL)
+    {
+        return 0;
+    }
+
+    double now = monotonic_seconds();
+    stats->seconds[phase] += now - start;
+    stats->laps[phase]++;
+    return now;
+}
+
+// Adds the time since start to counting, for a file that was read and counted in one go
+static void stats_count_file(stats_t *stats, char *filename, double start)
+{
+    struct stat info;
+
+    if (stats != NULL)
+    {
+        stats_lap(stats, PHASE_COUNT, start);
+        stats->bytes += stat(filename, &info) == 0 ? info.st_size : 0;
+    }
+}
+
 void process_word(char *word, ioopm_hash_table_t *ht)
 {
     option_t *lookup_result = ioopm_hash_table_lookup(ht, (elem_t) {.string = word}); 
@@ -75,6 +306,157 @@ void process_file(char *filename, ioopm_hash_table_t *ht)
     fclose(f);
 }
 
+// The hash string_sum_hash gives the word of a slice
+static unsigned slice_sum_hash(const char *word, size_t length)
+{
+    unsigned result = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        result += word[i];
+    }
+    return result;
+}
+
+// Compares a stored word with the word of a slice, ordered like strcmp
+static int slice_cmp(elem_t key, elem_t probe)
+{
+    slice_t *slice = probe.void_ptr;
+    int cmp = strncmp(key.string, slice->start, slice->length);
+
+    return cmp != 0 ? cmp : key.string[slice->length] != '\0';
+}
+
+// Counts a word with a given hash in place, copying it only the first time it is seen
+static void count_slice(ioopm_hash_table_t *ht, unsigned hash, const char *word, size_t length)
+{
+    slice_t slice = {word, length};
+    elem_t *freq = ioopm_hash_table_find_with(ht, hash, (elem_t) {.void_ptr = &slice}, slice_cmp);
+
+    if (freq != NULL)
+    {
+        freq->integer++;
+    }
+    else
+    {
+        ioopm_hash_table_insert(ht, str_elem(strndup(word, length)), int_elem(1));
+    }
+}
+
+static void process_slice(const char *word, size_t length, void *extra)
+{
+    count_slice(extra, slice_sum_hash(word, length), word, length);
+}
+
+// Maps a file into memory for reading and advises the kernel it is read in order. With
+// populate the whole file is read in before returning. Returns NULL if the file is
+// empty, or cannot be mapped after printing why. Only regular files can be mapped, since
+// pipes and files like those in /proc have no size.
+static char *map_file(char *filename, size_t *length, bool populate)
+{
+    int fd = open(filename, O_RDONLY);
+    struct stat info;
+    char *text = NULL;
+
+    if (fd < 0 || fstat(fd, &info) < 0)
+    {
+        perror(filename);
+    }
+    else if (!S_ISREG(info.st_mode))
+    {
+        fprintf(stderr, "%s: Not a regular file, cannot be mapped\n", filename);
+    }
+    // an empty file cannot be mapped and has no words
+    else if (info.st_size > 0)
+    {
+        text = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE | (populate ? MAP_POPULATE : 0), fd, 0);
+
+        if (text == MAP_FAILED)
+        {
+            perror(filename);
+            text = NULL;
+        }
+        else
+        {
+            madvise(text, info.st_size, MADV_SEQUENTIAL);
+            *length = info.st_size;
+        }
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return text;
+}
+
+void process_file_mapped(char *filename, ioopm_hash_table_t *ht, ioopm_tokenizer_t *tokenizer)
+{
+    size_t length;
+    char *text = map_file(filename, &length, false);
+
+    if (text != NULL)
+    {
+        ioopm_tokenize(tokenizer, text, length, process_slice, ht);
+        munmap(text, length);
+    }
+}
+
+static void collect_slice(const char *word, size_t length, void *extra)
+{
+    slice_batch_t *batch = extra;
+
+    if (batch->count == batch->capacity)
+    {
+        batch->capacity = batch->capacity > 0 ? 2 * batch->capacity : 1024;
+        batch->slices = realloc(batch->slices, batch->capacity * sizeof(slice_t));
+    }
+    batch->slices[batch->count++] = (slice_t) {word, length};
+}
+
+// Counts a file like process_file_mapped, but reads all of it when it is mapped and
+// then finds the words of a part of it before counting them, so that reading,
+// tokenizing and counting are timed apart. The words are in the mapping, so this only
+// works for tokenizers that do not normalize.
+static void process_file_timed(char *filename, ioopm_hash_table_t *ht, ioopm_tokenizer_t *tokenizer, stats_t *stats)
+{
+    double start = monotonic_seconds();
+    size_t length;
+    char *text = map_file(filename, &length, true);
+    slice_batch_t batch = {.slices = NULL, .count = 0, .capacity = 0};
+
+    start = stats_lap(stats, PHASE_READ, start);
+    if (text == NULL)
+    {
+        return;
+    }
+    stats->bytes += length;
+
+    for (size_t done = 0; done < length;)
+    {
+        size_t end = length - done > Stats_Chunk ? done + Stats_Chunk : length;
+        while (end < length && !ioopm_tokenizer_is_delimiter(tokenizer, text[end]))
+        {
+            end++;
+        }
+
+        batch.count = 0;
+        ioopm_tokenize(tokenizer, text + done, end - done, collect_slice, &batch);
+        start = stats_lap(stats, PHASE_TOKENIZE, start);
+
+        for (size_t i = 0; i < batch.count; i++)
+        {
+            slice_t *slice = &batch.slices[i];
+            count_slice(ht, slice_sum_hash(slice->start, slice->length), slice->start, slice->length);
+        }
+        start = stats_lap(stats, PHASE_INSERT, start);
+        done = end;
+    }
+
+    munmap(text, length);
+    stats_lap(stats, PHASE_READ, start);
+    free(batch.slices);
+}
+
 unsigned string_sum_hash(elem_t e)
 {
     char *str = e.string;
@@ -92,52 +474,1434 @@ bool string_eq(elem_t e1, elem_t e2)
     return (strcmp(e1.string, e2.string) == 0);
 }
 
-int main(int argc, char *argv[])
+int string_cmp(elem_t e1, elem_t e2)
 {
-    ioopm_hash_table_t *ht = ioopm_hash_table_create((ioopm_hash_function) string_sum_hash, string_eq);
-    
-    if (argc > 1)
-    {   
-        for (int i = 1; i < argc; ++i)
+    return strcmp(e1.string, e2.string);
+}
+
+static ioopm_hash_table_t *word_table_create(void)
+{
+    return ioopm_hash_table_create_ordered((ioopm_hash_function) string_sum_hash, string_eq, string_cmp);
+}
+
+// Picks the shard of a word. The hash is mixed first since the tables of a shard use it
+// to pick buckets too.
+static size_t shard_of(unsigned hash, size_t shard_count)
+{
+    return ((hash * 2654435761u) >> 16) % shard_count;
+}
+
+static void process_slice_sharded(const char *word, size_t length, void *extra)
+{
+    count_task_t *task = extra;
+    unsigned hash = slice_sum_hash(word, length);
+
+    count_slice(task->shards[shard_of(hash, task->shard_count)], hash, word, length);
+}
+
+static void count_task_run(void *arg)
+{
+    count_task_t *task = arg;
+    ioopm_tokenize(task->tokenizer, task->text, task->length, process_slice_sharded, task);
+}
+
+// Adds the count of a word to another table, which takes over the key if it lacks the word
+static void merge_entry(elem_t key, elem_t *value, void *extra)
+{
+    ioopm_hash_table_t *target = extra;
+    elem_t *freq = ioopm_hash_table_find_with(target, string_sum_hash(key), key, string_cmp);
+
+    if (freq != NULL)
+    {
+        freq->integer += value->integer;
+        free(key.string);
+    }
+    else
+    {
+        ioopm_hash_table_insert(target, key, *value);
+    }
+}
+
+// Merges one shard of every task into the shard of the first task
+static void merge_task_run(void *arg)
+{
+    merge_task_t *task = arg;
+
+    for (size_t t = 1; t < task->count; t++)
+    {
+        ioopm_hash_table_t *source = task->shard[t * task->stride];
+
+        ioopm_hash_table_apply_to_all(source, merge_entry, task->shard[0]);
+        ioopm_hash_table_destroy(source);
+    }
+}
+
+static parallel_count_t *parallel_count_create(size_t threads, ioopm_tokenizer_t *tokenizer)
+{
+    parallel_count_t *counter = calloc(1, sizeof(parallel_count_t));
+    counter->pool = ioopm_thread_pool_create(threads);
+    counter->threads = ioopm_thread_pool_size(counter->pool);
+    counter->tasks = calloc(counter->threads, sizeof(count_task_t));
+    counter->tables = calloc(counter->threads * counter->threads, sizeof(ioopm_hash_table_t *));
+
+    for (size_t i = 0; i < counter->threads * counter->threads; i++)
+    {
+        counter->tables[i] = word_table_create();
+    }
+    for (size_t t = 0; t < counter->threads; t++)
+    {
+        counter->tasks[t].shards = counter->tables + t * counter->threads;
+        counter->tasks[t].shard_count = counter->threads;
+        counter->tasks[t].tokenizer = tokenizer;
+    }
+
+    return counter;
+}
+
+// Counts a mapped file with one range per thread. Every range but the last ends at a
+// delimiter, so no word is split between two ranges.
+void process_file_parallel(char *filename, parallel_count_t *counter, ioopm_tokenizer_t *tokenizer)
+{
+    size_t length;
+    char *text = map_file(filename, &length, false);
+
+    if (text == NULL)
+    {
+        return;
+    }
+
+    size_t start = 0;
+    for (size_t t = 0; t < counter->threads; t++)
+    {
+        size_t end = t + 1 == counter->threads ? length : length / counter->threads * (t + 1);
+
+        if (end < start)
         {
-            process_file(argv[i], ht);
+            end = start;
         }
-        
-        size_t ht_size = ioopm_hash_table_size(ht); 
+        while (end < length && !ioopm_tokenizer_is_delimiter(tokenizer, text[end]))
+        {
+            end++;
+        }
+
+        counter->tasks[t].text = text + start;
+        counter->tasks[t].length = end - start;
+        start = end;
+    }
+
+    ioopm_thread_pool_run(counter->pool, count_task_run, counter->tasks, sizeof(count_task_t), counter->threads);
+    munmap(text, length);
+}
+
+// Moves a position in text forward to just after a delimiter, unless it is at the start
+// or end, so that ranges cut at such positions never split a word
+static size_t word_boundary(ioopm_tokenizer_t *tokenizer, const char *text, size_t length, size_t position)
+{
+    while (position > 0 && position < length && !ioopm_tokenizer_is_delimiter(tokenizer, text[position - 1]))
+    {
+        position++;
+    }
+    return position < length ? position : length;
+}
+
+// Asks the kernel to read the next range of the same thread into the page cache in the
+// background, so that it is read while this one is counted
+static void read_ahead(file_queue_t *queue, file_range_t *range, int fd)
+{
+    file_range_t *next = range + 1;
+
+    if (next == queue->ranges + queue->range_count || next->owner != range->owner)
+    {
+        return;
+    }
+    if (next->filename == range->filename)
+    {
+        posix_fadvise(fd, next->start, next->end - next->start, POSIX_FADV_WILLNEED);
+        return;
+    }
+
+    int next_fd = open(next->filename, O_RDONLY);
+    if (next_fd >= 0)
+    {
+        posix_fadvise(next_fd, next->start, next->end - next->start, POSIX_FADV_WILLNEED);
+        close(next_fd);
+    }
+}
 
-        ioopm_list_t *list = ioopm_hash_table_keys(ht);
-        size_t list_size = ioopm_linked_list_size(list);
+// Counts the words that start in a range of a file. The whole file is mapped, which only
+// reads the pages that are touched.
+static void count_range(range_task_t *task, file_range_t *range)
+{
+    int fd = open(range->filename, O_RDONLY);
+    struct stat info;
+
+    if (fd < 0 || fstat(fd, &info) < 0)
+    {
+        perror(range->filename);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return;
+    }
+
+    size_t length = info.st_size;
+    // a file that has shrunk since it was cut into ranges may have lost this one
+    char *text = range->start < length ? mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+
+    if (text == MAP_FAILED)
+    {
+        perror(range->filename);
+    }
+    else if (text != NULL)
+    {
+        ioopm_tokenizer_t *tokenizer = task->count->tokenizer;
+        size_t start = word_boundary(tokenizer, text, length, range->start);
+        size_t end = word_boundary(tokenizer, text, length, range->end);
 
-        ioopm_list_iterator_t *iter = ioopm_list_iterator(list);
-        elem_t value = ioopm_iterator_current(iter);
-   
-        char *keys[list_size]; 
+        read_ahead(task->queue, range, fd);
+        ioopm_tokenize(tokenizer, text + start, end - start, process_slice_sharded, task->count);
+        munmap(text, length);
+    }
+    close(fd);
+}
 
-        for (int i = 0; i < list_size; i++)
+// Takes a range from the deque of another thread, trying each in turn
+static bool steal_range(file_queue_t *queue, size_t thief, elem_t *index)
+{
+    for (size_t i = 1; i < queue->threads; i++)
+    {
+        if (ioopm_steal_deque_steal(queue->deques[(thief + i) % queue->threads], index))
         {
-            keys[i] = value.string;
-            value = ioopm_iterator_next(iter);
+            return true;
         }
-           
-        sort_keys(keys, ht_size);
+    }
+    return false;
+}
+
+// Counts ranges until every deque is empty. All ranges are pushed before the threads
+// start, so a thread that finds no range to steal is done.
+static void range_task_run(void *arg)
+{
+    range_task_t *task = arg;
+    file_queue_t *queue = task->queue;
+    elem_t index;
+
+    while (ioopm_steal_deque_pop(queue->deques[task->thread], &index) || steal_range(queue, task->thread, &index))
+    {
+        count_range(task, &queue->ranges[index.unsigned_integer]);
+    }
+}
+
+// Counts every regular file with the threads of counter, in ranges of a size that gives
+// every thread several of them. Standard input and other files that cannot be mapped are
+// left to the caller. Returns the number of bytes in the files.
+static size_t process_files_parallel(char *files[], int count, parallel_count_t *counter)
+{
+    size_t threads = counter->threads;
+    size_t *sizes = calloc(count, sizeof(size_t));
+    size_t *owners = calloc(count, sizeof(size_t));
+    size_t *loads = calloc(threads, sizeof(size_t));        // the bytes given to every thread
+    size_t *firsts = calloc(threads + 1, sizeof(size_t));   // the first range of every thread
+    size_t total = 0;
+
+    for (int f = 0; f < count; f++)
+    {
+        struct stat info;
 
-        for (int i = 0; i < ht_size; i++)
+        if (strcmp(files[f], "-") == 0)
         {
-            option_t *lookup_result = ioopm_hash_table_lookup(ht, (elem_t) {.string = keys[i]}); 
-            
-            int freq = lookup_result->value.integer;        
-            printf("%s: %d\n", keys[i], freq);
-            free(lookup_result); 
+            continue;
         }
-        
-        ioopm_hash_table_apply_to_all(ht, free_keys, NULL);
-        ioopm_linked_list_destroy(list); 
-        ioopm_iterator_destroy(iter);
-    }   
-    else
+        if (stat(files[f], &info) < 0)
+        {
+            perror(files[f]);
+            continue;
+        }
+        if (!S_ISREG(info.st_mode))
+        {
+            continue;
+        }
+        sizes[f] = info.st_size;
+        total += sizes[f];
+    }
+
+    size_t range_size = total / (threads * Ranges_Per_Thread);
+    range_size = range_size < Range_Min ? Range_Min : range_size > Range_Max ? Range_Max : range_size;
+
+    for (int f = 0; f < count; f++)
+    {
+        size_t owner = 0;
+
+        for (size_t t = 1; t < threads; t++)
+        {
+            owner = loads[t] < loads[owner] ? t : owner;
+        }
+        owners[f] = owner;
+        loads[owner] += sizes[f];
+        firsts[owner + 1] += (sizes[f] + range_size - 1) / range_size;
+    }
+    for (size_t t = 0; t < threads; t++)
     {
-        puts("Usage: freq-count file1 ... filen");
+        firsts[t + 1] += firsts[t];
     }
 
-    ioopm_hash_table_destroy(ht);
-}   
\ No newline at end of file
+    file_queue_t queue = {.ranges = calloc(firsts[threads] + 1, sizeof(file_range_t)), .range_count = firsts[threads],
+                          .deques = calloc(threads, sizeof(ioopm_steal_deque_t *)), .threads = threads};
+    size_t *next = calloc(threads, sizeof(size_t));
+    memcpy(next, firsts, threads * sizeof(size_t));
+
+    for (int f = 0; f < count; f++)
+    {
+        for (size_t start = 0; start < sizes[f]; start += range_size)
+        {
+            size_t end = start + range_size < sizes[f] ? start + range_size : sizes[f];
+            queue.ranges[next[owners[f]]++] = (file_range_t) {.filename = files[f], .start = start, .end = end, .owner = owners[f]};
+        }
+    }
+
+    range_task_t *tasks = calloc(threads, sizeof(range_task_t));
+    for (size_t t = 0; t < threads; t++)
+    {
+        queue.deques[t] = ioopm_steal_deque_create(firsts[t + 1] - firsts[t]);
+        // the first range is pushed last, since the owner pops the last one pushed
+        for (size_t r = firsts[t + 1]; r > firsts[t]; r--)
+        {
+            ioopm_steal_deque_push(queue.deques[t], (elem_t) {.unsigned_integer = r - 1});
+        }
+        tasks[t] = (range_task_t) {.queue = &queue, .count = &counter->tasks[t], .thread = t};
+    }
+
+    ioopm_thread_pool_run(counter->pool, range_task_run, tasks, sizeof(range_task_t), threads);
+
+    for (size_t t = 0; t < threads; t++)
+    {
+        ioopm_steal_deque_destroy(queue.deques[t]);
+    }
+    free(tasks);
+    free(next);
+    free(queue.deques);
+    free(queue.ranges);
+    free(firsts);
+    free(loads);
+    free(owners);
+    free(sizes);
+    return total;
+}
+
+// Merges the shards in parallel, moves the counted words into ht and frees counter.
+// Returns the number of times the tables of the threads grew.
+static size_t parallel_count_finish(parallel_count_t *counter, ioopm_hash_table_t *ht)
+{
+    size_t resizes = 0;
+    size_t threads = counter->threads;
+    merge_task_t *merges = calloc(threads, sizeof(merge_task_t));
+
+    for (size_t s = 0; s < threads; s++)
+    {
+        merges[s] = (merge_task_t) {.shard = counter->tables + s, .stride = threads, .count = threads};
+    }
+    for (size_t i = 0; i < threads * threads; i++)
+    {
+        resizes += ioopm_hash_table_resizes(counter->tables[i]);
+    }
+    ioopm_thread_pool_run(counter->pool, merge_task_run, merges, sizeof(merge_task_t), threads);
+
+    // the shards hold different words, so this only moves them
+    for (size_t s = 0; s < threads; s++)
+    {
+        ioopm_hash_table_apply_to_all(counter->tables[s], merge_entry, ht);
+        ioopm_hash_table_destroy(counter->tables[s]);
+    }
+
+    free(merges);
+    free(counter->tables);
+    free(counter->tasks);
+    ioopm_thread_pool_destroy(counter->pool);
+    free(counter);
+    return resizes;
+}
+
+// Returns NULL if the count-min sketch does not fit in memory
+static approx_count_t *approx_count_create(options_t *options)
+{
+    approx_count_t *approx = calloc(1, sizeof(approx_count_t));
+    approx->counts = ioopm_count_min_create(options->epsilon, options->delta);
+    if (approx->counts == NULL)
+    {
+        free(approx);
+        return NULL;
+    }
+    approx->distinct = ioopm_hyperloglog_create(options->distinct_error);
+    approx->top = ioopm_heavy_hitters_create(options->top > 0 ? options->top : Approx_Top);
+
+    return approx;
+}
+
+static void approx_count_destroy(approx_count_t *approx)
+{
+    ioopm_count_min_destroy(approx->counts);
+    ioopm_hyperloglog_destroy(approx->distinct);
+    ioopm_heavy_hitters_destroy(approx->top);
+    free(approx);
+}
+
+// Counts a word in the summaries. The word is copied only if it is among the most
+// frequent ones.
+static void process_approx_word(const char *word, size_t length, void *extra)
+{
+    approx_count_t *approx = extra;
+    uint64_t hash = ioopm_sketch_hash(word, length);
+    uint32_t count = ioopm_count_min_add(approx->counts, hash, 1);
+
+    ioopm_hyperloglog_add(approx->distinct, hash);
+    ioopm_heavy_hitters_offer(approx->top, word, length, hash, count);
+}
+
+void process_file_approx(char *filename, approx_count_t *approx, ioopm_tokenizer_t *tokenizer)
+{
+    size_t length;
+    char *text = map_file(filename, &length, false);
+
+    if (text != NULL)
+    {
+        ioopm_tokenize(tokenizer, text, length, process_approx_word, approx);
+        munmap(text, length);
+    }
+}
+
+static void process_ngram_word(const char *word, size_t length, void *extra)
+{
+    ioopm_ngram_count_word(extra, word, length);
+}
+
+// Counts the n-grams of a mapped file, none of them spanning from the file before
+void process_file_ngram(char *filename, ioopm_ngram_count_t *ngram, ioopm_tokenizer_t *tokenizer)
+{
+    size_t length;
+    char *text = map_file(filename, &length, false);
+
+    ioopm_ngram_count_break(ngram);
+    if (text != NULL)
+    {
+        ioopm_tokenize(tokenizer, text, length, process_ngram_word, ngram);
+        munmap(text, length);
+    }
+}
+
+static void process_tree_word(const char *word, size_t length, void *extra)
+{
+    ioopm_radix_tree_add(extra, word, length, 1);
+}
+
+void process_file_tree(char *filename, ioopm_radix_tree_t *tree, ioopm_tokenizer_t *tokenizer)
+{
+    size_t length;
+    char *text = map_file(filename, &length, false);
+
+    if (text != NULL)
+    {
+        ioopm_tokenize(tokenizer, text, length, process_tree_word, tree);
+        munmap(text, length);
+    }
+}
+
+// Adds a count, which may be negative, to a word of ht
+static void add_word_count(const char *word, size_t length, int count, void *extra)
+{
+    ioopm_hash_table_t *ht = extra;
+    slice_t slice = {word, length};
+    elem_t *freq = ioopm_hash_table_find_with(ht, slice_sum_hash(word, length), (elem_t) {.void_ptr = &slice}, slice_cmp);
+
+    if (freq != NULL)
+    {
+        freq->integer += count;
+    }
+    else
+    {
+        ioopm_hash_table_insert(ht, str_elem(strndup(word, length)), int_elem(count));
+    }
+}
+
+static void add_entry(elem_t key, elem_t *value, void *extra)
+{
+    add_word_count(key.string, strlen(key.string), value->integer, extra);
+}
+
+static void collect_uncounted(elem_t key, elem_t *value, void *extra)
+{
+    if (value->integer <= 0)
+    {
+        ioopm_vector_append(extra, key);
+    }
+}
+
+// Removes the words whose counts were all subtracted
+static void remove_uncounted(ioopm_hash_table_t *ht)
+{
+    ioopm_vector_t *uncounted = ioopm_vector_create(NULL);
+    elem_t *keys = NULL;
+
+    ioopm_hash_table_apply_to_all(ht, collect_uncounted, uncounted);
+    keys = ioopm_vector_data(uncounted);
+    for (size_t i = 0; i < ioopm_vector_size(uncounted); i++)
+    {
+        ioopm_hash_table_remove(ht, keys[i]);
+        free(keys[i].string);
+    }
+    ioopm_vector_destroy(uncounted);
+}
+
+// Whether a file can be mapped. A file that cannot be found counts as mappable, so that
+// the error is reported where it is opened.
+static bool is_mappable(char *filename)
+{
+    struct stat info;
+    return stat(filename, &info) < 0 || S_ISREG(info.st_mode);
+}
+
+// The first file name given more than once, or NULL. Standard input may be repeated.
+static char *repeated_file(char *files[], int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        for (int j = i + 1; j < count && strcmp(files[i], "-") != 0; j++)
+        {
+            if (strcmp(files[i], files[j]) == 0)
+            {
+                return files[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+// Counts the files into ht, reusing the saved counts of unchanged files from the index
+// of the options and counting the others one at a time into tables of their own. The
+// index is then saved with the new counts. Standard input and other files that cannot be
+// mapped, such as pipes, are left out. Returns false if the index could not be saved.
+static bool process_indexed(char *files[], int count, ioopm_hash_table_t *ht, ioopm_tokenizer_t *tokenizer, options_t *options)
+{
+    ioopm_word_index_t *index = ioopm_word_index_open(options->index, options->normalize ? "normalize" : "plain");
+    ioopm_hash_table_t **counted = calloc(count + 1, sizeof(ioopm_hash_table_t *));
+    int counted_count = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(files[i], "-") == 0 || !is_mappable(files[i]) || ioopm_word_index_check(index, files[i]))
+        {
+            continue;
+        }
+
+        ioopm_hash_table_t *file_ht = word_table_create();
+        double start = stats_now(options->stats);
+        if (options->parallel)
+        {
+            parallel_count_t *counter = parallel_count_create(options->jobs, tokenizer);
+            process_file_parallel(files[i], counter, tokenizer);
+            parallel_count_finish(counter, file_ht);
+        }
+        else
+        {
+            process_file_mapped(files[i], file_ht, tokenizer);
+        }
+        stats_count_file(options->stats, files[i], start);
+
+        ioopm_word_index_replace(index, files[i], file_ht);
+        counted[counted_count++] = file_ht;
+    }
+
+    // the saved totals with the old counts of changed files taken away, and the new added
+    bool success = ioopm_word_index_totals(index, add_word_count, ht);
+    for (int i = 0; i < counted_count; i++)
+    {
+        ioopm_hash_table_apply_to_all(counted[i], add_entry, ht);
+    }
+    remove_uncounted(ht);
+
+    if (!success)
+    {
+        fprintf(stderr, "freq-count: %s is damaged\n", options->index);
+    }
+    success = success && ioopm_word_index_save(index, ht);
+
+    for (int i = 0; i < counted_count; i++)
+    {
+        ioopm_hash_table_apply_to_all(counted[i], free_keys, NULL);
+        ioopm_hash_table_destroy(counted[i]);
+    }
+    free(counted);
+    ioopm_word_index_close(index);
+    return success;
+}
+
+static void collect_entry(elem_t key, elem_t *value, void *extra)
+{
+    ioopm_string_entry_t **next = extra;
+    **next = (ioopm_string_entry_t) {.string = key.string, .value = *value};
+    (*next)++;
+}
+
+// Returns every word of ht with its count, in no particular order
+static ioopm_string_entry_t *all_entries(ioopm_hash_table_t *ht, size_t *count)
+{
+    *count = ioopm_hash_table_size(ht);
+    ioopm_string_entry_t *entries = calloc(*count + 1, sizeof(ioopm_string_entry_t));
+    ioopm_string_entry_t *next = entries;
+
+    ioopm_hash_table_apply_to_all(ht, collect_entry, &next);
+    return entries;
+}
+
+// Returns true if a ranks below b in a top list, where higher counts rank first and
+// equal counts in alphabetical order
+static bool ranks_below(ioopm_string_entry_t *a, ioopm_string_entry_t *b)
+{
+    int a_count = a->value.integer;
+    int b_count = b->value.integer;
+
+    return a_count != b_count ? a_count < b_count : strcmp(a->string, b->string) > 0;
+}
+
+static void heap_swap(ioopm_string_entry_t *heap, size_t i, size_t j)
+{
+    ioopm_string_entry_t tmp = heap[i];
+    heap[i] = heap[j];
+    heap[j] = tmp;
+}
+
+static void heap_sift_up(ioopm_string_entry_t *heap, size_t i)
+{
+    while (i > 0 && ranks_below(&heap[i], &heap[(i - 1) / 2]))
+    {
+        heap_swap(heap, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void heap_sift_down(ioopm_string_entry_t *heap, size_t size, size_t i)
+{
+    while (true)
+    {
+        size_t lowest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < size && ranks_below(&heap[left], &heap[lowest]))
+        {
+            lowest = left;
+        }
+        if (right < size && ranks_below(&heap[right], &heap[lowest]))
+        {
+            lowest = right;
+        }
+        if (lowest == i)
+        {
+            return;
+        }
+        heap_swap(heap, i, lowest);
+        i = lowest;
+    }
+}
+
+// Adds a word to a top list if it is not full, or if the word ranks above its lowest word
+static void top_list_offer(elem_t key, elem_t *value, void *extra)
+{
+    top_list_t *top = extra;
+    ioopm_string_entry_t entry = {.string = key.string, .value = *value};
+
+    if (top->size < top->capacity)
+    {
+        top->heap[top->size] = entry;
+        heap_sift_up(top->heap, top->size++);
+    }
+    else if (ranks_below(&top->heap[0], &entry))
+    {
+        top->heap[0] = entry;
+        heap_sift_down(top->heap, top->size, 0);
+    }
+}
+
+static top_list_t top_list_create(size_t k, size_t size)
+{
+    top_list_t top = {.size = 0, .capacity = k < size ? k : size};
+    top.heap = calloc(top.capacity + 1, sizeof(ioopm_string_entry_t));
+
+    return top;
+}
+
+// Returns the words of a top list, the most frequent first
+static ioopm_string_entry_t *top_list_finish(top_list_t top, size_t *count)
+{
+    // taking the lowest ranked word off the heap fills the array from the back
+    for (size_t n = top.size; n > 1; n--)
+    {
+        heap_swap(top.heap, 0, n - 1);
+        heap_sift_down(top.heap, n - 1, 0);
+    }
+
+    *count = top.size;
+    return top.heap;
+}
+
+// Returns the k most frequent words of ht, the most frequent first, found in one pass
+// over the table and without sorting all of its words
+static ioopm_string_entry_t *top_entries(ioopm_hash_table_t *ht, size_t k, size_t *count)
+{
+    top_list_t top = top_list_create(k, ioopm_hash_table_size(ht));
+
+    ioopm_hash_table_apply_to_all(ht, top_list_offer, &top);
+    return top_list_finish(top, count);
+}
+
+// Returns the k most frequent of an array of words, which is freed, the most frequent
+// first. count holds the number of words and is set to the number returned.
+static ioopm_string_entry_t *top_of_entries(ioopm_string_entry_t *entries, size_t k, size_t *count)
+{
+    top_list_t top = top_list_create(k, *count);
+
+    for (size_t i = 0; i < *count; i++)
+    {
+        top_list_offer(str_elem(entries[i].string), &entries[i].value, &top);
+    }
+    free(entries);
+    return top_list_finish(top, count);
+}
+
+// Writes words with their counts in a format
+static void write_entries(ioopm_writer_t *writer, ioopm_string_entry_t *entries, size_t count, format_t format)
+{
+    if (format == FORMAT_JSON)
+    {
+        ioopm_writer_string(writer, "[\n");
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (format == FORMAT_JSON)
+        {
+            ioopm_writer_string(writer, "{\"word\": ");
+            ioopm_writer_json_string(writer, entries[i].string);
+            ioopm_writer_string(writer, ", \"count\": ");
+            ioopm_writer_int(writer, entries[i].value.unsigned_integer);
+            ioopm_writer_string(writer, i + 1 < count ? "},\n" : "}\n");
+        }
+        else
+        {
+            ioopm_writer_string(writer, entries[i].string);
+            ioopm_writer_string(writer, format == FORMAT_TSV ? "\t" : ": ");
+            ioopm_writer_int(writer, entries[i].value.unsigned_integer);
+            ioopm_writer_char(writer, '\n');
+        }
+    }
+
+    if (format == FORMAT_JSON)
+    {
+        ioopm_writer_string(writer, "]\n");
+    }
+}
+
+static void write_double(ioopm_writer_t *writer, const char *format, double value)
+{
+    char text[64];
+
+    snprintf(text, sizeof(text), format, value);
+    ioopm_writer_string(writer, text);
+}
+
+// Writes the summary of approximate counts with their error bounds, as comment lines or
+// as the fields of a JSON object whose "top" field the words follow in
+static void write_approx_summary(ioopm_writer_t *writer, approx_count_t *approx, format_t format)
+{
+    uint64_t words = ioopm_count_min_total(approx->counts);
+    double distinct = ioopm_hyperloglog_estimate(approx->distinct);
+    double distinct_error = ioopm_hyperloglog_error(approx->distinct);
+    double epsilon;
+    double delta;
+
+    ioopm_count_min_error(approx->counts, &epsilon, &delta);
+    // a count may be too high by at most this many words, except with probability delta
+    uint64_t count_error = ceil(epsilon * words);
+
+    if (format == FORMAT_JSON)
+    {
+        ioopm_writer_string(writer, "{\"words\": ");
+        ioopm_writer_int(writer, words);
+        ioopm_writer_string(writer, ", \"distinct\": ");
+        ioopm_writer_int(writer, llround(distinct));
+        write_double(writer, ", \"distinct_error\": %g", distinct_error);
+        ioopm_writer_string(writer, ", \"count_error\": ");
+        ioopm_writer_int(writer, count_error);
+        write_double(writer, ", \"confidence\": %g", 1 - delta);
+        ioopm_writer_string(writer, ", \"sketch_bytes\": ");
+        ioopm_writer_int(writer, ioopm_count_min_bytes(approx->counts));
+        ioopm_writer_string(writer, ",\n\"top\": ");
+    }
+    else
+    {
+        ioopm_writer_string(writer, "# ");
+        ioopm_writer_int(writer, words);
+        ioopm_writer_string(writer, " words, about ");
+        ioopm_writer_int(writer, llround(distinct));
+        write_double(writer, " different (standard error %.2f%%)\n", 100 * distinct_error);
+        ioopm_writer_string(writer, "# counts are at most ");
+        ioopm_writer_int(writer, count_error);
+        write_double(writer, " too high with %.4g%% confidence, never too low\n", 100 * (1 - delta));
+    }
+}
+
+// Prints all words counted or the most frequent ones to standard output, as the options
+// say. With --approx the most frequent words are printed after a summary of the errors
+// instead, and with --ngram the n-grams. With snapshots every printout but JSON starts
+// with a line holding the number of words read from standard input. Returns false if
+// writing failed.
+static bool print_counts(counts_t *counts, options_t *options, size_t stream_words)
+{
+    ioopm_writer_t *writer = ioopm_writer_create(STDOUT_FILENO, Output_Buffer_Size);
+    approx_count_t *approx = counts->approx;
+    stats_t *stats = options->stats;
+    double start = stats_now(stats);
+    size_t count = 0;
+    ioopm_string_entry_t *entries = NULL;
+    char *ngram_text = NULL;
+
+    if (approx != NULL)
+    {
+        entries = ioopm_heavy_hitters_entries(approx->top, &count);
+        write_approx_summary(writer, approx, options->format);
+    }
+    else
+    {
+        bool in_table = counts->ngram == NULL && counts->tree == NULL;
+
+        if (counts->ngram != NULL)
+        {
+            entries = ioopm_ngram_count_entries(counts->ngram, &count, &ngram_text);
+        }
+        else if (counts->tree != NULL)
+        {
+            entries = ioopm_radix_tree_entries(counts->tree, &count);
+        }
+        else if (options->top == 0)
+        {
+            entries = all_entries(counts->ht, &count);
+        }
+        // the top list of the table takes no words out first
+        if (!in_table || options->top == 0)
+        {
+            start = stats_lap(stats, PHASE_EXTRACT, start);
+        }
+
+        // the top list of the table is picked straight from it and the words of the tree
+        // are in order already. The counts are sorted along with the words, so no word is
+        // looked up again.
+        if (options->top > 0)
+        {
+            entries = in_table ? top_entries(counts->ht, options->top, &count) : top_of_entries(entries, options->top, &count);
+            start = stats_lap(stats, PHASE_SORT, start);
+        }
+        else if (counts->tree == NULL)
+        {
+            ioopm_string_sort(entries, count);
+            start = stats_lap(stats, PHASE_SORT, start);
+        }
+    }
+
+    if ((options->snapshot_words > 0 || options->snapshot_seconds > 0) && options->format != FORMAT_JSON && approx == NULL)
+    {
+        ioopm_writer_string(writer, "# ");
+        ioopm_writer_int(writer, stream_words);
+        ioopm_writer_string(writer, " words\n");
+    }
+    write_entries(writer, entries, count, options->format);
+    if (approx != NULL && options->format == FORMAT_JSON)
+    {
+        ioopm_writer_string(writer, "}\n");
+    }
+
+    free(entries);
+    free(ngram_text);
+    bool written = ioopm_writer_destroy(writer);
+    stats_lap(stats, PHASE_OUTPUT, start);
+    return written;
+}
+
+static void stream_snapshot(stream_t *stream)
+{
+    if (!print_counts(stream->counts, stream->options, stream->words) && !stream->failed)
+    {
+        perror("freq-count: write");
+        stream->failed = true;
+    }
+}
+
+// Prints a snapshot by time if it is due
+static void stream_check_time(stream_t *stream)
+{
+    double interval = stream->options->snapshot_seconds;
+
+    if (interval > 0 && monotonic_seconds() >= stream->next_deadline)
+    {
+        stream_snapshot(stream);
+        stream->next_deadline = monotonic_seconds() + interval;
+    }
+}
+
+// Waits until fd can be read or the next snapshot by time is due, so that snapshots are
+// printed while the input is idle too
+static void stream_wait(int fd, stream_t *stream)
+{
+    struct pollfd input = {.fd = fd, .events = POLLIN};
+
+    while (stream->options->snapshot_seconds > 0)
+    {
+        double timeout = stream->next_deadline - monotonic_seconds();
+
+        if (timeout <= 0)
+        {
+            stream_check_time(stream);
+        }
+        else if (poll(&input, 1, (int) (timeout * 1000) + 1) != 0)
+        {
+            return;
+        }
+    }
+}
+
+static void process_stream_word(const char *word, size_t length, void *extra)
+{
+    stream_t *stream = extra;
+    counts_t *counts = stream->counts;
+
+    if (counts->approx != NULL)
+    {
+        process_approx_word(word, length, counts->approx);
+    }
+    else if (counts->ngram != NULL)
+    {
+        ioopm_ngram_count_word(counts->ngram, word, length);
+    }
+    else if (counts->tree != NULL)
+    {
+        ioopm_radix_tree_add(counts->tree, word, length, 1);
+    }
+    else
+    {
+        count_slice(counts->ht, slice_sum_hash(word, length), word, length);
+    }
+    stream->words++;
+
+    if (stream->words == stream->next_snapshot)
+    {
+        stream_snapshot(stream);
+        stream->next_snapshot += stream->options->snapshot_words;
+    }
+}
+
+// Counts the words read from fd into counts in blocks of a fixed size, and returns their
+// number. A word cut off at the end of a block is moved to the start of the buffer and finished by
+// the next block. The buffer only grows for words longer than itself.
+static size_t process_stream(int fd, counts_t *counts, ioopm_tokenizer_t *tokenizer, options_t *options)
+{
+    stream_t stream = {.counts = counts, .options = options, .words = 0};
+    stats_t *stats = options->stats;
+    size_t capacity = Stream_Block_Size;
+    char *buffer = malloc(capacity);
+    size_t kept = 0;
+
+    stream.next_snapshot = options->snapshot_words;
+    stream.next_deadline = monotonic_seconds() + options->snapshot_seconds;
+    if (counts->ngram != NULL)
+    {
+        ioopm_ngram_count_break(counts->ngram);
+    }
+
+    while (true)
+    {
+        stream_wait(fd, &stream);
+        // waiting for the input is not timed, only reading it
+        double start = stats_now(stats);
+        ssize_t got = read(fd, buffer + kept, capacity - kept);
+
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (got < 0)
+        {
+            perror("freq-count: read");
+        }
+        if (got <= 0)
+        {
+            break;
+        }
+        start = stats_lap(stats, PHASE_READ, start);
+        if (stats != NULL)
+        {
+            stats->bytes += got;
+        }
+
+        size_t length = kept + got;
+        size_t end = length;
+        while (end > 0 && !ioopm_tokenizer_is_delimiter(tokenizer, buffer[end - 1]))
+        {
+            end--;
+        }
+
+        ioopm_tokenize(tokenizer, buffer, end, process_stream_word, &stream);
+        stats_lap(stats, PHASE_COUNT, start);
+        kept = length - end;
+        memmove(buffer, buffer + end, kept);
+
+        if (kept == capacity)
+        {
+            capacity *= 2;
+            buffer = realloc(buffer, capacity);
+        }
+        stream_check_time(&stream);
+    }
+
+    double start = stats_now(stats);
+    ioopm_tokenize(tokenizer, buffer, kept, process_stream_word, &stream);
+    stats_lap(stats, PHASE_COUNT, start);
+    free(buffer);
+
+    return stream.words;
+}
+
+// Counts a file that cannot be mapped, such as a pipe, by reading it in blocks like
+// standard input, but without snapshots
+static void process_file_streamed(char *filename, counts_t *counts, ioopm_tokenizer_t *tokenizer, options_t *options)
+{
+    options_t quiet = *options;
+    int fd = open(filename, O_RDONLY);
+
+    if (fd < 0)
+    {
+        perror(filename);
+        return;
+    }
+    quiet.snapshot_words = 0;
+    quiet.snapshot_seconds = 0;
+    process_stream(fd, counts, tokenizer, &quiet);
+    close(fd);
+}
+
+// Counts a file in the way the options pick, except with -j which counts all files at once
+static void count_file(char *filename, counts_t *counts, ioopm_tokenizer_t *tokenizer, options_t *options)
+{
+    stats_t *stats = options->stats;
+    double start = stats_now(stats);
+    bool tokenized = options->mmap || options->normalize || options->parallel || counts->ngram != NULL || counts->tree != NULL || counts->approx != NULL;
+
+    // the modes that map files read the others as streams, which time themselves
+    if (tokenized && !is_mappable(filename))
+    {
+        process_file_streamed(filename, counts, tokenizer, options);
+        return;
+    }
+    if (counts->ngram != NULL)
+    {
+        process_file_ngram(filename, counts->ngram, tokenizer);
+    }
+    else if (counts->tree != NULL)
+    {
+        process_file_tree(filename, counts->tree, tokenizer);
+    }
+    else if (counts->approx != NULL)
+    {
+        process_file_approx(filename, counts->approx, tokenizer);
+    }
+    // the same words as process_file_mapped, but tokenized a part at a time before they
+    // are counted, so the phases can be timed apart. The words of a normalizing tokenizer
+    // are gone before they could be counted.
+    else if (options->mmap && stats != NULL && !ioopm_tokenizer_normalizes(tokenizer))
+    {
+        process_file_timed(filename, counts->ht, tokenizer, stats);
+        return;
+    }
+    else if (options->mmap || options->normalize)
+    {
+        process_file_mapped(filename, counts->ht, tokenizer);
+    }
+    else
+    {
+        process_file(filename, counts->ht);
+    }
+    stats_count_file(stats, filename, start);
+}
+
+static void sum_count(elem_t key_ignored, elem_t *value, void *extra)
+{
+    *(size_t *) extra += value->unsigned_integer;
+}
+
+// The number of words counted, counting repeats
+static size_t counted_words(counts_t *counts)
+{
+    size_t words = 0;
+
+    if (counts->approx != NULL)
+    {
+        return ioopm_count_min_total(counts->approx->counts);
+    }
+    if (counts->ngram != NULL)
+    {
+        return ioopm_ngram_count_total(counts->ngram);
+    }
+    if (counts->tree != NULL)
+    {
+        size_t count;
+        ioopm_string_entry_t *entries = ioopm_radix_tree_entries(counts->tree, &count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            words += entries[i].value.unsigned_integer;
+        }
+        free(entries);
+        return words;
+    }
+    ioopm_hash_table_apply_to_all(counts->ht, sum_count, &words);
+    return words;
+}
+
+// The number of different words, or n-grams with --ngram, counted
+static size_t counted_different(counts_t *counts)
+{
+    return counts->approx != NULL ? llround(ioopm_hyperloglog_estimate(counts->approx->distinct)) :
+           counts->ngram != NULL ? ioopm_ngram_count_size(counts->ngram) :
+           counts->tree != NULL ? ioopm_radix_tree_size(counts->tree) :
+           ioopm_hash_table_size(counts->ht);
+}
+
+// Prints the time and rate of every phase that ran, and the totals of the run, to
+// standard error. Reading and tokenizing are rated in bytes, counting in words and the
+// phases after counting in different words.
+static void print_stats(counts_t *counts, stats_t *stats)
+{
+    size_t words = counted_words(counts);
+    size_t different = counted_different(counts);
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    fprintf(stderr, "# %-10s %10s  %s\n", "phase", "seconds", "rate");
+    for (phase_t phase = 0; phase < PHASES; phase++)
+    {
+        double seconds = stats->seconds[phase];
+        bool in_bytes = phase == PHASE_READ || phase == PHASE_TOKENIZE || phase == PHASE_COUNT;
+        size_t amount = in_bytes ? stats->bytes : phase == PHASE_INSERT ? words : different;
+
+        if (stats->laps[phase] == 0)
+        {
+            continue;
+        }
+        fprintf(stderr, "# %-10s %10.6f", phase_names[phase], seconds);
+        if (seconds > 0)
+        {
+            fprintf(stderr, "  %.1f %s", amount / seconds / 1e6, in_bytes ? "MB/s" : "M words/s");
+        }
+        fputc('\n', stderr);
+    }
+    fprintf(stderr, "# %-10s %10.6f\n", "total", monotonic_seconds() - stats->start);
+    fprintf(stderr, "# %-18s%zu\n", "bytes read", stats->bytes);
+    fprintf(stderr, "# %-18s%zu\n", "words counted", words);
+    fprintf(stderr, "# %-18s%zu\n", counts->ngram != NULL ? "different n-grams" : "different words", different);
+    fprintf(stderr, "# %-18s%zu\n", "table resizes", stats->resizes + ioopm_hash_table_resizes(counts->ht));
+    fprintf(stderr, "# %-18s%ld KiB\n", "peak memory", usage.ru_maxrss);
+}
+
+// Reads a whole number of at least min, returning false if text is not one
+static bool parse_number(const char *text, long min, long *value)
+{
+    char *end;
+    *value = strtol(text, &end, 10);
+
+    return *end == '\0' && end != text && *value >= min;
+}
+
+// Reads a number above min and at most max, returning false if text is not one
+static bool parse_real(const char *text, double min, double max, double *value)
+{
+    char *end;
+    *value = strtod(text, &end);
+
+    return *end == '\0' && end != text && *value > min && *value <= max;
+}
+
+// Reads the options before the file names. Returns the index of the first file name,
+// or -1 for an unknown option.
+static int parse_options(int argc, char *argv[], options_t *options)
+{
+    int i = 1;
+
+    long number;
+
+    // a lone - is standard input
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++)
+    {
+        if (strcmp(argv[i], "--mmap") == 0)
+        {
+            options->mmap = true;
+        }
+        else if (strcmp(argv[i], "--normalize") == 0)
+        {
+            options->normalize = true;
+        }
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+        {
+            if (!parse_number(argv[++i], 0, &number))
+            {
+                return -1;
+            }
+            options->parallel = true;
+            options->jobs = number;
+        }
+        else if (strncmp(argv[i], "--format", 8) == 0)
+        {
+            // both --format tsv and --format=tsv
+            char *format = argv[i][8] == '=' ? argv[i] + 9 : argv[i][8] == '\0' && i + 1 < argc ? argv[++i] : "";
+
+            if (strcmp(format, "plain") == 0)
+            {
+                options->format = FORMAT_PLAIN;
+            }
+            else if (strcmp(format, "tsv") == 0)
+            {
+                options->format = FORMAT_TSV;
+            }
+            else if (strcmp(format, "json") == 0)
+            {
+                options->format = FORMAT_JSON;
+            }
+            else
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc)
+        {
+            if (!parse_number(argv[++i], 1, &number))
+            {
+                return -1;
+            }
+            options->top = number;
+        }
+        else if (strcmp(argv[i], "--snapshot-words") == 0 && i + 1 < argc)
+        {
+            if (!parse_number(argv[++i], 1, &number))
+            {
+                return -1;
+            }
+            options->snapshot_words = number;
+        }
+        else if (strcmp(argv[i], "--snapshot-seconds") == 0 && i + 1 < argc)
+        {
+            if (!parse_real(argv[++i], 0, HUGE_VAL, &options->snapshot_seconds))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "--index") == 0 && i + 1 < argc)
+        {
+            options->index = argv[++i];
+        }
+        else if (strcmp(argv[i], "--ngram") == 0 && i + 1 < argc)
+        {
+            if (!parse_number(argv[++i], 1, &number) || number > Ngram_Max)
+            {
+                return -1;
+            }
+            options->ngram = number;
+        }
+        else if (strcmp(argv[i], "--trie") == 0)
+        {
+            options->trie = true;
+        }
+        else if (strcmp(argv[i], "--stats") == 0)
+        {
+            if (options->stats == NULL)
+            {
+                options->stats = calloc(1, sizeof(stats_t));
+                options->stats->start = monotonic_seconds();
+            }
+        }
+        else if (strcmp(argv[i], "--approx") == 0)
+        {
+            options->approx = true;
+        }
+        // the rows of the sketch are no wider than for 1e-7
+        else if (strcmp(argv[i], "--epsilon") == 0 && i + 1 < argc)
+        {
+            if (!parse_real(argv[++i], 1e-7, 1, &options->epsilon))
+            {
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "--delta") == 0 && i + 1 < argc)
+        {
+            if (!parse_real(argv[++i], 0, 1, &options->delta))
+            {
+                return -1;
+            }
+        }
+        // the HyperLogLog counter is no more precise than about 0.2 %
+        else if (strcmp(argv[i], "--distinct-error") == 0 && i + 1 < argc)
+        {
+            if (!parse_real(argv[++i], 0.0025, 0.26, &options->distinct_error))
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            return -1;
+        }
+    }
+    // the sketches cannot take counts away, which updating an index needs, and neither
+    // they nor the index or tree hold n-grams, so at most one of those modes is used
+    int modes = options->approx + (options->index != NULL) + (options->ngram > 1) + options->trie;
+    return modes > 1 ? -1 : i;
+}
+
+int main(int argc, char *argv[])
+{
+    ioopm_hash_table_t *ht = word_table_create();
+    options_t options = {.mmap = false, .normalize = false, .parallel = false, .top = 0, .format = FORMAT_PLAIN, .snapshot_words = 0, .snapshot_seconds = 0,
+                         .approx = false, .epsilon = 0.0001, .delta = 0.01, .distinct_error = 0.01, .index = NULL, .ngram = 1, .trie = false, .stats = NULL};
+    counts_t counts = {.ht = ht, .approx = NULL, .ngram = NULL, .tree = NULL};
+    size_t stream_words = 0;
+    int status = 0;
+    int first_file = parse_options(argc, argv, &options);
+    // the index keeps one count per file name, so a repeated file would be counted once
+    char *repeated = first_file > 0 && options.index != NULL ? repeated_file(argv + first_file, argc - first_file) : NULL;
+    
+    // the sketch is made before anything is read, so that one too large is reported at once
+    approx_count_t *approx = first_file > 0 && first_file < argc && options.approx ? approx_count_create(&options) : NULL;
+    
+    if (repeated != NULL)
+    {
+        fprintf(stderr, "freq-count: %s is given more than once, which --index cannot count\n", repeated);
+        status = 1;
+    }
+    else if (options.approx && approx == NULL && first_file > 0 && first_file < argc)
+    {
+        fprintf(stderr, "freq-count: the sketch for --epsilon %g and --delta %g does not fit in memory\n", options.epsilon, options.delta);
+        status = 1;
+    }
+    else if (first_file > 0 && first_file < argc)
+    {   
+        ioopm_tokenizer_t *tokenizer = options.normalize ? ioopm_tokenizer_create_normalizing(Delimiters, NULL) : ioopm_tokenizer_create(Delimiters);
+
+        if (options.index != NULL)
+        {
+            if (!process_indexed(argv + first_file, argc - first_file, ht, tokenizer, &options))
+            {
+                status = 1;
+            }
+            for (int i = first_file; i < argc; ++i)
+            {
+                if (strcmp(argv[i], "-") == 0)
+                {
+                    stream_words += process_stream(STDIN_FILENO, &counts, tokenizer, &options);
+                }
+                // a pipe cannot be read again on the next run, so it is counted but not saved
+                else if (!is_mappable(argv[i]))
+                {
+                    process_file_streamed(argv[i], &counts, tokenizer, &options);
+                }
+            }
+        }
+        else
+        {
+            parallel_count_t *counter = NULL;
+
+            // the n-grams of a file follow each other across the ranges of -j, and the
+            // tree and the summaries are updated by one thread, so -j only counts words
+            // into tables
+            if (options.ngram > 1)
+            {
+                counts.ngram = ioopm_ngram_count_create(options.ngram);
+            }
+            else if (options.trie)
+            {
+                counts.tree = ioopm_radix_tree_create();
+            }
+            else if (options.approx)
+            {
+                counts.approx = approx;
+            }
+            else if (options.parallel)
+            {
+                counter = parallel_count_create(options.jobs, tokenizer);
+            }
+
+            for (int i = first_file; i < argc; ++i)
+            {
+                if (strcmp(argv[i], "-") == 0)
+                {
+                    stream_words += process_stream(STDIN_FILENO, &counts, tokenizer, &options);
+                }
+                // pipes are read as streams while the regular files wait for the threads
+                else if (counter == NULL || !is_mappable(argv[i]))
+                {
+                    count_file(argv[i], &counts, tokenizer, &options);
+                }
+            }
+
+            if (counter != NULL)
+            {
+                double start = stats_now(options.stats);
+                size_t bytes = process_files_parallel(argv + first_file, argc - first_file, counter);
+
+                start = stats_lap(options.stats, PHASE_COUNT, start);
+                if (options.stats != NULL)
+                {
+                    options.stats->bytes += bytes;
+                }
+                size_t resizes = parallel_count_finish(counter, ht);
+
+                stats_lap(options.stats, PHASE_MERGE, start);
+                if (options.stats != NULL)
+                {
+                    options.stats->resizes += resizes;
+                }
+            }
+        }
+        ioopm_tokenizer_destroy(tokenizer);
+
+        if (!print_counts(&counts, &options, stream_words))
+        {
+            perror("freq-count: write");
+            status = 1;
+        }
+        if (options.stats != NULL)
+        {
+            print_stats(&counts, options.stats);
+        }
+
+        if (counts.ngram != NULL)
+        {
+            ioopm_ngram_count_destroy(counts.ngram);
+        }
+        if (counts.tree != NULL)
+        {
+            ioopm_radix_tree_destroy(counts.tree);
+        }
+        
+        ioopm_hash_table_apply_to_all(ht, free_keys, NULL);
+    }   
+    // an unknown option, a bad value or no files
+    else
+    {
+        status = 1;
+        puts("Usage: freq-count [--mmap] [--normalize] [--index FILE] [--ngram N] [--trie] [--stats] [-j N] [--top K] [--format plain|tsv|json] [--snapshot-words N] [--snapshot-seconds T] [--approx [--epsilon E] [--delta D] [--distinct-error R]] file1 ... filen (- for standard input)");
+    }
+
+    if (approx != NULL)
+    {
+        approx_count_destroy(approx);
+    }
+    free(options.stats);
+    ioopm_hash_table_destroy(ht);
+    return status;
+}
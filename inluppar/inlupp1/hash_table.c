@@ -1,6 +1,7 @@
 #include "hash_table.h"
 #include "common.h"
 #include "linked_list.h"
+#include "vector.h"
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -31,6 +32,8 @@ struct hash_table
   size_t capacity;
   ioopm_hash_function hash_fun;
   ioopm_eq_function eq_fun;
+  ioopm_cmp_function cmp_fun; // NULL unless chains are kept ordered
+  size_t resizes;             // the number of times the buckets have grown
 };
 
 static unsigned get_bucket_index(ioopm_hash_table_t *ht, ioopm_hash_function hash_fun, elem_t key) 
@@ -50,6 +53,14 @@ ioopm_hash_table_t *ioopm_hash_table_create(ioopm_hash_function hash_fun, ioopm_
   return ht;
 }
 
+ioopm_hash_table_t *ioopm_hash_table_create_ordered(ioopm_hash_function hash_fun, ioopm_eq_function eq_fun, ioopm_cmp_function cmp_fun) 
+{
+  ioopm_hash_table_t *ht = ioopm_hash_table_create(hash_fun, eq_fun);
+  ht->cmp_fun = cmp_fun;
+
+  return ht;
+}
+
 static void entry_destroy(entry_t *entry) 
 {
   while (entry != NULL) 
@@ -78,7 +89,9 @@ static entry_t *entry_create(elem_t key, elem_t value, entry_t *next)
   return new_entry;
 }
 
-static entry_t *find_previous_entry_for_key(entry_t *bucket, elem_t key, ioopm_eq_function eq_fun) 
+// Returns the entry before the one holding key, or before the position where key
+// belongs if it is missing. For ordered chains the search stops at the first larger key.
+static entry_t *find_previous_entry_for_key(entry_t *bucket, elem_t key, ioopm_eq_function eq_fun, ioopm_cmp_function cmp_fun) 
 {
   entry_t *prev = bucket;
   
@@ -87,7 +100,14 @@ static entry_t *find_previous_entry_for_key(entry_t *bucket, elem_t key, ioopm_e
 
   while (current != NULL) 
   {
-    if (eq_fun(current->key, key)) 
+    if (cmp_fun != NULL) 
+    {
+      if (cmp_fun(current->key, key) >= 0) 
+      {
+        return prev;
+      }
+    }
+    else if (eq_fun(current->key, key)) 
     {
       return prev;
     }
@@ -98,6 +118,17 @@ static entry_t *find_previous_entry_for_key(entry_t *bucket, elem_t key, ioopm_e
   return prev;
 }
 
+// Checks if the entry returned after find_previous_entry_for_key holds key
+static bool entry_has_key(ioopm_hash_table_t *ht, entry_t *entry, elem_t key) 
+{
+  if (entry == NULL) 
+  {
+    return false;
+  }
+  // in unordered chains the search only stops at an equal key
+  return ht->cmp_fun == NULL || ht->eq_fun(entry->key, key);
+}
+
 static void resize(ioopm_hash_table_t *ht, size_t new_capacity) 
 {
   entry_t *new_buckets = calloc(new_capacity, sizeof(entry_t));
@@ -109,12 +140,17 @@ static void resize(ioopm_hash_table_t *ht, size_t new_capacity)
     while (current != NULL) 
     {
       size_t new_index = ht->hash_fun(current->key) % new_capacity;
-      entry_t *new_entry = entry_create(current->key, current->value, new_buckets[new_index].next);
-      
       entry_t *old_next = current->next; 
-      free(current); 
-      
-      new_buckets[new_index].next = new_entry;
+
+      // relink the entry, keeping the order of ordered chains
+      entry_t *prev = &new_buckets[new_index];
+      if (ht->cmp_fun != NULL) 
+      {
+        prev = find_previous_entry_for_key(prev, current->key, ht->eq_fun, ht->cmp_fun);
+      }
+      current->next = prev->next;
+      prev->next = current;
+
       current = old_next; 
     }
   }
@@ -122,6 +158,7 @@ static void resize(ioopm_hash_table_t *ht, size_t new_capacity)
   free(ht->buckets);
   ht->buckets = new_buckets;
   ht->capacity = new_capacity;
+  ht->resizes++;
 }
 
 void ioopm_hash_table_insert(ioopm_hash_table_t *ht, elem_t key, elem_t value) 
@@ -134,10 +171,10 @@ void ioopm_hash_table_insert(ioopm_hash_table_t *ht, elem_t key, elem_t value)
 
   unsigned bucket_index = get_bucket_index(ht, ht->hash_fun, key);
 
-  entry_t *entry = find_previous_entry_for_key(&ht->buckets[bucket_index], key, ht->eq_fun);
+  entry_t *entry = find_previous_entry_for_key(&ht->buckets[bucket_index], key, ht->eq_fun, ht->cmp_fun);
   entry_t *next = entry->next;
 
-  if (next == NULL) 
+  if (!entry_has_key(ht, next, key)) 
   {
     entry->next = entry_create(key, value, next);
     ht->size++;
@@ -154,10 +191,10 @@ option_t *ioopm_hash_table_lookup(ioopm_hash_table_t *ht, elem_t key)
   unsigned bucket_index = get_bucket_index(ht, ht->hash_fun, key);
 
   option_t *lookup_result = calloc(1, sizeof(option_t));
-  entry_t *prev = find_previous_entry_for_key(&ht->buckets[bucket_index], key, ht->eq_fun);
+  entry_t *prev = find_previous_entry_for_key(&ht->buckets[bucket_index], key, ht->eq_fun, ht->cmp_fun);
   entry_t *current = prev->next;
 
-  if (current != NULL) 
+  if (entry_has_key(ht, current, key)) 
   {
     *lookup_result = Success(current->value);
   } 
@@ -169,13 +206,33 @@ option_t *ioopm_hash_table_lookup(ioopm_hash_table_t *ht, elem_t key)
   return lookup_result;
 }
 
+elem_t *ioopm_hash_table_find_with(ioopm_hash_table_t *ht, unsigned hash, elem_t probe, ioopm_cmp_function cmp_fun) 
+{
+  for (entry_t *current = ht->buckets[hash % ht->capacity].next; current != NULL; current = current->next) 
+  {
+    int cmp = cmp_fun(current->key, probe);
+
+    if (cmp == 0) 
+    {
+      return &current->value;
+    }
+    // ordered chains hold no match after the first larger key
+    if (cmp > 0 && ht->cmp_fun != NULL) 
+    {
+      return NULL;
+    }
+  }
+
+  return NULL;
+}
+
 elem_t ioopm_hash_table_remove(ioopm_hash_table_t *ht, elem_t key)
  {
   unsigned bucket_index = get_bucket_index(ht, ht->hash_fun, key);
 
   option_t *lookup_result = ioopm_hash_table_lookup(ht, key);
 
-  entry_t *prev = find_previous_entry_for_key(&ht->buckets[bucket_index], key, ht->eq_fun);
+  entry_t *prev = find_previous_entry_for_key(&ht->buckets[bucket_index], key, ht->eq_fun, ht->cmp_fun);
   entry_t *current = prev->next;
   elem_t removed_value;
 
@@ -223,6 +280,11 @@ size_t ioopm_hash_table_size(ioopm_hash_table_t *ht)
   return counter;
 }
 
+size_t ioopm_hash_table_resizes(ioopm_hash_table_t *ht)
+{
+  return ht->resizes;
+}
+
 bool ioopm_hash_table_is_empty(ioopm_hash_table_t *ht) 
 {
   for (int i = 0; i < ht->capacity; i++) 
@@ -281,6 +343,34 @@ ioopm_list_t *ioopm_hash_table_values(ioopm_hash_table_t *ht)
   return list;
 }
 
+ioopm_vector_t *ioopm_hash_table_keys_vector(ioopm_hash_table_t *ht) 
+{
+  ioopm_vector_t *vector = ioopm_vector_create(ht->eq_fun);
+
+  for (int i = 0; i < ht->capacity; i++) 
+  {
+    for (entry_t *current = (&ht->buckets[i])->next; current != NULL; current = current->next) 
+    {
+      ioopm_vector_append(vector, current->key);
+    }
+  }
+  return vector;
+}
+
+ioopm_vector_t *ioopm_hash_table_values_vector(ioopm_hash_table_t *ht) 
+{
+  ioopm_vector_t *vector = ioopm_vector_create(ht->eq_fun);
+
+  for (int i = 0; i < ht->capacity; i++) 
+  {
+    for (entry_t *current = (&ht->buckets[i])->next; current != NULL; current = current->next) 
+    {
+      ioopm_vector_append(vector, current->value);
+    }
+  }
+  return vector;
+}
+
 bool ioopm_hash_table_has_key(ioopm_hash_table_t *ht, elem_t key) 
 {
   option_t *lookup_result = ioopm_hash_table_lookup(ht, key);
@@ -4,6 +4,7 @@
 #include "common.h"
 #include <stdlib.h> 
 #include "linked_list.h"
+#include "vector.h"
 
 #define No_Buckets 17 //set only for debugging purposes
 
@@ -50,6 +51,15 @@ struct option
 /// @return a new empty hash table
 ioopm_hash_table_t *ioopm_hash_table_create(ioopm_hash_function hash_fun, ioopm_eq_function eq_fun);
 
+/// @brief create a new hash table where every bucket is kept sorted by key.
+/// Lookups of missing keys stop at the first larger key, and the keys of each bucket 
+/// are listed in ascending order by ioopm_hash_table_keys.
+/// @param hash_fun a hash function
+/// @param eq_fun an equal function, must agree with cmp_fun returning 0
+/// @param cmp_fun a compare function returning <0, 0 or >0 like strcmp
+/// @return a new empty hash table with ordered buckets
+ioopm_hash_table_t *ioopm_hash_table_create_ordered(ioopm_hash_function hash_fun, ioopm_eq_function eq_fun, ioopm_cmp_function cmp_fun);
+
 /// @brief delete a hash table and free its memory
 /// @param ht a hash table to be deleted
 void ioopm_hash_table_destroy(ioopm_hash_table_t *ht);
@@ -66,6 +76,16 @@ void ioopm_hash_table_insert(ioopm_hash_table_t *ht, elem_t key, elem_t value);
 /// @return a heap allocated option with an truth-value and a value
 option_t *ioopm_hash_table_lookup(ioopm_hash_table_t *ht, elem_t key);
 
+/// @brief find the value for a key that is sought in another form than it is stored in,
+/// like a string slice for a table of strings, without first building a key to look up
+/// @param ht hash table operated upon
+/// @param hash the value the hash function of ht returns for the key sought
+/// @param probe the key sought, in the form cmp_fun takes as its second argument
+/// @param cmp_fun compares a stored key with probe, returning 0 when they are equal. For an 
+/// ordered table it must order like the compare function of the table.
+/// @return a pointer to the value of the entry, valid until ht is changed, or NULL if key has no entry
+elem_t *ioopm_hash_table_find_with(ioopm_hash_table_t *ht, unsigned hash, elem_t probe, ioopm_cmp_function cmp_fun);
+
 /// @brief remove any mapping from key to a value
 /// @param ht hash table operated upon
 /// @param key key to remove
@@ -77,6 +97,11 @@ elem_t ioopm_hash_table_remove(ioopm_hash_table_t *ht, elem_t key);
 /// @return the number of key => value entries in the hash table
 size_t ioopm_hash_table_size(ioopm_hash_table_t *ht);
 
+/// @brief returns the number of times the buckets of the hash table have grown
+/// @param ht hash table operated upon
+/// @return the number of resizes since the hash table was created
+size_t ioopm_hash_table_resizes(ioopm_hash_table_t *ht);
+
 /// @brief checks if the hash table is empty
 /// @param ht hash table operated upon
 /// @return true is size == 0, else false
@@ -96,6 +121,16 @@ ioopm_list_t *ioopm_hash_table_keys(ioopm_hash_table_t *ht);
 /// @return a linked list of values for hash table h
 ioopm_list_t *ioopm_hash_table_values(ioopm_hash_table_t *ht);
 
+/// @brief return the keys for all entries in a vector, in the same order as ioopm_hash_table_keys
+/// @param ht hash table operated upon
+/// @return a vector of keys for hash table h
+ioopm_vector_t *ioopm_hash_table_keys_vector(ioopm_hash_table_t *ht);
+
+/// @brief return the values for all entries in a vector, in the same order as ioopm_hash_table_keys
+/// @param ht hash table operated upon
+/// @return a vector of values for hash table h
+ioopm_vector_t *ioopm_hash_table_values_vector(ioopm_hash_table_t *ht);
+
 /// @brief check if a hash table has an entry with a given key
 /// @param ht hash table operated upon
 /// @param key the key sought
@@ -4,6 +4,7 @@
 #include "common.h"
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 int init_suite(void)
 {
@@ -286,6 +287,34 @@ void test_table_values()
     ioopm_hash_table_destroy(ht); 
 }
 
+void test_table_keys_values_vector()
+{
+    ioopm_hash_table_t *ht = ioopm_hash_table_create(hash_fun_key_int, bool_eq_fun); 
+
+    for (int i = 0; i < 40; i++)
+    {
+        ioopm_hash_table_insert(ht, int_elem(i), int_elem(100 + i));
+    }
+
+    ioopm_list_t *keys_list = ioopm_hash_table_keys(ht);
+    ioopm_vector_t *keys = ioopm_hash_table_keys_vector(ht);
+    ioopm_vector_t *values = ioopm_hash_table_values_vector(ht);
+
+    // same order as the list of keys, with the value of each key at the same index
+    CU_ASSERT_EQUAL(ioopm_vector_size(keys), 40);
+    CU_ASSERT_EQUAL(ioopm_vector_size(values), 40);
+    for (int i = 0; i < 40; i++)
+    {
+        CU_ASSERT_EQUAL(ioopm_vector_get(keys, i).integer, ioopm_linked_list_get(keys_list, i).integer);
+        CU_ASSERT_EQUAL(ioopm_vector_get(values, i).integer, ioopm_vector_get(keys, i).integer + 100);
+    }
+
+    ioopm_vector_destroy(values);
+    ioopm_vector_destroy(keys);
+    ioopm_linked_list_destroy(keys_list);
+    ioopm_hash_table_destroy(ht); 
+}
+
 void test_ht_has_key()
 {
     ioopm_hash_table_t *ht = ioopm_hash_table_create(hash_fun_key_int, bool_eq_fun);
@@ -444,6 +473,158 @@ void boundary_test()
     ioopm_hash_table_destroy(ht); 
 }
 
+static unsigned hash_fun_single_bucket(elem_t key)
+{
+  return 0;
+}
+
+static int int_cmp_fun(elem_t a, elem_t b)
+{
+    return a.integer - b.integer;
+}
+
+void test_ordered_buckets()
+{
+    ioopm_hash_table_t *ht = ioopm_hash_table_create_ordered(hash_fun_single_bucket, bool_eq_fun, int_cmp_fun);
+
+    int keys[] = {42, 7, 19, -3, 100, 8, 0, 55};
+    int length = 8;
+
+    for (int i = 0; i < length; i++)
+    {
+        ioopm_hash_table_insert(ht, int_elem(keys[i]), int_elem(keys[i] * 2));
+    }
+    CU_ASSERT_EQUAL(ioopm_hash_table_size(ht), length);
+
+    // all keys share one bucket, so the keys come out sorted
+    ioopm_list_t *list = ioopm_hash_table_keys(ht);
+    for (int i = 1; i < length; i++)
+    {
+        CU_ASSERT_TRUE(ioopm_linked_list_get(list, i - 1).integer < ioopm_linked_list_get(list, i).integer);
+    }
+    ioopm_linked_list_destroy(list);
+
+    // hits, misses before, between and after the stored keys
+    option_t *lookup_result = ioopm_hash_table_lookup(ht, int_elem(19));
+    CU_ASSERT_TRUE(Successful((*lookup_result)));
+    CU_ASSERT_EQUAL(lookup_result->value.integer, 38);
+    free(lookup_result);
+
+    int missing[] = {-10, 1, 20, 101};
+    for (int i = 0; i < 4; i++)
+    {
+        CU_ASSERT_FALSE(ioopm_hash_table_has_key(ht, int_elem(missing[i])));
+    }
+
+    // updating a key keeps a single entry
+    ioopm_hash_table_insert(ht, int_elem(8), int_elem(1));
+    CU_ASSERT_EQUAL(ioopm_hash_table_size(ht), length);
+
+    CU_ASSERT_EQUAL(ioopm_hash_table_remove(ht, int_elem(8)).integer, 1);
+    CU_ASSERT_FALSE(ioopm_hash_table_has_key(ht, int_elem(8)));
+    CU_ASSERT_TRUE(ioopm_hash_table_has_key(ht, int_elem(19)));
+    CU_ASSERT_TRUE(ioopm_hash_table_has_key(ht, int_elem(42)));
+
+    ioopm_hash_table_destroy(ht);
+}
+
+void test_ordered_buckets_resize()
+{
+    ioopm_hash_table_t *ht = ioopm_hash_table_create_ordered(hash_fun_key_int, bool_eq_fun, int_cmp_fun);
+    CU_ASSERT_EQUAL(ioopm_hash_table_resizes(ht), 0);
+
+    // enough keys to force several resizes
+    for (int i = 999; i >= 0; i--)
+    {
+        ioopm_hash_table_insert(ht, int_elem(i), int_elem(i));
+    }
+    CU_ASSERT_EQUAL(ioopm_hash_table_size(ht), 1000);
+    // the 17 buckets double whenever there are more keys than buckets
+    CU_ASSERT_EQUAL(ioopm_hash_table_resizes(ht), 6);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        option_t *lookup_result = ioopm_hash_table_lookup(ht, int_elem(i));
+        CU_ASSERT_TRUE(Successful((*lookup_result)));
+        CU_ASSERT_EQUAL(lookup_result->value.integer, i);
+        free(lookup_result);
+    }
+    CU_ASSERT_FALSE(ioopm_hash_table_has_key(ht, int_elem(1000)));
+
+    ioopm_hash_table_destroy(ht);
+}
+
+typedef struct slice
+{
+    const char *start;
+    size_t length;
+} slice_t;
+
+static unsigned hash_fun_first_char(elem_t key)
+{
+    return key.string[0];
+}
+
+static bool str_eq_fun(elem_t a, elem_t b)
+{
+    return strcmp(a.string, b.string) == 0;
+}
+
+static int str_cmp_fun(elem_t a, elem_t b)
+{
+    return strcmp(a.string, b.string);
+}
+
+// Compares a stored string with a slice, ordered like strcmp
+static int slice_cmp_fun(elem_t key, elem_t probe)
+{
+    slice_t *slice = probe.void_ptr;
+    int cmp = strncmp(key.string, slice->start, slice->length);
+
+    return cmp != 0 ? cmp : key.string[slice->length] != '\0';
+}
+
+static elem_t *find_slice(ioopm_hash_table_t *ht, const char *text, size_t start, size_t length)
+{
+    slice_t slice = {text + start, length};
+    return ioopm_hash_table_find_with(ht, text[start], (elem_t) {.void_ptr = &slice}, slice_cmp_fun);
+}
+
+static void test_find_with_in(ioopm_hash_table_t *ht)
+{
+    char *keys[] = {"apples", "app", "banana", "apple", "ban"};
+    char *text = "apples and bananas in an app";
+
+    for (int i = 0; i < 5; i++)
+    {
+        ioopm_hash_table_insert(ht, str_elem(keys[i]), int_elem(i));
+    }
+
+    // prefixes and extensions of stored keys do not match
+    CU_ASSERT_EQUAL(find_slice(ht, text, 0, 6)->integer, 0);
+    CU_ASSERT_EQUAL(find_slice(ht, text, 0, 5)->integer, 3);
+    CU_ASSERT_EQUAL(find_slice(ht, text, 0, 3)->integer, 1);
+    CU_ASSERT_EQUAL(find_slice(ht, text, 11, 3)->integer, 4);
+    CU_ASSERT_EQUAL(find_slice(ht, text, 11, 6)->integer, 2);
+    CU_ASSERT_PTR_NULL(find_slice(ht, text, 0, 2));
+    CU_ASSERT_PTR_NULL(find_slice(ht, text, 11, 7));
+    CU_ASSERT_PTR_NULL(find_slice(ht, text, 7, 3));
+
+    // the value can be updated in place
+    find_slice(ht, text, 25, 3)->integer = 10;
+    option_t *lookup_result = ioopm_hash_table_lookup(ht, str_elem("app"));
+    CU_ASSERT_EQUAL(lookup_result->value.integer, 10);
+    free(lookup_result);
+
+    ioopm_hash_table_destroy(ht);
+}
+
+void test_find_with()
+{
+    test_find_with_in(ioopm_hash_table_create(hash_fun_first_char, str_eq_fun));
+    test_find_with_in(ioopm_hash_table_create_ordered(hash_fun_first_char, str_eq_fun, str_cmp_fun));
+}
+
 int main()
 {
     // First we try to set up CUnit, and exit if we fail
@@ -475,12 +656,16 @@ int main()
          CU_add_test(my_test_suite, "Clearing a hash_table", test_clear_hash_table) == NULL ||
          CU_add_test(my_test_suite, "Test on a generated array of keys", test_table_keys) == NULL ||
          CU_add_test(my_test_suite, "Test on a generated array of values", test_table_values) == NULL ||
+         CU_add_test(my_test_suite, "Keys and values exported to vectors", test_table_keys_values_vector) == NULL ||
          CU_add_test(my_test_suite, "If hash table has key", test_ht_has_key) == NULL ||
          CU_add_test(my_test_suite, "If hash table has value", test_ht_has_value) == NULL ||
          CU_add_test(my_test_suite, "Predicate function that satisfies any antry", test_ht_has_any) == NULL ||
          CU_add_test(my_test_suite, "Predicate function that satisfies all entries", test_ht_has_all) == NULL ||
          CU_add_test(my_test_suite, "Apply function on all entries", test_ht_apply_to_all) == NULL ||
-         CU_add_test(my_test_suite, "Boundary test", boundary_test) == NULL
+         CU_add_test(my_test_suite, "Boundary test", boundary_test) == NULL ||
+         CU_add_test(my_test_suite, "Ordered buckets with early exit", test_ordered_buckets) == NULL ||
+         CU_add_test(my_test_suite, "Ordered buckets kept through resize", test_ordered_buckets_resize) == NULL ||
+         CU_add_test(my_test_suite, "Find keys given as string slices", test_find_with) == NULL
         )
        )
     {
@@ -4,6 +4,7 @@
 #include "common.h"
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 int init_suite(void)
 {
@@ -20,6 +21,13 @@ static bool bool_eq_fun(elem_t a, elem_t b)
     return b.integer == a.integer; 
 }
 
+// Orders integers by their value divided by 100, so that the last two digits can 
+// tell equal elements apart when checking that sorting is stable
+static int cmp_hundreds(elem_t a, elem_t b)
+{
+    return a.integer / 100 - b.integer / 100;
+}
+
 static void append_ints_to_list(ioopm_list_t *list, elem_t *values, int length)
 {
     for (int i = 0; i < length; ++i) 
@@ -417,6 +425,497 @@ void test_iterator_current()
     ioopm_iterator_destroy(iter);
 }
 
+// Compares a list with a reference array through get and the iterator
+static void assert_list_matches(ioopm_list_t *list, int *expected, int length)
+{
+    CU_ASSERT_EQUAL(ioopm_linked_list_size(list), length);
+
+    for (int i = 0; i < length; i++)
+    {
+        CU_ASSERT_EQUAL(ioopm_linked_list_get(list, i).integer, expected[i]);
+    }
+
+    ioopm_list_iterator_t *iter = ioopm_list_iterator(list);
+    for (int i = 0; i < length; i++)
+    {
+        CU_ASSERT_EQUAL(ioopm_iterator_current(iter).integer, expected[i]);
+        CU_ASSERT_EQUAL(ioopm_iterator_has_next(iter), i < length - 1);
+        ioopm_iterator_next(iter);
+    }
+    ioopm_iterator_destroy(iter);
+}
+
+void test_long_list()
+{
+    ioopm_list_t *list = ioopm_linked_list_create(bool_eq_fun);
+    int expected[300];
+    int length = 0;
+
+    for (int i = 0; i < 100; i++)
+    {
+        ioopm_int_ll_append(list, i);
+        expected[length++] = i;
+    }
+    assert_list_matches(list, expected, length);
+
+    // insert spread over the whole list, also into full parts of it
+    for (int i = 0; i < 100; i++)
+    {
+        int index = (i * 37) % (length + 1);
+        ioopm_int_ll_insert(list, index, 1000 + i);
+        memmove(expected + index + 1, expected + index, (length - index) * sizeof(int));
+        expected[index] = 1000 + i;
+        length++;
+    }
+    assert_list_matches(list, expected, length);
+
+    for (int i = 0; i < 20; i++)
+    {
+        ioopm_int_ll_prepend(list, -i);
+        memmove(expected + 1, expected, length * sizeof(int));
+        expected[0] = -i;
+        length++;
+    }
+    assert_list_matches(list, expected, length);
+
+    CU_ASSERT_TRUE(ioopm_linked_list_contains(list, int_elem(1099)));
+
+    // remove until the list is almost empty
+    for (int i = 0; length > 3; i++)
+    {
+        int index = (length / 2 + i * 7) % length;
+        CU_ASSERT_EQUAL(ioopm_linked_list_remove(list, index).integer, expected[index]);
+        memmove(expected + index, expected + index + 1, (length - index - 1) * sizeof(int));
+        length--;
+    }
+    assert_list_matches(list, expected, length);
+
+    CU_ASSERT_EQUAL(ioopm_linked_list_remove(list, length - 1).integer, expected[length - 1]);
+    length--;
+    ioopm_int_ll_append(list, 7);
+    expected[length++] = 7;
+    assert_list_matches(list, expected, length);
+
+    ioopm_linked_list_clear(list);
+    CU_ASSERT_TRUE(ioopm_linked_list_is_empty(list));
+    ioopm_int_ll_append(list, 1);
+    CU_ASSERT_EQUAL(ioopm_linked_list_get(list, 0).integer, 1);
+
+    ioopm_linked_list_destroy(list);
+}
+
+void test_iterator_insert_remove_set()
+{
+    ioopm_list_t *list = ioopm_linked_list_create(bool_eq_fun);
+
+    // inserting through an iterator of an empty list appends
+    ioopm_list_iterator_t *iter = ioopm_list_iterator(list);
+    CU_ASSERT_FALSE(ioopm_iterator_has_current(iter));
+    ioopm_iterator_insert_before(iter, int_elem(2));
+    CU_ASSERT_EQUAL(ioopm_linked_list_size(list), 1);
+    ioopm_iterator_destroy(iter);
+
+    iter = ioopm_list_iterator(list);
+    CU_ASSERT_TRUE(ioopm_iterator_has_current(iter));
+    ioopm_iterator_insert_before(iter, int_elem(1));
+    ioopm_iterator_insert_after(iter, int_elem(3));
+    CU_ASSERT_EQUAL(ioopm_iterator_current(iter).integer, 2);
+    int expected[] = {1, 2, 3};
+    assert_list_matches(list, expected, 3);
+
+    // set and remove the current element
+    CU_ASSERT_EQUAL(ioopm_iterator_set(iter, int_elem(20)).integer, 2);
+    CU_ASSERT_EQUAL(ioopm_linked_list_get(list, 1).integer, 20);
+    CU_ASSERT_EQUAL(ioopm_iterator_remove(iter).integer, 20);
+    CU_ASSERT_EQUAL(ioopm_iterator_current(iter).integer, 3);
+
+    // removing the last element leaves the iterator after the end
+    CU_ASSERT_EQUAL(ioopm_iterator_remove(iter).integer, 3);
+    CU_ASSERT_FALSE(ioopm_iterator_has_current(iter));
+    CU_ASSERT_PTR_NULL(ioopm_iterator_remove(iter).void_ptr);
+    ioopm_iterator_insert_before(iter, int_elem(4));
+    ioopm_int_ll_append(list, 5);
+    int expected_after[] = {1, 4, 5};
+    assert_list_matches(list, expected_after, 3);
+
+    ioopm_iterator_reset(iter);
+    CU_ASSERT_EQUAL(ioopm_iterator_remove(iter).integer, 1);
+    CU_ASSERT_EQUAL(ioopm_iterator_current(iter).integer, 4);
+    ioopm_iterator_destroy(iter);
+
+    ioopm_linked_list_destroy(list);
+}
+
+void test_iterator_long_list()
+{
+    ioopm_list_t *list = ioopm_linked_list_create(bool_eq_fun);
+    int expected[200];
+    int length = 0;
+
+    for (int i = 0; i < 50; i++)
+    {
+        ioopm_int_ll_append(list, 2 * i);
+        expected[length++] = 2 * i;
+    }
+
+    // insert the odd numbers after each even number
+    ioopm_list_iterator_t *iter = ioopm_list_iterator(list);
+    for (int i = 0; i < 50; i++)
+    {
+        ioopm_iterator_insert_after(iter, int_elem(2 * i + 1));
+        ioopm_iterator_next(iter);
+        ioopm_iterator_next(iter);
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        expected[i] = i;
+    }
+    length = 100;
+    assert_list_matches(list, expected, length);
+
+    // remove every multiple of three and negate every other element
+    ioopm_iterator_reset(iter);
+    length = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        if (i % 3 == 0)
+        {
+            CU_ASSERT_EQUAL(ioopm_iterator_remove(iter).integer, i);
+        }
+        else
+        {
+            ioopm_iterator_set(iter, int_elem(-i));
+            expected[length++] = -i;
+            ioopm_iterator_next(iter);
+        }
+    }
+    assert_list_matches(list, expected, length);
+    ioopm_iterator_destroy(iter);
+
+    // insert before every element
+    iter = ioopm_list_iterator(list);
+    int old_length = length;
+    length = 0;
+    for (int i = 0; i < old_length; i++)
+    {
+        int value = ioopm_iterator_current(iter).integer;
+        ioopm_iterator_insert_before(iter, int_elem(1000 + i));
+        expected[length++] = 1000 + i;
+        expected[length++] = value;
+        ioopm_iterator_next(iter);
+    }
+    assert_list_matches(list, expected, length);
+    ioopm_iterator_destroy(iter);
+
+    ioopm_linked_list_destroy(list);
+}
+
+void test_remove_last()
+{
+    ioopm_list_t *list = ioopm_linked_list_create(bool_eq_fun);
+    CU_ASSERT_PTR_NULL(ioopm_linked_list_remove_last(list).void_ptr);
+
+    for (int i = 0; i < 60; i++)
+    {
+        ioopm_int_ll_append(list, i);
+    }
+
+    for (int i = 59; i >= 0; i--)
+    {
+        CU_ASSERT_EQUAL(ioopm_linked_list_remove_last(list).integer, i);
+        CU_ASSERT_EQUAL(ioopm_linked_list_size(list), i);
+    }
+    CU_ASSERT_TRUE(ioopm_linked_list_is_empty(list));
+
+    // the list is still usable after being emptied from the end
+    ioopm_int_ll_append(list, 1);
+    ioopm_int_ll_prepend(list, 0);
+    int expected[] = {0, 1};
+    assert_list_matches(list, expected, 2);
+
+    ioopm_linked_list_destroy(list);
+}
+
+void test_reverse_iterator()
+{
+    ioopm_list_t *list = ioopm_linked_list_create(bool_eq_fun);
+    ioopm_list_iterator_t *iter = ioopm_list_reverse_iterator(list);
+    CU_ASSERT_FALSE(ioopm_iterator_has_current(iter));
+    CU_ASSERT_FALSE(ioopm_iterator_has_next(iter));
+
+    // inserting through a reverse iterator without current element prepends
+    ioopm_iterator_insert_before(iter, int_elem(1));
+    ioopm_iterator_insert_before(iter, int_elem(0));
+    ioopm_iterator_destroy(iter);
+
+    for (int i = 2; i < 60; i++)
+    {
+        ioopm_int_ll_append(list, i);
+    }
+
+    // walk the list backwards
+    iter = ioopm_list_reverse_iterator(list);
+    CU_ASSERT_EQUAL(ioopm_iterator_current(iter).integer, 59);
+    for (int i = 58; i >= 0; i--)
+    {
+        CU_ASSERT_TRUE(ioopm_iterator_has_next(iter));
+        CU_ASSERT_EQUAL(ioopm_iterator_next(iter).integer, i);
+    }
+    CU_ASSERT_FALSE(ioopm_iterator_has_next(iter));
+    CU_ASSERT_PTR_NULL(ioopm_iterator_next(iter).void_ptr);
+
+    // remove the odd numbers walking backwards, the iterator moves towards the start
+    ioopm_iterator_reset(iter);
+    CU_ASSERT_EQUAL(ioopm_iterator_current(iter).integer, 59);
+    int expected[30];
+    for (int i = 59; i >= 0; i--)
+    {
+        if (i % 2 == 1)
+        {
+            CU_ASSERT_EQUAL(ioopm_iterator_remove(iter).integer, i);
+        }
+        else
+        {
+            expected[i / 2] = i;
+            ioopm_iterator_next(iter);
+        }
+    }
+    assert_list_matches(list, expected, 30);
+
+    // before and after still follow the order of the list
+    ioopm_iterator_reset(iter);
+    ioopm_iterator_insert_before(iter, int_elem(57));
+    ioopm_iterator_insert_after(iter, int_elem(59));
+    CU_ASSERT_EQUAL(ioopm_iterator_current(iter).integer, 58);
+    CU_ASSERT_EQUAL(ioopm_iterator_next(iter).integer, 57);
+    CU_ASSERT_EQUAL(ioopm_linked_list_get(list, 31).integer, 59);
+
+    // removing the first element leaves the reverse iterator before the start
+    while (ioopm_iterator_has_next(iter))
+    {
+        ioopm_iterator_next(iter);
+    }
+    CU_ASSERT_EQUAL(ioopm_iterator_remove(iter).integer, 0);
+    CU_ASSERT_FALSE(ioopm_iterator_has_current(iter));
+    CU_ASSERT_EQUAL(ioopm_linked_list_get(list, 0).integer, 2);
+    ioopm_iterator_destroy(iter);
+
+    ioopm_linked_list_destroy(list);
+}
+
+void test_indexed_access()
+{
+    ioopm_list_t *list = ioopm_linked_list_create(bool_eq_fun);
+    int expected[1200];
+    int length = 0;
+
+    for (int i = 0; i < 1000; i++)
+    {
+        ioopm_int_ll_append(list, i);
+        expected[length++] = i;
+    }
+
+    // consecutive gets in both directions
+    for (int i = 0; i < length; i++)
+    {
+        CU_ASSERT_EQUAL(ioopm_linked_list_get(list, i).integer, expected[i]);
+    }
+    for (int i = length - 1; i >= 0; i--)
+    {
+        CU_ASSERT_EQUAL(ioopm_linked_list_get(list, i).integer, expected[i]);
+    }
+
+    // random gets mixed with inserts and removes anywhere in the list
+    unsigned int seed = 1;
+    for (int round = 0; round < 600; round++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int index = (seed >> 8) % length;
+
+        CU_ASSERT_EQUAL(ioopm_linked_list_get(list, index).integer, expected[index]);
+
+        if (round % 3 == 0)
+        {
+            ioopm_int_ll_insert(list, index, -round);
+            memmove(expected + index + 1, expected + index, (length - index) * sizeof(int));
+            expected[index] = -round;
+            length++;
+        }
+        else if (round % 3 == 1)
+        {
+            CU_ASSERT_EQUAL(ioopm_linked_list_remove(list, index).integer, expected[index]);
+            memmove(expected + index, expected + index + 1, (length - index - 1) * sizeof(int));
+            length--;
+        }
+        else
+        {
+            ioopm_int_ll_prepend(list, round);
+            memmove(expected + 1, expected, length * sizeof(int));
+            expected[0] = round;
+            length++;
+        }
+
+        CU_ASSERT_EQUAL(ioopm_linked_list_get(list, index).integer, expected[index]);
+    }
+    assert_list_matches(list, expected, length);
+
+    ioopm_linked_list_destroy(list);
+}
+
+void test_sort()
+{
+    ioopm_list_t *list = ioopm_linked_list_create(bool_eq_fun);
+
+    // sorting empty and single element lists does nothing
+    ioopm_linked_list_sort(list, cmp_hundreds);
+    CU_ASSERT_TRUE(ioopm_linked_list_is_empty(list));
+    ioopm_int_ll_append(list, 500);
+    ioopm_linked_list_sort(list, cmp_hundreds);
+    CU_ASSERT_EQUAL(ioopm_linked_list_get(list, 0).integer, 500);
+    ioopm_linked_list_clear(list);
+
+    // 0..99 is the order of insertion, the hundreds are the keys with many duplicates
+    int expected[300];
+    int length = 0;
+    unsigned int seed = 7;
+    for (int i = 0; i < 300; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int value = ((seed >> 8) % 20) * 100 + i / 3;
+        ioopm_int_ll_append(list, value);
+        expected[length++] = value;
+    }
+
+    // insertion sort of the expected values is stable
+    for (int i = 1; i < length; i++)
+    {
+        int value = expected[i];
+        int j = i;
+        for (; j > 0 && expected[j - 1] / 100 > value / 100; j--)
+        {
+            expected[j] = expected[j - 1];
+        }
+        expected[j] = value;
+    }
+
+    ioopm_linked_list_get(list, 150);
+    ioopm_linked_list_sort(list, cmp_hundreds);
+    assert_list_matches(list, expected, length);
+
+    // the list is still fully usable at both ends after sorting
+    CU_ASSERT_EQUAL(ioopm_linked_list_remove_last(list).integer, expected[length - 1]);
+    CU_ASSERT_EQUAL(ioopm_linked_list_remove(list, 0).integer, expected[0]);
+    assert_list_matches(list, expected + 1, length - 2);
+
+    ioopm_linked_list_destroy(list);
+}
+
+void test_insert_sorted()
+{
+    ioopm_list_t *list = ioopm_linked_list_create(bool_eq_fun);
+    int expected[200];
+    int length = 0;
+    unsigned int seed = 3;
+
+    for (int i = 0; i < 200; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int value = ((seed >> 8) % 30) * 100 + i % 100;
+        ioopm_linked_list_insert_sorted(list, int_elem(value), cmp_hundreds);
+
+        // equal elements are inserted after the ones already in the list
+        int j = length;
+        for (; j > 0 && expected[j - 1] / 100 > value / 100; j--)
+        {
+            expected[j] = expected[j - 1];
+        }
+        expected[j] = value;
+        length++;
+    }
+    assert_list_matches(list, expected, length);
+
+    ioopm_linked_list_destroy(list);
+}
+
+static ioopm_list_t *list_of_range(int from, int to)
+{
+    ioopm_list_t *list = ioopm_linked_list_create(bool_eq_fun);
+
+    for (int i = from; i < to; i++)
+    {
+        ioopm_int_ll_append(list, i);
+    }
+    return list;
+}
+
+void test_concat_splice_split()
+{
+    int expected[100];
+    for (int i = 0; i < 100; i++)
+    {
+        expected[i] = i;
+    }
+
+    // concat moves every element and leaves the source empty
+    ioopm_list_t *list = list_of_range(0, 30);
+    ioopm_list_t *src = list_of_range(30, 60);
+    ioopm_linked_list_get(list, 29);
+    ioopm_linked_list_concat(list, src);
+    CU_ASSERT_TRUE(ioopm_linked_list_is_empty(src));
+    assert_list_matches(list, expected, 60);
+    ioopm_linked_list_concat(list, src);
+    assert_list_matches(list, expected, 60);
+
+    // the emptied source can be reused
+    ioopm_int_ll_append(src, 60);
+    ioopm_linked_list_concat(list, src);
+    assert_list_matches(list, expected, 61);
+    ioopm_linked_list_destroy(src);
+
+    // split in the middle of the list, at the start and at the end
+    ioopm_list_t *rest = ioopm_linked_list_split_at(list, 41);
+    assert_list_matches(list, expected, 41);
+    assert_list_matches(rest, expected + 41, 20);
+    ioopm_list_t *empty = ioopm_linked_list_split_at(list, 41);
+    CU_ASSERT_TRUE(ioopm_linked_list_is_empty(empty));
+    CU_ASSERT_PTR_NULL(ioopm_linked_list_split_at(list, 42));
+    ioopm_linked_list_destroy(empty);
+
+    ioopm_list_t *all = ioopm_linked_list_split_at(rest, 0);
+    CU_ASSERT_TRUE(ioopm_linked_list_is_empty(rest));
+    assert_list_matches(all, expected + 41, 20);
+    ioopm_int_ll_append(rest, 100);
+    CU_ASSERT_EQUAL(ioopm_linked_list_get(rest, 0).integer, 100);
+    ioopm_linked_list_destroy(rest);
+
+    // splice the tail back into the middle, at the start and at the end
+    ioopm_list_t *middle = ioopm_linked_list_split_at(list, 17);
+    ioopm_list_t *tail = ioopm_linked_list_split_at(middle, 10);
+    ioopm_linked_list_splice(list, 17, tail);
+    ioopm_linked_list_splice(list, 17, middle);
+    CU_ASSERT_TRUE(ioopm_linked_list_is_empty(tail));
+    CU_ASSERT_TRUE(ioopm_linked_list_is_empty(middle));
+    assert_list_matches(list, expected, 41);
+
+    ioopm_list_t *head = ioopm_linked_list_split_at(list, 0);
+    ioopm_linked_list_splice(list, 0, all);
+    ioopm_linked_list_splice(list, 0, head);
+    assert_list_matches(list, expected, 61);
+
+    // the list still works at both ends after moving links around
+    ioopm_int_ll_append(list, 61);
+    ioopm_int_ll_prepend(list, -1);
+    CU_ASSERT_EQUAL(ioopm_linked_list_remove_last(list).integer, 61);
+    CU_ASSERT_EQUAL(ioopm_linked_list_remove(list, 0).integer, -1);
+    assert_list_matches(list, expected, 61);
+
+    ioopm_linked_list_destroy(all);
+    ioopm_linked_list_destroy(head);
+    ioopm_linked_list_destroy(tail);
+    ioopm_linked_list_destroy(middle);
+    ioopm_linked_list_destroy(list);
+}
+
 int main()
 {
     // First we try to set up CUnit, and exit if we fail
@@ -455,7 +954,16 @@ int main()
          CU_add_test(my_test_suite, "If iterator has more elements to go over", test_iterator_has_next) == NULL ||
          CU_add_test(my_test_suite, "The next element for iterator to go over", test_iterator_next) == NULL ||
          CU_add_test(my_test_suite, "Reposition iterator to start of list", test_iterator_reset) == NULL ||
-         CU_add_test(my_test_suite, "Current element iterator goes over", test_iterator_current) == NULL))
+         CU_add_test(my_test_suite, "Current element iterator goes over", test_iterator_current) == NULL ||
+         CU_add_test(my_test_suite, "Insert and remove across a long list", test_long_list) == NULL ||
+         CU_add_test(my_test_suite, "Insert, remove and set through an iterator", test_iterator_insert_remove_set) == NULL ||
+         CU_add_test(my_test_suite, "Iterator updates across a long list", test_iterator_long_list) == NULL ||
+         CU_add_test(my_test_suite, "Remove elements from the end of the list", test_remove_last) == NULL ||
+         CU_add_test(my_test_suite, "Iterate, insert and remove backwards", test_reverse_iterator) == NULL ||
+         CU_add_test(my_test_suite, "Get by index mixed with inserts and removes", test_indexed_access) == NULL ||
+         CU_add_test(my_test_suite, "Stable sort of a list", test_sort) == NULL ||
+         CU_add_test(my_test_suite, "Insert elements in sorted order", test_insert_sorted) == NULL ||
+         CU_add_test(my_test_suite, "Concat, splice and split lists", test_concat_splice_split) == NULL))
     {
         // If adding any of the tests fails, we tear down CUnit and exit
         CU_cleanup_registry();
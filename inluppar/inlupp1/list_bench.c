@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include "linked_list.h"
+#include "iterator.h"
+#include "vector.h"
+#include "common.h"
+
+/// Times the workloads of linked_list_tests.c on the linked list (whichever backend is
+/// linked in) and on the vector. Usage: ./list_bench.out [number of elements]
+
+#define Default_Elements 20000
+
+static bool int_eq(elem_t a, elem_t b)
+{
+    return a.integer == b.integer;
+}
+
+static void add_one(elem_t *value, void *extra)
+{
+    value->integer++;
+}
+
+static double seconds_since(struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void report(char *workload, double list_time, double vector_time)
+{
+    printf("%-22s %10.4f %10.4f %8.2fx\n", workload, list_time, vector_time,
+           vector_time > 0 ? list_time / vector_time : 0);
+}
+
+// Each workload runs on both containers and prints both times. The checksums are
+// printed too so the compiler can not drop the loops.
+int main(int argc, char *argv[])
+{
+    int n = argc > 1 ? atoi(argv[1]) : Default_Elements;
+    long list_sum = 0;
+    long vector_sum = 0;
+    struct timespec start;
+    double list_time;
+
+    ioopm_list_t *list = ioopm_linked_list_create(int_eq);
+    ioopm_vector_t *vector = ioopm_vector_create(int_eq);
+
+    printf("%d elements\n%-22s %10s %10s %9s\n", n, "workload", "list (s)", "vector (s)", "speedup");
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < n; i++) ioopm_int_ll_append(list, i);
+    list_time = seconds_since(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < n; i++) ioopm_int_vector_append(vector, i);
+    report("append", list_time, seconds_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < n; i++) list_sum += ioopm_linked_list_get(list, i).integer;
+    list_time = seconds_since(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < n; i++) vector_sum += ioopm_vector_get(vector, i).integer;
+    report("get in order", list_time, seconds_since(&start));
+
+    unsigned int seed = 1;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < n; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        list_sum += ioopm_linked_list_get(list, (seed >> 8) % n).integer;
+    }
+    list_time = seconds_since(&start);
+    seed = 1;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < n; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        vector_sum += ioopm_vector_get(vector, (seed >> 8) % n).integer;
+    }
+    report("get at random", list_time, seconds_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ioopm_list_iterator_t *iter = ioopm_list_iterator(list);
+    for (list_sum += ioopm_iterator_current(iter).integer; ioopm_iterator_has_next(iter);)
+    {
+        list_sum += ioopm_iterator_next(iter).integer;
+    }
+    ioopm_iterator_destroy(iter);
+    list_time = seconds_since(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ioopm_vector_iterator_t *vector_iter = ioopm_vector_iterator(vector);
+    for (vector_sum += ioopm_vector_iterator_current(vector_iter).integer; ioopm_vector_iterator_has_next(vector_iter);)
+    {
+        vector_sum += ioopm_vector_iterator_next(vector_iter).integer;
+    }
+    ioopm_vector_iterator_destroy(vector_iter);
+    report("iterate", list_time, seconds_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ioopm_linked_list_apply_to_all(list, add_one, NULL);
+    list_time = seconds_since(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ioopm_vector_apply_to_all(vector, add_one, NULL);
+    report("apply to all", list_time, seconds_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < 100; i++) list_sum += ioopm_linked_list_contains(list, int_elem(n - i));
+    list_time = seconds_since(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < 100; i++) vector_sum += ioopm_vector_contains(vector, int_elem(n - i));
+    report("contains (100)", list_time, seconds_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < n / 10; i++) ioopm_int_ll_insert(list, ioopm_linked_list_size(list) / 2, i);
+    list_time = seconds_since(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < n / 10; i++) ioopm_int_vector_insert(vector, ioopm_vector_size(vector) / 2, i);
+    report("insert in middle", list_time, seconds_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < n / 10; i++) ioopm_int_ll_prepend(list, i);
+    list_time = seconds_since(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < n / 10; i++) ioopm_int_vector_prepend(vector, i);
+    report("prepend", list_time, seconds_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (!ioopm_linked_list_is_empty(list)) list_sum += ioopm_linked_list_remove(list, 0).integer;
+    list_time = seconds_since(&start);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (!ioopm_vector_is_empty(vector)) vector_sum += ioopm_vector_remove(vector, 0).integer;
+    report("remove first", list_time, seconds_since(&start));
+
+    printf("checksums %ld %ld\n", list_sum, vector_sum);
+
+    ioopm_linked_list_destroy(list);
+    ioopm_vector_destroy(vector);
+    return 0;
+}
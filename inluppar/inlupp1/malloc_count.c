@@ -0,0 +1,75 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/// Counts the calls to malloc, calloc, realloc, posix_memalign and aligned_alloc of a program it is preloaded into, and
+/// writes the count to the file descriptor in MALLOC_COUNT_FD when the program exits.
+/// Built as malloc_count.so and used by freq_bench.out through LD_PRELOAD. The memory
+/// itself comes from the allocator of glibc.
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+
+static unsigned long long allocations = 0;
+
+void *malloc(size_t size)
+{
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+// glibc has no __libc_posix_memalign, so the alignment is checked here as it would be there
+int posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+    {
+        return EINVAL;
+    }
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    void *memory = __libc_memalign(alignment, size);
+
+    if (memory == NULL)
+    {
+        return ENOMEM;
+    }
+    *ptr = memory;
+    return 0;
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_memalign(alignment, size);
+}
+
+__attribute__((destructor))
+static void report_allocations(void)
+{
+    char *fd = getenv("MALLOC_COUNT_FD");
+    char text[32];
+
+    if (fd != NULL)
+    {
+        int length = snprintf(text, sizeof(text), "%llu\n", __atomic_load_n(&allocations, __ATOMIC_RELAXED));
+        if (write(atoi(fd), text, length) < 0)
+        {
+            // nothing to do, the harness reports the count as missing
+        }
+    }
+}
@@ -0,0 +1,312 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "ngram.h"
+#include "sketch.h"
+
+#define Initial_Slots 1024
+#define Id_Bits 32
+
+struct ngram_count
+{
+    size_t n;
+    size_t key_words;       // 64 bit words in a key, 1 for bigrams and 2 for longer n-grams
+    uint64_t high_mask;     // the bits of the high word of a key that hold ids
+
+    char **words;           // every different word, by id
+    uint32_t *lengths;
+    size_t word_count;
+    size_t word_capacity;
+    uint32_t *word_slots;   // finds a word by hash: its id + 1, or 0
+    size_t word_mask;       // one less than the number of word slots, a power of 2
+
+    uint64_t *keys;         // key_words words for every slot
+    uint32_t *counts;       // the count of the key in every slot, 0 for an empty slot
+    size_t size;
+    size_t mask;            // one less than the number of slots, a power of 2
+
+    uint64_t window[2];     // the ids of the last words, the last one in the lowest bits
+    size_t seen;            // the words since the last break, up to n
+    size_t total;           // the words added
+};
+
+// Mixes the bits of a 64 bit number so that every bit of it changes about half of them
+static inline uint64_t mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+static inline uint64_t key_hash(uint64_t low, uint64_t high)
+{
+    return mix(low ^ high * 0x9e3779b97f4a7c15ull);
+}
+
+// Slots are grown to keep them at most 70 % full
+static inline bool too_full(size_t size, size_t mask)
+{
+    return size * 10 >= (mask + 1) * 7;
+}
+
+ioopm_ngram_count_t *ioopm_ngram_count_create(size_t n)
+{
+    ioopm_ngram_count_t *counter = calloc(1, sizeof(ioopm_ngram_count_t));
+
+    counter->n = n < 2 ? 2 : n > Ngram_Max ? Ngram_Max : n;
+    counter->key_words = counter->n * Id_Bits <= 64 ? 1 : 2;
+    counter->high_mask = counter->n == 3 ? 0xffffffffull : counter->n == 4 ? ~0ull : 0;
+
+    counter->word_capacity = Initial_Slots;
+    counter->words = calloc(counter->word_capacity, sizeof(char *));
+    counter->lengths = calloc(counter->word_capacity, sizeof(uint32_t));
+    counter->word_slots = calloc(Initial_Slots, sizeof(uint32_t));
+    counter->word_mask = Initial_Slots - 1;
+
+    counter->keys = calloc(Initial_Slots * counter->key_words, sizeof(uint64_t));
+    counter->counts = calloc(Initial_Slots, sizeof(uint32_t));
+    counter->mask = Initial_Slots - 1;
+
+    return counter;
+}
+
+void ioopm_ngram_count_destroy(ioopm_ngram_count_t *counter)
+{
+    for (size_t i = 0; i < counter->word_count; i++)
+    {
+        free(counter->words[i]);
+    }
+    free(counter->words);
+    free(counter->lengths);
+    free(counter->word_slots);
+    free(counter->keys);
+    free(counter->counts);
+    free(counter);
+}
+
+// Returns the word slot of a word, or the empty slot where it belongs if it is missing
+static size_t word_slot_find(ioopm_ngram_count_t *counter, const char *word, size_t length, uint64_t hash)
+{
+    size_t slot = hash & counter->word_mask;
+
+    while (counter->word_slots[slot] != 0)
+    {
+        uint32_t id = counter->word_slots[slot] - 1;
+
+        if (counter->lengths[id] == length && memcmp(counter->words[id], word, length) == 0)
+        {
+            return slot;
+        }
+        slot = (slot + 1) & counter->word_mask;
+    }
+    return slot;
+}
+
+static void word_slots_grow(ioopm_ngram_count_t *counter)
+{
+    size_t slot_count = 2 * (counter->word_mask + 1);
+
+    free(counter->word_slots);
+    counter->word_slots = calloc(slot_count, sizeof(uint32_t));
+    counter->word_mask = slot_count - 1;
+
+    for (size_t id = 0; id < counter->word_count; id++)
+    {
+        size_t slot = ioopm_sketch_hash(counter->words[id], counter->lengths[id]) & counter->word_mask;
+
+        while (counter->word_slots[slot] != 0)
+        {
+            slot = (slot + 1) & counter->word_mask;
+        }
+        counter->word_slots[slot] = id + 1;
+    }
+}
+
+// The id of a word, given the next one if it is new
+static uint32_t word_id(ioopm_ngram_count_t *counter, const char *word, size_t length)
+{
+    uint64_t hash = ioopm_sketch_hash(word, length);
+    size_t slot = word_slot_find(counter, word, length, hash);
+
+    if (counter->word_slots[slot] != 0)
+    {
+        return counter->word_slots[slot] - 1;
+    }
+
+    if (counter->word_count == counter->word_capacity)
+    {
+        counter->word_capacity *= 2;
+        counter->words = realloc(counter->words, counter->word_capacity * sizeof(char *));
+        counter->lengths = realloc(counter->lengths, counter->word_capacity * sizeof(uint32_t));
+    }
+
+    uint32_t id = counter->word_count++;
+    counter->words[id] = strndup(word, length);
+    counter->lengths[id] = length;
+    counter->word_slots[slot] = id + 1;
+
+    if (too_full(counter->word_count, counter->word_mask))
+    {
+        word_slots_grow(counter);
+    }
+    return id;
+}
+
+// Returns the slot of a key, or the empty slot where it belongs if it is missing
+static size_t slot_find(ioopm_ngram_count_t *counter, uint64_t low, uint64_t high)
+{
+    size_t slot = key_hash(low, high) & counter->mask;
+    size_t words = counter->key_words;
+
+    while (counter->counts[slot] != 0)
+    {
+        uint64_t *key = &counter->keys[slot * words];
+
+        if (key[0] == low && (words == 1 || key[1] == high))
+        {
+            return slot;
+        }
+        slot = (slot + 1) & counter->mask;
+    }
+    return slot;
+}
+
+static void slots_grow(ioopm_ngram_count_t *counter)
+{
+    uint64_t *keys = counter->keys;
+    uint32_t *counts = counter->counts;
+    size_t old_count = counter->mask + 1;
+    size_t words = counter->key_words;
+
+    counter->keys = calloc(2 * old_count * words, sizeof(uint64_t));
+    counter->counts = calloc(2 * old_count, sizeof(uint32_t));
+    counter->mask = 2 * old_count - 1;
+
+    for (size_t i = 0; i < old_count; i++)
+    {
+        if (counts[i] != 0)
+        {
+            uint64_t *key = &keys[i * words];
+            size_t slot = slot_find(counter, key[0], words == 1 ? 0 : key[1]);
+
+            memcpy(&counter->keys[slot * words], key, words * sizeof(uint64_t));
+            counter->counts[slot] = counts[i];
+        }
+    }
+    free(keys);
+    free(counts);
+}
+
+void ioopm_ngram_count_word(ioopm_ngram_count_t *counter, const char *word, size_t length)
+{
+    uint32_t id = word_id(counter, word, length);
+
+    counter->total++;
+    counter->window[1] = (counter->window[1] << Id_Bits) | (counter->window[0] >> Id_Bits);
+    counter->window[0] = (counter->window[0] << Id_Bits) | id;
+    if (counter->seen < counter->n && ++counter->seen < counter->n)
+    {
+        return;
+    }
+
+    uint64_t low = counter->window[0];
+    uint64_t high = counter->window[1] & counter->high_mask;
+    size_t slot = slot_find(counter, low, high);
+
+    if (counter->counts[slot] != 0)
+    {
+        // saturates instead of wrapping to an empty slot
+        counter->counts[slot] += counter->counts[slot] != UINT32_MAX;
+        return;
+    }
+
+    counter->keys[slot * counter->key_words] = low;
+    if (counter->key_words == 2)
+    {
+        counter->keys[slot * 2 + 1] = high;
+    }
+    counter->counts[slot] = 1;
+    counter->size++;
+
+    if (too_full(counter->size, counter->mask))
+    {
+        slots_grow(counter);
+    }
+}
+
+void ioopm_ngram_count_break(ioopm_ngram_count_t *counter)
+{
+    counter->window[0] = 0;
+    counter->window[1] = 0;
+    counter->seen = 0;
+}
+
+size_t ioopm_ngram_count_size(ioopm_ngram_count_t *counter)
+{
+    return counter->size;
+}
+
+size_t ioopm_ngram_count_total(ioopm_ngram_count_t *counter)
+{
+    return counter->total;
+}
+
+size_t ioopm_ngram_count_words(ioopm_ngram_count_t *counter)
+{
+    return counter->word_count;
+}
+
+// The id of word i of the n-gram in a slot, the first word being 0
+static inline uint32_t id_in_key(ioopm_ngram_count_t *counter, size_t slot, size_t i)
+{
+    size_t from_last = counter->n - 1 - i;
+    uint64_t word = counter->keys[slot * counter->key_words + from_last / 2];
+
+    return word >> (Id_Bits * (from_last % 2));
+}
+
+ioopm_string_entry_t *ioopm_ngram_count_entries(ioopm_ngram_count_t *counter, size_t *count, char **text)
+{
+    ioopm_string_entry_t *entries = calloc(counter->size + 1, sizeof(ioopm_string_entry_t));
+    size_t text_length = 0;
+
+    // every word is followed by a space, or by the '\0' after the last word
+    for (size_t slot = 0; slot <= counter->mask; slot++)
+    {
+        for (size_t i = 0; counter->counts[slot] != 0 && i < counter->n; i++)
+        {
+            text_length += counter->lengths[id_in_key(counter, slot, i)] + 1;
+        }
+    }
+
+    char *next = *text = malloc(text_length + 1);
+    size_t entry = 0;
+
+    for (size_t slot = 0; slot <= counter->mask; slot++)
+    {
+        if (counter->counts[slot] == 0)
+        {
+            continue;
+        }
+
+        entries[entry].string = next;
+        entries[entry].value.unsigned_integer = counter->counts[slot];
+        entry++;
+
+        for (size_t i = 0; i < counter->n; i++)
+        {
+            uint32_t id = id_in_key(counter, slot, i);
+
+            memcpy(next, counter->words[id], counter->lengths[id]);
+            next += counter->lengths[id];
+            *next++ = i + 1 < counter->n ? ' ' : '\0';
+        }
+    }
+
+    *count = entry;
+    return entries;
+}
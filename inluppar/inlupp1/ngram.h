@@ -0,0 +1,70 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "string_sort.h"
+
+/**
+ * @file ngram.h
+ * @author Tuva Björnberg & Gustav Fridén
+ * @date 29/09-2023
+ * @brief Counts of the sequences of n words in a row (`ngram_count_t`), for n from 2 to
+ * Ngram_Max.
+ *
+ * Every different word is stored once and known by a 32 bit id, its index in the order
+ * the words were first seen. An n-gram is the ids of its words packed into one key of 64
+ * bits for bigrams or 128 bits for longer n-grams, with the first word in the highest
+ * bits, so no n-gram is stored as a string. The keys are counted in a table with open
+ * addressing whose slots are found by mixing the bits of the key. The last n ids are
+ * kept as a key that each new word is shifted into.
+ *
+ * The words are only joined into strings, separated by spaces, when the counts are taken
+ * out with ioopm_ngram_count_entries.
+ */
+
+#define Ngram_Max 4
+
+typedef struct ngram_count ioopm_ngram_count_t;
+
+/// @brief Creates an empty count of n-grams
+/// @param n the number of words in an n-gram, from 2 to Ngram_Max
+/// @return the new count
+ioopm_ngram_count_t *ioopm_ngram_count_create(size_t n);
+
+/// @brief Return the memory of a count of n-grams, including its copies of words
+/// @param counter the count to be destroyed
+void ioopm_ngram_count_destroy(ioopm_ngram_count_t *counter);
+
+/// @brief Add the next word, counting the n-gram it ends if n words have been added
+/// since the last break
+/// @param counter the count
+/// @param word the word, which need not end with '\0'
+/// @param length the number of bytes in word
+void ioopm_ngram_count_word(ioopm_ngram_count_t *counter, const char *word, size_t length);
+
+/// @brief End a sequence of words, such as a file, so that no n-gram spans the break
+/// @param counter the count
+void ioopm_ngram_count_break(ioopm_ngram_count_t *counter);
+
+/// @brief The number of different n-grams counted
+/// @param counter the count
+/// @return the number of n-grams
+size_t ioopm_ngram_count_size(ioopm_ngram_count_t *counter);
+
+/// @brief The number of words added
+/// @param counter the count
+/// @return the number of words, counting repeats
+size_t ioopm_ngram_count_total(ioopm_ngram_count_t *counter);
+
+/// @brief The number of different words seen
+/// @param counter the count
+/// @return the number of words
+size_t ioopm_ngram_count_words(ioopm_ngram_count_t *counter);
+
+/// @brief The n-grams with their counts, in no particular order
+/// @param counter the count
+/// @param count set to the number of n-grams
+/// @param text set to the memory holding the n-grams as strings, with their words
+/// separated by one space
+/// @return a heap allocated array of n-grams and counts in .unsigned_integer. The array
+/// and text are freed by the caller.
+ioopm_string_entry_t *ioopm_ngram_count_entries(ioopm_ngram_count_t *counter, size_t *count, char **text);
@@ -0,0 +1,219 @@
+#include <CUnit/Basic.h>
+#include "ngram.h"
+#include "string_sort.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Distinct_Words 5000
+
+int init_suite(void)
+{
+    return 0;
+}
+
+int clean_suite(void)
+{
+    return 0;
+}
+
+// Adds the words of a text separated by single spaces
+static void count_text(ioopm_ngram_count_t *counter, char *text)
+{
+    char *start = text;
+
+    for (char *c = text; ; c++)
+    {
+        if (*c == ' ' || *c == '\0')
+        {
+            if (c > start)
+            {
+                ioopm_ngram_count_word(counter, start, c - start);
+            }
+            start = c + 1;
+        }
+        if (*c == '\0')
+        {
+            return;
+        }
+    }
+}
+
+// The count of an n-gram in entries, or 0 if it is missing
+static unsigned count_of(ioopm_string_entry_t *entries, size_t count, char *ngram)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strcmp(entries[i].string, ngram) == 0)
+        {
+            return entries[i].value.unsigned_integer;
+        }
+    }
+    return 0;
+}
+
+void test_bigrams()
+{
+    ioopm_ngram_count_t *counter = ioopm_ngram_count_create(2);
+    size_t count;
+    char *text;
+
+    ioopm_string_entry_t *entries = ioopm_ngram_count_entries(counter, &count, &text);
+    CU_ASSERT_EQUAL(count, 0);
+    free(entries);
+    free(text);
+
+    // one word is not a bigram
+    count_text(counter, "the");
+    CU_ASSERT_EQUAL(ioopm_ngram_count_size(counter), 0);
+    count_text(counter, "cat sat on the cat sat");
+    CU_ASSERT_EQUAL(ioopm_ngram_count_size(counter), 4);
+    CU_ASSERT_EQUAL(ioopm_ngram_count_words(counter), 4);
+    CU_ASSERT_EQUAL(ioopm_ngram_count_total(counter), 7);
+
+    entries = ioopm_ngram_count_entries(counter, &count, &text);
+    ioopm_string_sort(entries, count);
+    CU_ASSERT_EQUAL(count, 4);
+    CU_ASSERT_STRING_EQUAL(entries[0].string, "cat sat");
+    CU_ASSERT_EQUAL(entries[0].value.unsigned_integer, 2);
+    CU_ASSERT_STRING_EQUAL(entries[1].string, "on the");
+    CU_ASSERT_STRING_EQUAL(entries[2].string, "sat on");
+    CU_ASSERT_STRING_EQUAL(entries[3].string, "the cat");
+    CU_ASSERT_EQUAL(entries[3].value.unsigned_integer, 2);
+    // the order of the words matters
+    CU_ASSERT_EQUAL(count_of(entries, count, "sat cat"), 0);
+    free(entries);
+    free(text);
+
+    ioopm_ngram_count_destroy(counter);
+}
+
+void test_breaks()
+{
+    ioopm_ngram_count_t *counter = ioopm_ngram_count_create(3);
+    size_t count;
+    char *text;
+
+    count_text(counter, "a b c");
+    ioopm_ngram_count_break(counter);
+    count_text(counter, "d a b");
+    ioopm_ngram_count_break(counter);
+    // too short for a trigram on its own
+    count_text(counter, "c d");
+    ioopm_ngram_count_break(counter);
+    count_text(counter, "a b c");
+
+    ioopm_string_entry_t *entries = ioopm_ngram_count_entries(counter, &count, &text);
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_EQUAL(count_of(entries, count, "a b c"), 2);
+    CU_ASSERT_EQUAL(count_of(entries, count, "d a b"), 1);
+    CU_ASSERT_EQUAL(count_of(entries, count, "b c d"), 0);
+    free(entries);
+    free(text);
+
+    ioopm_ngram_count_destroy(counter);
+}
+
+void test_long_ngrams()
+{
+    ioopm_ngram_count_t *counter = ioopm_ngram_count_create(4);
+    size_t count;
+    char *text;
+
+    // the first word is kept in the high word of the key
+    count_text(counter, "w x y z w x y q w x y z");
+    ioopm_string_entry_t *entries = ioopm_ngram_count_entries(counter, &count, &text);
+    CU_ASSERT_EQUAL(count, 8);
+    CU_ASSERT_EQUAL(count_of(entries, count, "w x y z"), 2);
+    CU_ASSERT_EQUAL(count_of(entries, count, "w x y q"), 1);
+    CU_ASSERT_EQUAL(count_of(entries, count, "z w x y"), 1);
+    CU_ASSERT_EQUAL(count_of(entries, count, "q w x y"), 1);
+    free(entries);
+    free(text);
+
+    ioopm_ngram_count_destroy(counter);
+}
+
+void test_many_ngrams()
+{
+    ioopm_ngram_count_t *counter = ioopm_ngram_count_create(2);
+    char buf[32];
+    size_t count;
+    char *text;
+
+    // word i is followed by word i + 1 and by word i * 7 % Distinct_Words, so every
+    // bigram is new until the tables have grown several times
+    for (int round = 0; round < 2; round++)
+    {
+        for (int i = 0; i < Distinct_Words; i++)
+        {
+            ioopm_ngram_count_word(counter, buf, sprintf(buf, "w%d", i));
+            ioopm_ngram_count_word(counter, buf, sprintf(buf, "v%d", i * 7 % Distinct_Words));
+        }
+        ioopm_ngram_count_break(counter);
+    }
+    CU_ASSERT_EQUAL(ioopm_ngram_count_words(counter), 2 * Distinct_Words);
+    CU_ASSERT_EQUAL(ioopm_ngram_count_size(counter), 2 * Distinct_Words - 1);
+
+    ioopm_string_entry_t *entries = ioopm_ngram_count_entries(counter, &count, &text);
+    CU_ASSERT_EQUAL(count, 2 * Distinct_Words - 1);
+    CU_ASSERT_EQUAL(count_of(entries, count, "w3 v21"), 2);
+    CU_ASSERT_EQUAL(count_of(entries, count, "v21 w4"), 2);
+    CU_ASSERT_EQUAL(count_of(entries, count, "w4 v21"), 0);
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        total += entries[i].value.unsigned_integer;
+    }
+    CU_ASSERT_EQUAL(total, 2 * (2 * Distinct_Words - 1));
+    free(entries);
+    free(text);
+
+    ioopm_ngram_count_destroy(counter);
+}
+
+int main()
+{
+    // First we try to set up CUnit, and exit if we fail
+    if (CU_initialize_registry() != CUE_SUCCESS)
+        return CU_get_error();
+
+    // We then create an empty test suite and specify the name and
+    // the init and cleanup functions
+    CU_pSuite my_test_suite = CU_add_suite("Tests for ngram.c", init_suite, clean_suite);
+    if (my_test_suite == NULL)
+    {
+        // If the test suite could not be added, tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // This is where we add the test functions to our test suite.
+    // For each call to CU_add_test we specify the test suite, the
+    // name or description of the test, and the function that runs
+    // the test in question. If you want to add another test, just
+    // copy a line below and change the information
+    if (
+        (CU_add_test(my_test_suite, "Count bigrams", test_bigrams) == NULL ||
+         CU_add_test(my_test_suite, "No n-gram spans a break", test_breaks) == NULL ||
+         CU_add_test(my_test_suite, "Count n-grams in 128 bit keys", test_long_ngrams) == NULL ||
+         CU_add_test(my_test_suite, "Count n-grams while the tables grow", test_many_ngrams) == NULL))
+    {
+        // If adding any of the tests fails, we tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Set the running mode. Use CU_BRM_VERBOSE for maximum output.
+    // Use CU_BRM_NORMAL to only print errors and a summary
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+
+    // This is where the tests are actually run!
+    CU_basic_run_tests();
+
+    // Tear down CUnit before exiting
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,243 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include "parallel.h"
+#include "linked_list.h"
+#include "vector.h"
+#include "thread_pool.h"
+#include "common.h"
+
+/// Segments are at least MIN_SEGMENT elements long so a task outweighs handing it out,
+/// and each thread gets up to SEGMENTS_PER_THREAD of them to even out uneven work.
+#define MIN_SEGMENT 1024
+#define SEGMENTS_PER_THREAD 4
+
+typedef struct segment segment_t;
+
+struct segment
+{
+    ioopm_list_t *list;     // the segment of a list, or NULL for a vector
+    elem_t *values;         // the segment of a vector
+    size_t count;
+    ioopm_apply_int_function fun;
+    ioopm_int_predicate prop;
+    ioopm_combine_function combine;
+    void *extra;
+    elem_t result;          // reduce: the combined value of the segment
+    ioopm_list_t *found;    // filter of a list: the elements where prop holds
+    ioopm_vector_t *found_values; // filter of a vector: the elements where prop holds
+};
+
+static size_t segment_count(ioopm_thread_pool_t *pool, size_t size)
+{
+    size_t count = ioopm_thread_pool_size(pool) * SEGMENTS_PER_THREAD;
+
+    if (size / MIN_SEGMENT < count)
+    {
+        count = size / MIN_SEGMENT;
+    }
+    return count > 0 ? count : 1;
+}
+
+static void fold_element(elem_t *value, void *arg)
+{
+    segment_t *segment = arg;
+    segment->result = segment->combine(segment->result, *value, segment->extra);
+}
+
+static void filter_element(elem_t *value, void *arg)
+{
+    segment_t *segment = arg;
+
+    if (segment->prop(*value, segment->extra))
+    {
+        ioopm_linked_list_append(segment->found, *value);
+    }
+}
+
+static void list_apply_task(void *arg)
+{
+    segment_t *segment = arg;
+    ioopm_linked_list_apply_to_all(segment->list, segment->fun, segment->extra);
+}
+
+static void list_reduce_task(void *arg)
+{
+    segment_t *segment = arg;
+    ioopm_linked_list_apply_to_all(segment->list, fold_element, segment);
+}
+
+static void list_filter_task(void *arg)
+{
+    segment_t *segment = arg;
+    segment->found = ioopm_linked_list_create(NULL);
+    ioopm_linked_list_apply_to_all(segment->list, filter_element, segment);
+}
+
+// Splits list into segments of about equal length, the first segment being list itself.
+// Splitting from the back means every split walks only one segment from the end.
+static segment_t *list_segments(ioopm_thread_pool_t *pool, ioopm_list_t *list, size_t *count, segment_t base)
+{
+    size_t size = ioopm_linked_list_size(list);
+    *count = segment_count(pool, size);
+    segment_t *segments = calloc(*count, sizeof(segment_t));
+
+    for (size_t i = *count; i-- > 0;)
+    {
+        segments[i] = base;
+        segments[i].list = i == 0 ? list : ioopm_linked_list_split_at(list, size * i / *count);
+    }
+
+    return segments;
+}
+
+// Runs task on every segment of list and joins the segments back into list
+static segment_t *list_run(ioopm_thread_pool_t *pool, ioopm_list_t *list, ioopm_task_function task, size_t *count, segment_t base)
+{
+    segment_t *segments = list_segments(pool, list, count, base);
+
+    ioopm_thread_pool_run(pool, task, segments, sizeof(segment_t), *count);
+
+    for (size_t i = 1; i < *count; i++)
+    {
+        ioopm_linked_list_concat(list, segments[i].list);
+        ioopm_linked_list_destroy(segments[i].list);
+    }
+
+    return segments;
+}
+
+void ioopm_linked_list_parallel_apply(ioopm_thread_pool_t *pool, ioopm_list_t *list, ioopm_apply_int_function fun, void *extra)
+{
+    size_t count;
+    segment_t *segments = list_run(pool, list, list_apply_task, &count, (segment_t){.fun = fun, .extra = extra});
+
+    free(segments);
+}
+
+elem_t ioopm_linked_list_parallel_reduce(ioopm_thread_pool_t *pool, ioopm_list_t *list, elem_t identity, ioopm_combine_function combine, void *extra)
+{
+    size_t count;
+    segment_t base = {.combine = combine, .extra = extra, .result = identity};
+    segment_t *segments = list_run(pool, list, list_reduce_task, &count, base);
+
+    elem_t result = identity;
+    for (size_t i = 0; i < count; i++)
+    {
+        result = combine(result, segments[i].result, extra);
+    }
+
+    free(segments);
+    return result;
+}
+
+void ioopm_linked_list_parallel_filter(ioopm_thread_pool_t *pool, ioopm_list_t *list, ioopm_int_predicate prop, void *extra, ioopm_list_t *result)
+{
+    size_t count;
+    segment_t *segments = list_run(pool, list, list_filter_task, &count, (segment_t){.prop = prop, .extra = extra});
+
+    for (size_t i = 0; i < count; i++)
+    {
+        ioopm_linked_list_concat(result, segments[i].found);
+        ioopm_linked_list_destroy(segments[i].found);
+    }
+
+    free(segments);
+}
+
+static void vector_apply_task(void *arg)
+{
+    segment_t *segment = arg;
+
+    for (size_t i = 0; i < segment->count; i++)
+    {
+        segment->fun(&segment->values[i], segment->extra);
+    }
+}
+
+static void vector_reduce_task(void *arg)
+{
+    segment_t *segment = arg;
+
+    for (size_t i = 0; i < segment->count; i++)
+    {
+        segment->result = segment->combine(segment->result, segment->values[i], segment->extra);
+    }
+}
+
+static void vector_filter_task(void *arg)
+{
+    segment_t *segment = arg;
+    segment->found_values = ioopm_vector_create(NULL);
+
+    for (size_t i = 0; i < segment->count; i++)
+    {
+        if (segment->prop(segment->values[i], segment->extra))
+        {
+            ioopm_vector_append(segment->found_values, segment->values[i]);
+        }
+    }
+}
+
+// Runs task on segments of the elements of vector
+static segment_t *vector_run(ioopm_thread_pool_t *pool, ioopm_vector_t *vector, ioopm_task_function task, size_t *count, segment_t base)
+{
+    size_t size = ioopm_vector_size(vector);
+    elem_t *values = ioopm_vector_data(vector);
+    *count = segment_count(pool, size);
+    segment_t *segments = calloc(*count, sizeof(segment_t));
+
+    for (size_t i = 0; i < *count; i++)
+    {
+        size_t start = size * i / *count;
+        segments[i] = base;
+        segments[i].values = values + start;
+        segments[i].count = size * (i + 1) / *count - start;
+    }
+
+    ioopm_thread_pool_run(pool, task, segments, sizeof(segment_t), *count);
+    return segments;
+}
+
+void ioopm_vector_parallel_apply(ioopm_thread_pool_t *pool, ioopm_vector_t *vector, ioopm_apply_int_function fun, void *extra)
+{
+    size_t count;
+    segment_t *segments = vector_run(pool, vector, vector_apply_task, &count, (segment_t){.fun = fun, .extra = extra});
+
+    free(segments);
+}
+
+elem_t ioopm_vector_parallel_reduce(ioopm_thread_pool_t *pool, ioopm_vector_t *vector, elem_t identity, ioopm_combine_function combine, void *extra)
+{
+    size_t count;
+    segment_t base = {.combine = combine, .extra = extra, .result = identity};
+    segment_t *segments = vector_run(pool, vector, vector_reduce_task, &count, base);
+
+    elem_t result = identity;
+    for (size_t i = 0; i < count; i++)
+    {
+        result = combine(result, segments[i].result, extra);
+    }
+
+    free(segments);
+    return result;
+}
+
+void ioopm_vector_parallel_filter(ioopm_thread_pool_t *pool, ioopm_vector_t *vector, ioopm_int_predicate prop, void *extra, ioopm_vector_t *result)
+{
+    size_t count;
+    segment_t *segments = vector_run(pool, vector, vector_filter_task, &count, (segment_t){.prop = prop, .extra = extra});
+
+    for (size_t i = 0; i < count; i++)
+    {
+        ioopm_vector_t *found = segments[i].found_values;
+        elem_t *values = ioopm_vector_data(found);
+
+        for (size_t j = 0; j < ioopm_vector_size(found); j++)
+        {
+            ioopm_vector_append(result, values[j]);
+        }
+        ioopm_vector_destroy(found);
+    }
+
+    free(segments);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "common.h"
+#include "linked_list.h"
+#include "vector.h"
+#include "thread_pool.h"
+
+/**
+ * @file parallel.h
+ * @author Tuva Björnberg & Gustav Fridén
+ * @date 29/09-2023
+ * @brief Parallel apply, reduce and filter over linked lists and vectors.
+ *
+ * The elements are divided into segments that run as tasks on a thread pool. A list is
+ * split into segment lists with ioopm_linked_list_split_at and joined again with
+ * ioopm_linked_list_concat, so no elements are copied. Short containers are handled by
+ * the calling thread alone.
+ *
+ * The functions passed in are called from several threads at once and must be safe to
+ * call concurrently. No other thread may use the container during a call.
+ */
+
+typedef elem_t(*ioopm_combine_function)(elem_t a, elem_t b, void *extra);
+
+/// @brief Apply a supplied function to all elements in a list, in parallel
+/// @param pool the threads to use
+/// @param list the linked list
+/// @param fun the function to be applied
+/// @param extra an additional argument (may be NULL) that will be passed to all calls of fun
+void ioopm_linked_list_parallel_apply(ioopm_thread_pool_t *pool, ioopm_list_t *list, ioopm_apply_int_function fun, void *extra);
+
+/// @brief Combine all elements in a list into one value, in parallel. Each segment is
+/// combined from identity and left to right, and the results of the segments are combined
+/// in order, so combine must be associative but need not be commutative.
+/// @param pool the threads to use
+/// @param list the linked list
+/// @param identity a value that combine leaves unchanged, like 0 for a sum
+/// @param combine the function combining two values
+/// @param extra an additional argument (may be NULL) that will be passed to all calls of combine
+/// @return the combined value, identity for an empty list
+elem_t ioopm_linked_list_parallel_reduce(ioopm_thread_pool_t *pool, ioopm_list_t *list, elem_t identity, ioopm_combine_function combine, void *extra);
+
+/// @brief Append the elements of a list for which a property holds to another list, in their
+/// order, testing the elements in parallel
+/// @param pool the threads to use
+/// @param list the linked list
+/// @param prop the property to be tested
+/// @param extra an additional argument (may be NULL) that will be passed to all calls of prop
+/// @param result the list the elements are appended to, must not be list
+void ioopm_linked_list_parallel_filter(ioopm_thread_pool_t *pool, ioopm_list_t *list, ioopm_int_predicate prop, void *extra, ioopm_list_t *result);
+
+/// @brief Apply a supplied function to all elements in a vector, in parallel
+/// @param pool the threads to use
+/// @param vector the vector
+/// @param fun the function to be applied
+/// @param extra an additional argument (may be NULL) that will be passed to all calls of fun
+void ioopm_vector_parallel_apply(ioopm_thread_pool_t *pool, ioopm_vector_t *vector, ioopm_apply_int_function fun, void *extra);
+
+/// @brief Combine all elements in a vector into one value, in parallel, like
+/// ioopm_linked_list_parallel_reduce
+/// @param pool the threads to use
+/// @param vector the vector
+/// @param identity a value that combine leaves unchanged, like 0 for a sum
+/// @param combine the function combining two values, must be associative
+/// @param extra an additional argument (may be NULL) that will be passed to all calls of combine
+/// @return the combined value, identity for an empty vector
+elem_t ioopm_vector_parallel_reduce(ioopm_thread_pool_t *pool, ioopm_vector_t *vector, elem_t identity, ioopm_combine_function combine, void *extra);
+
+/// @brief Append the elements of a vector for which a property holds to another vector, in
+/// their order, testing the elements in parallel
+/// @param pool the threads to use
+/// @param vector the vector
+/// @param prop the property to be tested
+/// @param extra an additional argument (may be NULL) that will be passed to all calls of prop
+/// @param result the vector the elements are appended to, must not be vector
+void ioopm_vector_parallel_filter(ioopm_thread_pool_t *pool, ioopm_vector_t *vector, ioopm_int_predicate prop, void *extra, ioopm_vector_t *result);
@@ -0,0 +1,214 @@
+#include <CUnit/Basic.h>
+#include "parallel.h"
+#include "thread_pool.h"
+#include "linked_list.h"
+#include "vector.h"
+#include "common.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define Elements 100000
+
+static ioopm_thread_pool_t *pool;
+
+int init_suite(void)
+{
+    pool = ioopm_thread_pool_create(4);
+    return 0;
+}
+
+int clean_suite(void)
+{
+    ioopm_thread_pool_destroy(pool);
+    return 0;
+}
+
+static bool bool_eq_fun(elem_t a, elem_t b)
+{
+    return b.integer == a.integer;
+}
+
+static void add_to_value(elem_t *value, void *extra)
+{
+    value->integer += *(int *) extra;
+}
+
+static bool is_multiple(elem_t value, void *extra)
+{
+    return value.integer % *(int *) extra == 0;
+}
+
+static elem_t sum_mod_seven(elem_t a, elem_t b, void *extra)
+{
+    return int_elem((a.integer + b.integer) % 7);
+}
+
+// Associative but not commutative, so the segments must be combined in order
+static elem_t keep_last(elem_t a, elem_t b, void *extra)
+{
+    return b.integer == -1 ? a : b;
+}
+
+static void count_task(void *arg)
+{
+    (*(int *) arg)++;
+}
+
+void test_thread_pool()
+{
+    int counters[100] = {0};
+
+    CU_ASSERT_EQUAL(ioopm_thread_pool_size(pool), 4);
+
+    // every task runs exactly once, over several batches
+    for (int batch = 0; batch < 50; batch++)
+    {
+        ioopm_thread_pool_run(pool, count_task, counters, sizeof(int), 100);
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        CU_ASSERT_EQUAL(counters[i], 50);
+    }
+
+    ioopm_thread_pool_t *single = ioopm_thread_pool_create(1);
+    ioopm_thread_pool_run(single, count_task, counters, sizeof(int), 100);
+    CU_ASSERT_EQUAL(counters[99], 51);
+    ioopm_thread_pool_destroy(single);
+}
+
+static void test_list_of_size(int size)
+{
+    ioopm_list_t *list = ioopm_linked_list_create(bool_eq_fun);
+    int added = 1;
+    int divisor = 3;
+    int sum = 0;
+
+    for (int i = 0; i < size; i++)
+    {
+        ioopm_int_ll_append(list, i);
+        sum = (sum + i + added) % 7;
+    }
+
+    ioopm_linked_list_parallel_apply(pool, list, add_to_value, &added);
+    CU_ASSERT_EQUAL(ioopm_linked_list_size(list), size);
+    CU_ASSERT_EQUAL(ioopm_linked_list_parallel_reduce(pool, list, int_elem(0), sum_mod_seven, NULL).integer, sum);
+    CU_ASSERT_EQUAL(ioopm_linked_list_parallel_reduce(pool, list, int_elem(-1), keep_last, NULL).integer, size > 0 ? size : -1);
+
+    ioopm_list_t *found = ioopm_linked_list_create(bool_eq_fun);
+    ioopm_linked_list_parallel_filter(pool, list, is_multiple, &divisor, found);
+    CU_ASSERT_EQUAL(ioopm_linked_list_size(found), size / 3);
+
+    // the filtered elements keep their order and the list is joined again
+    bool in_order = true;
+    for (int i = 0; i < ioopm_linked_list_size(found); i++)
+    {
+        in_order = in_order && ioopm_linked_list_get(found, i).integer == 3 * (i + 1);
+    }
+    CU_ASSERT_TRUE(in_order);
+
+    bool list_intact = true;
+    for (int i = 0; i < size; i++)
+    {
+        list_intact = list_intact && ioopm_linked_list_get(list, i).integer == i + 1;
+    }
+    CU_ASSERT_TRUE(list_intact);
+
+    ioopm_linked_list_destroy(found);
+    ioopm_linked_list_destroy(list);
+}
+
+void test_list_parallel()
+{
+    test_list_of_size(0);
+    test_list_of_size(10);
+    test_list_of_size(Elements);
+}
+
+static void test_vector_of_size(int size)
+{
+    ioopm_vector_t *vector = ioopm_vector_create(bool_eq_fun);
+    int added = 1;
+    int divisor = 3;
+    int sum = 0;
+
+    for (int i = 0; i < size; i++)
+    {
+        ioopm_int_vector_append(vector, i);
+        sum = (sum + i + added) % 7;
+    }
+
+    ioopm_vector_parallel_apply(pool, vector, add_to_value, &added);
+    CU_ASSERT_EQUAL(ioopm_vector_parallel_reduce(pool, vector, int_elem(0), sum_mod_seven, NULL).integer, sum);
+    CU_ASSERT_EQUAL(ioopm_vector_parallel_reduce(pool, vector, int_elem(-1), keep_last, NULL).integer, size > 0 ? size : -1);
+
+    ioopm_vector_t *found = ioopm_vector_create(bool_eq_fun);
+    ioopm_vector_parallel_filter(pool, vector, is_multiple, &divisor, found);
+    CU_ASSERT_EQUAL(ioopm_vector_size(found), size / 3);
+
+    bool in_order = true;
+    for (int i = 0; i < ioopm_vector_size(found); i++)
+    {
+        in_order = in_order && ioopm_vector_get(found, i).integer == 3 * (i + 1);
+    }
+    CU_ASSERT_TRUE(in_order);
+
+    bool applied = true;
+    for (int i = 0; i < size; i++)
+    {
+        applied = applied && ioopm_vector_get(vector, i).integer == i + 1;
+    }
+    CU_ASSERT_TRUE(applied);
+
+    ioopm_vector_destroy(found);
+    ioopm_vector_destroy(vector);
+}
+
+void test_vector_parallel()
+{
+    test_vector_of_size(0);
+    test_vector_of_size(10);
+    test_vector_of_size(Elements);
+}
+
+int main()
+{
+    // First we try to set up CUnit, and exit if we fail
+    if (CU_initialize_registry() != CUE_SUCCESS)
+        return CU_get_error();
+
+    // We then create an empty test suite and specify the name and
+    // the init and cleanup functions
+    CU_pSuite my_test_suite = CU_add_suite("Tests for parallel.c", init_suite, clean_suite);
+    if (my_test_suite == NULL)
+    {
+        // If the test suite could not be added, tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // This is where we add the test functions to our test suite.
+    // For each call to CU_add_test we specify the test suite, the
+    // name or description of the test, and the function that runs
+    // the test in question. If you want to add another test, just
+    // copy a line below and change the information
+    if (
+        (CU_add_test(my_test_suite, "Run batches of tasks on a thread pool", test_thread_pool) == NULL ||
+         CU_add_test(my_test_suite, "Parallel apply, reduce and filter on lists", test_list_parallel) == NULL ||
+         CU_add_test(my_test_suite, "Parallel apply, reduce and filter on vectors", test_vector_parallel) == NULL))
+    {
+        // If adding any of the tests fails, we tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Set the running mode. Use CU_BRM_VERBOSE for maximum output.
+    // Use CU_BRM_NORMAL to only print errors and a summary
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+
+    // This is where the tests are actually run!
+    CU_basic_run_tests();
+
+    // Tear down CUnit before exiting
+    CU_cleanup_registry();
+    return CU_get_error();
+}
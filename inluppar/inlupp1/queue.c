@@ -0,0 +1,257 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "queue.h"
+#include "common.h"
+
+/// Keeps the producer and consumer positions of the ring on separate cache lines,
+/// so the two threads do not invalidate each other's line on every operation.
+#define CACHE_LINE 64
+
+typedef struct node node_t;
+
+struct node
+{
+    _Atomic(node_t *) next;
+    elem_t value;
+};
+
+struct mpsc_queue
+{
+    _Atomic(node_t *) head; // the last pushed node, swapped by the producers
+    node_t *tail;           // a consumed node whose next is the front of the queue, owned by the consumer
+};
+
+struct spsc_ring
+{
+    _Alignas(CACHE_LINE) atomic_size_t head; // next position to pop, written by the consumer
+    _Alignas(CACHE_LINE) atomic_size_t tail; // next position to push, written by the producer
+    _Alignas(CACHE_LINE) size_t mask;        // capacity - 1
+    elem_t *values;
+};
+
+// top and bottom are signed, since a pop moves bottom below top for a moment when the
+// deque is empty
+struct steal_deque
+{
+    _Alignas(CACHE_LINE) atomic_long top;    // next position to steal, moved by thieves and the last pop
+    _Alignas(CACHE_LINE) atomic_long bottom; // next position to push, written by the owner
+    _Alignas(CACHE_LINE) long mask;          // capacity - 1
+    // a thief may read a slot the owner writes again after the thief lost the race
+    // for it, so the slots are atomic too
+    _Atomic(elem_t) *values;
+};
+
+static node_t *node_create(elem_t value)
+{
+    node_t *node = calloc(1, sizeof(node_t));
+    node->value = value;
+    atomic_init(&node->next, NULL);
+    return node;
+}
+
+ioopm_mpsc_queue_t *ioopm_mpsc_queue_create(void)
+{
+    ioopm_mpsc_queue_t *queue = calloc(1, sizeof(ioopm_mpsc_queue_t));
+
+    // the queue starts with a consumed stub node so head and tail are never NULL
+    node_t *stub = node_create((elem_t){.void_ptr = NULL});
+    atomic_init(&queue->head, stub);
+    queue->tail = stub;
+
+    return queue;
+}
+
+void ioopm_mpsc_queue_destroy(ioopm_mpsc_queue_t *queue)
+{
+    node_t *current = queue->tail;
+
+    while (current != NULL)
+    {
+        node_t *next = atomic_load_explicit(&current->next, memory_order_relaxed);
+        free(current);
+        current = next;
+    }
+
+    free(queue);
+}
+
+void ioopm_mpsc_queue_push(ioopm_mpsc_queue_t *queue, elem_t value)
+{
+    node_t *node = node_create(value);
+
+    // claim the last place, then link the previous last node to it. Between the two steps
+    // the consumer sees the queue end at prev.
+    node_t *prev = atomic_exchange_explicit(&queue->head, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+bool ioopm_mpsc_queue_pop(ioopm_mpsc_queue_t *queue, elem_t *value)
+{
+    node_t *tail = queue->tail;
+    node_t *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    if (next == NULL)
+    {
+        return false;
+    }
+
+    // next becomes the consumed node and the old one is freed
+    *value = next->value;
+    queue->tail = next;
+    free(tail);
+    return true;
+}
+
+bool ioopm_mpsc_queue_is_empty(ioopm_mpsc_queue_t *queue)
+{
+    return atomic_load_explicit(&queue->tail->next, memory_order_acquire) == NULL;
+}
+
+ioopm_spsc_ring_t *ioopm_spsc_ring_create(size_t capacity)
+{
+    size_t rounded = 1;
+    while (rounded < capacity)
+    {
+        rounded *= 2;
+    }
+
+    ioopm_spsc_ring_t *ring = aligned_alloc(CACHE_LINE, sizeof(ioopm_spsc_ring_t));
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->mask = rounded - 1;
+    ring->values = calloc(rounded, sizeof(elem_t));
+
+    return ring;
+}
+
+void ioopm_spsc_ring_destroy(ioopm_spsc_ring_t *ring)
+{
+    free(ring->values);
+    free(ring);
+}
+
+// head and tail count every push and pop and are masked only when indexing, so
+// tail - head is the size even after they wrap around
+bool ioopm_spsc_ring_push(ioopm_spsc_ring_t *ring, elem_t value)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (tail - head > ring->mask)
+    {
+        return false;
+    }
+
+    ring->values[tail & ring->mask] = value;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool ioopm_spsc_ring_pop(ioopm_spsc_ring_t *ring, elem_t *value)
+{
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head == tail)
+    {
+        return false;
+    }
+
+    *value = ring->values[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+size_t ioopm_spsc_ring_size(ioopm_spsc_ring_t *ring)
+{
+    return atomic_load_explicit(&ring->tail, memory_order_acquire) - atomic_load_explicit(&ring->head, memory_order_acquire);
+}
+
+ioopm_steal_deque_t *ioopm_steal_deque_create(size_t capacity)
+{
+    size_t rounded = 1;
+    while (rounded < capacity)
+    {
+        rounded *= 2;
+    }
+
+    ioopm_steal_deque_t *deque = aligned_alloc(CACHE_LINE, sizeof(ioopm_steal_deque_t));
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    deque->mask = rounded - 1;
+    deque->values = calloc(rounded, sizeof(_Atomic(elem_t)));
+
+    return deque;
+}
+
+void ioopm_steal_deque_destroy(ioopm_steal_deque_t *deque)
+{
+    free(deque->values);
+    free(deque);
+}
+
+bool ioopm_steal_deque_push(ioopm_steal_deque_t *deque, elem_t value)
+{
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+
+    if (bottom - top > deque->mask)
+    {
+        return false;
+    }
+
+    atomic_store_explicit(&deque->values[bottom & deque->mask], value, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return true;
+}
+
+bool ioopm_steal_deque_pop(ioopm_steal_deque_t *deque, elem_t *value)
+{
+    // claim the bottom element first, then see whether a thief got to it. The fence
+    // makes sure a thief either sees the claim or has moved top before the owner reads it.
+    long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return false;
+    }
+
+    *value = atomic_load_explicit(&deque->values[bottom & deque->mask], memory_order_relaxed);
+    if (top < bottom)
+    {
+        return true;
+    }
+
+    // the last element, which the owner and the thieves race for by moving top
+    bool won = atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return won;
+}
+
+bool ioopm_steal_deque_steal(ioopm_steal_deque_t *deque, elem_t *value)
+{
+    while (true)
+    {
+        long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+        if (top >= bottom)
+        {
+            return false;
+        }
+
+        elem_t taken = atomic_load_explicit(&deque->values[top & deque->mask], memory_order_relaxed);
+        // another thief or the owner took the element first, try the next one
+        if (atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst, memory_order_relaxed))
+        {
+            *value = taken;
+            return true;
+        }
+    }
+}
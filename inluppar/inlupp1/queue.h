@@ -0,0 +1,113 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include "common.h"
+
+/**
+ * @file queue.h
+ * @author Tuva Björnberg & Gustav Fridén
+ * @date 29/09-2023
+ * @brief Lock-free queues (`mpsc_queue_t`, `spsc_ring_t`) and a work-stealing deque
+ * (`steal_deque_t`) for handing elements between threads.
+ *
+ * The multi-producer/single-consumer queue is an unbounded linked queue after Dmitry Vyukov.
+ * Any number of threads may push at the same time without locks, while only one thread at
+ * a time may pop. Every push allocates one node, which the consumer frees when popping it.
+ *
+ * The single-producer/single-consumer ring is a bounded array with one thread pushing and
+ * one thread popping. It never allocates after creation.
+ *
+ * The work-stealing deque is a bounded array after Chase and Lev, as written for C11 by
+ * Lê et al. Its owner thread pushes and pops at the bottom, last in first out, while any
+ * other thread may steal from the top, so thieves take the oldest elements and rarely
+ * meet the owner. It never allocates after creation.
+ *
+ * All three are built on C11 atomics and need to be linked with -pthread when used from
+ * several threads. Destroying one frees it but not the memory of its elements.
+ */
+
+typedef struct mpsc_queue ioopm_mpsc_queue_t;
+typedef struct spsc_ring ioopm_spsc_ring_t;
+typedef struct steal_deque ioopm_steal_deque_t;
+
+/// @brief Creates a new empty multi-producer/single-consumer queue
+/// @return an empty queue
+ioopm_mpsc_queue_t *ioopm_mpsc_queue_create(void);
+
+/// @brief Tear down the queue and return its memory, including nodes still in the queue.
+/// No other thread may use the queue during or after this call.
+/// @param queue the queue to be destroyed
+void ioopm_mpsc_queue_destroy(ioopm_mpsc_queue_t *queue);
+
+/// @brief Add an element to the back of the queue. Safe to call from any number of threads at once.
+/// @param queue the queue
+/// @param value the element to add
+void ioopm_mpsc_queue_push(ioopm_mpsc_queue_t *queue, elem_t value);
+
+/// @brief Take the element at the front of the queue. Only one thread at a time may pop.
+/// A push that has not finished yet may make the queue look empty for a moment.
+/// @param queue the queue
+/// @param value set to the element taken when the queue was not empty
+/// @return true if an element was taken, false if the queue was empty
+bool ioopm_mpsc_queue_pop(ioopm_mpsc_queue_t *queue, elem_t *value);
+
+/// @brief Test whether the queue is empty, as seen by the consumer
+/// @param queue the queue
+/// @return true if the next pop would find no element
+bool ioopm_mpsc_queue_is_empty(ioopm_mpsc_queue_t *queue);
+
+/// @brief Creates a new empty single-producer/single-consumer ring
+/// @param capacity the number of elements the ring can hold, rounded up to a power of two
+/// @return an empty ring
+ioopm_spsc_ring_t *ioopm_spsc_ring_create(size_t capacity);
+
+/// @brief Tear down the ring and return its memory
+/// @param ring the ring to be destroyed
+void ioopm_spsc_ring_destroy(ioopm_spsc_ring_t *ring);
+
+/// @brief Add an element to the back of the ring. Only the producer thread may push.
+/// @param ring the ring
+/// @param value the element to add
+/// @return true if the element was added, false if the ring was full
+bool ioopm_spsc_ring_push(ioopm_spsc_ring_t *ring, elem_t value);
+
+/// @brief Take the element at the front of the ring. Only the consumer thread may pop.
+/// @param ring the ring
+/// @param value set to the element taken when the ring was not empty
+/// @return true if an element was taken, false if the ring was empty
+bool ioopm_spsc_ring_pop(ioopm_spsc_ring_t *ring, elem_t *value);
+
+/// @brief The number of elements in the ring. Exact only when called from the producer
+/// or the consumer while the other thread is not using the ring.
+/// @param ring the ring
+/// @return the number of elements in the ring
+size_t ioopm_spsc_ring_size(ioopm_spsc_ring_t *ring);
+
+/// @brief Creates a new empty work-stealing deque
+/// @param capacity the number of elements the deque can hold, rounded up to a power of two
+/// @return an empty deque
+ioopm_steal_deque_t *ioopm_steal_deque_create(size_t capacity);
+
+/// @brief Tear down the deque and return its memory
+/// @param deque the deque to be destroyed
+void ioopm_steal_deque_destroy(ioopm_steal_deque_t *deque);
+
+/// @brief Add an element to the bottom of the deque. Only the owner thread may push.
+/// @param deque the deque
+/// @param value the element to add
+/// @return true if the element was added, false if the deque was full
+bool ioopm_steal_deque_push(ioopm_steal_deque_t *deque, elem_t value);
+
+/// @brief Take the element at the bottom of the deque, the last one pushed. Only the owner
+/// thread may pop.
+/// @param deque the deque
+/// @param value set to the element taken when the deque was not empty
+/// @return true if an element was taken, false if the deque was empty
+bool ioopm_steal_deque_pop(ioopm_steal_deque_t *deque, elem_t *value);
+
+/// @brief Take the element at the top of the deque, the first one pushed. Safe to call
+/// from any number of threads at once, also while the owner pushes and pops.
+/// @param deque the deque
+/// @param value set to the element taken when the deque was not empty
+/// @return true if an element was taken, false if the deque was empty
+bool ioopm_steal_deque_steal(ioopm_steal_deque_t *deque, elem_t *value);
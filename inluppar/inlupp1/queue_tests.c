@@ -0,0 +1,367 @@
+#include <CUnit/Basic.h>
+#include <pthread.h>
+#include <sched.h>
+#include "queue.h"
+#include "common.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define Producers 4
+#define Per_Producer 20000
+#define Ring_Elements 100000
+#define Thieves 3
+#define Deque_Elements 100000
+
+int init_suite(void)
+{
+    return 0;
+}
+
+int clean_suite(void)
+{
+    return 0;
+}
+
+typedef struct producer producer_t;
+
+struct producer
+{
+    ioopm_mpsc_queue_t *queue;
+    int id;
+};
+
+static void *mpsc_produce(void *arg)
+{
+    producer_t *producer = arg;
+
+    for (int i = 0; i < Per_Producer; i++)
+    {
+        ioopm_mpsc_queue_push(producer->queue, int_elem(producer->id * Per_Producer + i));
+    }
+    return NULL;
+}
+
+typedef struct thief thief_t;
+
+struct thief
+{
+    ioopm_steal_deque_t *deque;
+    bool *done;                 // set by the owner when it has pushed everything
+    char *taken;                // how many times the thief took each element
+};
+
+static void *steal_all(void *arg)
+{
+    thief_t *thief = arg;
+    elem_t value;
+
+    while (true)
+    {
+        // an empty deque is only final once the owner is done
+        bool done = __atomic_load_n(thief->done, __ATOMIC_ACQUIRE);
+
+        if (ioopm_steal_deque_steal(thief->deque, &value))
+        {
+            thief->taken[value.integer]++;
+        }
+        else if (done)
+        {
+            return NULL;
+        }
+        else
+        {
+            // let the owner run when there are fewer processors than threads
+            sched_yield();
+        }
+    }
+}
+
+static void *spsc_produce(void *arg)
+{
+    ioopm_spsc_ring_t *ring = arg;
+
+    for (int i = 0; i < Ring_Elements; i++)
+    {
+        while (!ioopm_spsc_ring_push(ring, int_elem(i)))
+        {
+            // the ring is full, wait for the consumer
+        }
+    }
+    return NULL;
+}
+
+void test_mpsc_single_thread()
+{
+    ioopm_mpsc_queue_t *queue = ioopm_mpsc_queue_create();
+    elem_t value;
+
+    CU_ASSERT_TRUE(ioopm_mpsc_queue_is_empty(queue));
+    CU_ASSERT_FALSE(ioopm_mpsc_queue_pop(queue, &value));
+
+    for (int i = 0; i < 10; i++)
+    {
+        ioopm_mpsc_queue_push(queue, int_elem(i));
+    }
+    CU_ASSERT_FALSE(ioopm_mpsc_queue_is_empty(queue));
+
+    for (int i = 0; i < 10; i++)
+    {
+        CU_ASSERT_TRUE(ioopm_mpsc_queue_pop(queue, &value));
+        CU_ASSERT_EQUAL(value.integer, i);
+    }
+    CU_ASSERT_FALSE(ioopm_mpsc_queue_pop(queue, &value));
+
+    // destroying frees the nodes still in the queue
+    ioopm_mpsc_queue_push(queue, int_elem(1));
+    ioopm_mpsc_queue_push(queue, int_elem(2));
+    ioopm_mpsc_queue_destroy(queue);
+}
+
+void test_mpsc_producers()
+{
+    ioopm_mpsc_queue_t *queue = ioopm_mpsc_queue_create();
+    pthread_t threads[Producers];
+    producer_t producers[Producers];
+    int next_expected[Producers] = {0};
+    int popped = 0;
+
+    for (int i = 0; i < Producers; i++)
+    {
+        producers[i] = (producer_t){.queue = queue, .id = i};
+        pthread_create(&threads[i], NULL, mpsc_produce, &producers[i]);
+    }
+
+    // the elements of each producer arrive in the order it pushed them
+    bool in_order = true;
+    while (popped < Producers * Per_Producer)
+    {
+        elem_t value;
+
+        if (ioopm_mpsc_queue_pop(queue, &value))
+        {
+            int id = value.integer / Per_Producer;
+            in_order = in_order && value.integer % Per_Producer == next_expected[id];
+            next_expected[id]++;
+            popped++;
+        }
+    }
+    CU_ASSERT_TRUE(in_order);
+
+    for (int i = 0; i < Producers; i++)
+    {
+        pthread_join(threads[i], NULL);
+        CU_ASSERT_EQUAL(next_expected[i], Per_Producer);
+    }
+    CU_ASSERT_TRUE(ioopm_mpsc_queue_is_empty(queue));
+
+    ioopm_mpsc_queue_destroy(queue);
+}
+
+void test_spsc_single_thread()
+{
+    ioopm_spsc_ring_t *ring = ioopm_spsc_ring_create(5);
+    elem_t value;
+
+    CU_ASSERT_FALSE(ioopm_spsc_ring_pop(ring, &value));
+
+    // the capacity is rounded up to 8
+    for (int i = 0; i < 8; i++)
+    {
+        CU_ASSERT_TRUE(ioopm_spsc_ring_push(ring, int_elem(i)));
+    }
+    CU_ASSERT_FALSE(ioopm_spsc_ring_push(ring, int_elem(8)));
+    CU_ASSERT_EQUAL(ioopm_spsc_ring_size(ring), 8);
+
+    // wrap around several times
+    for (int i = 8; i < 40; i++)
+    {
+        CU_ASSERT_TRUE(ioopm_spsc_ring_pop(ring, &value));
+        CU_ASSERT_EQUAL(value.integer, i - 8);
+        CU_ASSERT_TRUE(ioopm_spsc_ring_push(ring, int_elem(i)));
+    }
+    for (int i = 32; i < 40; i++)
+    {
+        CU_ASSERT_TRUE(ioopm_spsc_ring_pop(ring, &value));
+        CU_ASSERT_EQUAL(value.integer, i);
+    }
+    CU_ASSERT_FALSE(ioopm_spsc_ring_pop(ring, &value));
+    CU_ASSERT_EQUAL(ioopm_spsc_ring_size(ring), 0);
+
+    ioopm_spsc_ring_destroy(ring);
+}
+
+void test_spsc_threads()
+{
+    ioopm_spsc_ring_t *ring = ioopm_spsc_ring_create(64);
+    pthread_t producer;
+    int expected = 0;
+    bool in_order = true;
+
+    pthread_create(&producer, NULL, spsc_produce, ring);
+
+    while (expected < Ring_Elements)
+    {
+        elem_t value;
+
+        if (ioopm_spsc_ring_pop(ring, &value))
+        {
+            in_order = in_order && value.integer == expected;
+            expected++;
+        }
+    }
+    CU_ASSERT_TRUE(in_order);
+
+    pthread_join(producer, NULL);
+    CU_ASSERT_EQUAL(ioopm_spsc_ring_size(ring), 0);
+
+    ioopm_spsc_ring_destroy(ring);
+}
+
+void test_steal_single_thread()
+{
+    ioopm_steal_deque_t *deque = ioopm_steal_deque_create(3);
+    elem_t value;
+
+    CU_ASSERT_FALSE(ioopm_steal_deque_pop(deque, &value));
+    CU_ASSERT_FALSE(ioopm_steal_deque_steal(deque, &value));
+
+    // the capacity is rounded up to 4
+    for (int i = 0; i < 4; i++)
+    {
+        CU_ASSERT_TRUE(ioopm_steal_deque_push(deque, int_elem(i)));
+    }
+    CU_ASSERT_FALSE(ioopm_steal_deque_push(deque, int_elem(4)));
+
+    // the owner takes the newest element and a thief the oldest
+    CU_ASSERT_TRUE(ioopm_steal_deque_pop(deque, &value));
+    CU_ASSERT_EQUAL(value.integer, 3);
+    CU_ASSERT_TRUE(ioopm_steal_deque_push(deque, int_elem(3)));
+    CU_ASSERT_TRUE(ioopm_steal_deque_steal(deque, &value));
+    CU_ASSERT_EQUAL(value.integer, 0);
+
+    // wrap around
+    for (int i = 4; i < 20; i++)
+    {
+        CU_ASSERT_TRUE(ioopm_steal_deque_push(deque, int_elem(i)));
+        CU_ASSERT_TRUE(ioopm_steal_deque_steal(deque, &value));
+        CU_ASSERT_EQUAL(value.integer, i - 3);
+    }
+    for (int i = 19; i >= 17; i--)
+    {
+        CU_ASSERT_TRUE(ioopm_steal_deque_pop(deque, &value));
+        CU_ASSERT_EQUAL(value.integer, i);
+    }
+    CU_ASSERT_FALSE(ioopm_steal_deque_pop(deque, &value));
+    CU_ASSERT_FALSE(ioopm_steal_deque_steal(deque, &value));
+
+    ioopm_steal_deque_destroy(deque);
+}
+
+void test_steal_threads()
+{
+    ioopm_steal_deque_t *deque = ioopm_steal_deque_create(256);
+    pthread_t threads[Thieves];
+    thief_t thieves[Thieves];
+    char *owner_taken = calloc(Deque_Elements, 1);
+    bool done = false;
+    elem_t value;
+
+    for (int i = 0; i < Thieves; i++)
+    {
+        thieves[i] = (thief_t){.deque = deque, .done = &done, .taken = calloc(Deque_Elements, 1)};
+        pthread_create(&threads[i], NULL, steal_all, &thieves[i]);
+    }
+
+    // the owner pops every third element it pushes and when the deque is full, so it
+    // races the thieves for the last elements
+    for (int i = 0; i < Deque_Elements; i++)
+    {
+        while (!ioopm_steal_deque_push(deque, int_elem(i)))
+        {
+            if (ioopm_steal_deque_pop(deque, &value))
+            {
+                owner_taken[value.integer]++;
+            }
+        }
+        if (i % 3 == 0 && ioopm_steal_deque_pop(deque, &value))
+        {
+            owner_taken[value.integer]++;
+        }
+    }
+    while (ioopm_steal_deque_pop(deque, &value))
+    {
+        owner_taken[value.integer]++;
+    }
+    __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+
+    for (int i = 0; i < Thieves; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    // every element was taken exactly once
+    bool once = true;
+    for (int e = 0; e < Deque_Elements; e++)
+    {
+        int taken = owner_taken[e];
+        for (int i = 0; i < Thieves; i++)
+        {
+            taken += thieves[i].taken[e];
+        }
+        once = once && taken == 1;
+    }
+    CU_ASSERT_TRUE(once);
+
+    for (int i = 0; i < Thieves; i++)
+    {
+        free(thieves[i].taken);
+    }
+    free(owner_taken);
+    ioopm_steal_deque_destroy(deque);
+}
+
+int main()
+{
+    // First we try to set up CUnit, and exit if we fail
+    if (CU_initialize_registry() != CUE_SUCCESS)
+        return CU_get_error();
+
+    // We then create an empty test suite and specify the name and
+    // the init and cleanup functions
+    CU_pSuite my_test_suite = CU_add_suite("Tests for queue.c", init_suite, clean_suite);
+    if (my_test_suite == NULL)
+    {
+        // If the test suite could not be added, tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // This is where we add the test functions to our test suite.
+    // For each call to CU_add_test we specify the test suite, the
+    // name or description of the test, and the function that runs
+    // the test in question. If you want to add another test, just
+    // copy a line below and change the information
+    if (
+        (CU_add_test(my_test_suite, "Push and pop on one thread", test_mpsc_single_thread) == NULL ||
+         CU_add_test(my_test_suite, "Several producers and one consumer", test_mpsc_producers) == NULL ||
+         CU_add_test(my_test_suite, "Ring push and pop on one thread", test_spsc_single_thread) == NULL ||
+         CU_add_test(my_test_suite, "Ring between a producer and a consumer", test_spsc_threads) == NULL ||
+         CU_add_test(my_test_suite, "Deque push, pop and steal on one thread", test_steal_single_thread) == NULL ||
+         CU_add_test(my_test_suite, "Deque owner and thieves take every element once", test_steal_threads) == NULL))
+    {
+        // If adding any of the tests fails, we tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Set the running mode. Use CU_BRM_VERBOSE for maximum output.
+    // Use CU_BRM_NORMAL to only print errors and a summary
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+
+    // This is where the tests are actually run!
+    CU_basic_run_tests();
+
+    // Tear down CUnit before exiting
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,566 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "radix_tree.h"
+
+#define Max_Prefix 12
+
+enum node_kind
+{
+    NODE_4,
+    NODE_16,
+    NODE_48,
+    NODE_256,
+};
+
+typedef struct leaf leaf_t;
+typedef struct node node_t;
+typedef struct node4 node4_t;
+typedef struct node16 node16_t;
+typedef struct node48 node48_t;
+typedef struct node256 node256_t;
+
+// The children of a node are nodes, or leaves with the lowest bit of the pointer set
+
+struct leaf
+{
+    uint32_t count;
+    uint32_t length;
+    char word[];            // the whole word, ending with '\0'
+};
+
+struct node
+{
+    uint8_t kind;
+    uint16_t children;
+    uint32_t prefix_length;             // the bytes that every word below shares before this node branches
+    unsigned char prefix[Max_Prefix];   // the first of those bytes, the rest are read from a word below
+    leaf_t *leaf;                       // the word that ends at this node, or NULL
+};
+
+// Up to 4 and 16 children with their bytes in order
+struct node4
+{
+    node_t node;
+    unsigned char keys[4];
+    void *child[4];
+};
+
+struct node16
+{
+    node_t node;
+    unsigned char keys[16];
+    void *child[16];
+};
+
+// Up to 48 children in the order they were added, found by byte through index
+struct node48
+{
+    node_t node;
+    unsigned char index[256];   // the position + 1 of the child of each byte, or 0
+    void *child[48];
+};
+
+struct node256
+{
+    node_t node;
+    void *child[256];
+};
+
+struct radix_tree
+{
+    void *root;
+    size_t size;
+};
+
+static inline bool is_leaf(void *child)
+{
+    return (uintptr_t) child & 1;
+}
+
+static inline leaf_t *as_leaf(void *child)
+{
+    return (leaf_t *) ((uintptr_t) child & ~(uintptr_t) 1);
+}
+
+static inline void *leaf_child(leaf_t *leaf)
+{
+    return (void *) ((uintptr_t) leaf | 1);
+}
+
+static leaf_t *leaf_create(const char *word, size_t length, uint32_t count)
+{
+    leaf_t *leaf = malloc(sizeof(leaf_t) + length + 1);
+
+    leaf->count = count;
+    leaf->length = length;
+    memcpy(leaf->word, word, length);
+    leaf->word[length] = '\0';
+    return leaf;
+}
+
+// Adds to a count, stopping at the highest count instead of wrapping
+static inline void leaf_add(leaf_t *leaf, uint32_t count)
+{
+    leaf->count = leaf->count > UINT32_MAX - count ? UINT32_MAX : leaf->count + count;
+}
+
+static node_t *node_create(enum node_kind kind)
+{
+    static const size_t sizes[] = {sizeof(node4_t), sizeof(node16_t), sizeof(node48_t), sizeof(node256_t)};
+    node_t *node = calloc(1, sizes[kind]);
+
+    node->kind = kind;
+    return node;
+}
+
+static void set_prefix(node_t *node, const unsigned char *bytes, size_t length)
+{
+    node->prefix_length = length;
+    memmove(node->prefix, bytes, length < Max_Prefix ? length : Max_Prefix);
+}
+
+ioopm_radix_tree_t *ioopm_radix_tree_create(void)
+{
+    return calloc(1, sizeof(ioopm_radix_tree_t));
+}
+
+static void destroy_below(void *child)
+{
+    if (child == NULL || is_leaf(child))
+    {
+        free(as_leaf(child));
+        return;
+    }
+
+    node_t *node = child;
+    switch (node->kind)
+    {
+    case NODE_4:
+        for (size_t i = 0; i < node->children; i++)
+        {
+            destroy_below(((node4_t *) node)->child[i]);
+        }
+        break;
+    case NODE_16:
+        for (size_t i = 0; i < node->children; i++)
+        {
+            destroy_below(((node16_t *) node)->child[i]);
+        }
+        break;
+    case NODE_48:
+        for (size_t i = 0; i < node->children; i++)
+        {
+            destroy_below(((node48_t *) node)->child[i]);
+        }
+        break;
+    case NODE_256:
+        for (size_t i = 0; i < 256; i++)
+        {
+            destroy_below(((node256_t *) node)->child[i]);
+        }
+        break;
+    }
+    free(node->leaf);
+    free(node);
+}
+
+void ioopm_radix_tree_destroy(ioopm_radix_tree_t *tree)
+{
+    destroy_below(tree->root);
+    free(tree);
+}
+
+// Returns where the child of a byte is kept, or NULL if there is none
+static void **find_child(node_t *node, unsigned char byte)
+{
+    switch (node->kind)
+    {
+    case NODE_4:
+    {
+        node4_t *n = (node4_t *) node;
+        for (size_t i = 0; i < node->children; i++)
+        {
+            if (n->keys[i] == byte)
+            {
+                return &n->child[i];
+            }
+        }
+        return NULL;
+    }
+    case NODE_16:
+    {
+        node16_t *n = (node16_t *) node;
+#ifdef __SSE2__
+        __m128i equal = _mm_cmpeq_epi8(_mm_set1_epi8(byte), _mm_loadu_si128((__m128i *) n->keys));
+        int found = _mm_movemask_epi8(equal) & ((1 << node->children) - 1);
+
+        return found != 0 ? &n->child[__builtin_ctz(found)] : NULL;
+#else
+        for (size_t i = 0; i < node->children; i++)
+        {
+            if (n->keys[i] == byte)
+            {
+                return &n->child[i];
+            }
+        }
+        return NULL;
+#endif
+    }
+    case NODE_48:
+    {
+        node48_t *n = (node48_t *) node;
+        return n->index[byte] != 0 ? &n->child[n->index[byte] - 1] : NULL;
+    }
+    default:
+    {
+        node256_t *n = (node256_t *) node;
+        return n->child[byte] != NULL ? &n->child[byte] : NULL;
+    }
+    }
+}
+
+// Puts a child among count children with their bytes in order
+static void insert_ordered(unsigned char *keys, void **children, size_t count, unsigned char byte, void *child)
+{
+    size_t i = 0;
+
+    while (i < count && keys[i] < byte)
+    {
+        i++;
+    }
+    memmove(keys + i + 1, keys + i, count - i);
+    memmove(children + i + 1, children + i, (count - i) * sizeof(void *));
+    keys[i] = byte;
+    children[i] = child;
+}
+
+// Moves the header of a node into a bigger node, keeping the kind of the bigger one
+static node_t *node_grow(node_t *node, enum node_kind kind)
+{
+    node_t *bigger = node_create(kind);
+
+    *bigger = *node;
+    bigger->kind = kind;
+    return bigger;
+}
+
+// Adds a child for a byte that has none to the node in ref, which is replaced by a
+// bigger node if it is full
+static void add_child(void **ref, unsigned char byte, void *child)
+{
+    node_t *node = *ref;
+
+    switch (node->kind)
+    {
+    case NODE_4:
+    {
+        node4_t *n = (node4_t *) node;
+        if (node->children < 4)
+        {
+            insert_ordered(n->keys, n->child, node->children++, byte, child);
+            return;
+        }
+
+        node16_t *bigger = (node16_t *) node_grow(node, NODE_16);
+        memcpy(bigger->keys, n->keys, 4);
+        memcpy(bigger->child, n->child, 4 * sizeof(void *));
+        *ref = bigger;
+        break;
+    }
+    case NODE_16:
+    {
+        node16_t *n = (node16_t *) node;
+        if (node->children < 16)
+        {
+            insert_ordered(n->keys, n->child, node->children++, byte, child);
+            return;
+        }
+
+        node48_t *bigger = (node48_t *) node_grow(node, NODE_48);
+        for (size_t i = 0; i < 16; i++)
+        {
+            bigger->index[n->keys[i]] = i + 1;
+            bigger->child[i] = n->child[i];
+        }
+        *ref = bigger;
+        break;
+    }
+    case NODE_48:
+    {
+        node48_t *n = (node48_t *) node;
+        if (node->children < 48)
+        {
+            n->child[node->children++] = child;
+            n->index[byte] = node->children;
+            return;
+        }
+
+        node256_t *bigger = (node256_t *) node_grow(node, NODE_256);
+        for (size_t i = 0; i < 256; i++)
+        {
+            if (n->index[i] != 0)
+            {
+                bigger->child[i] = n->child[n->index[i] - 1];
+            }
+        }
+        *ref = bigger;
+        break;
+    }
+    default:
+        ((node256_t *) node)->child[byte] = child;
+        node->children++;
+        return;
+    }
+
+    free(node);
+    add_child(ref, byte, child);
+}
+
+// Any word below a node, which all share the prefix of the node
+static leaf_t *any_leaf(node_t *node)
+{
+    while (node->leaf == NULL)
+    {
+        void *child = NULL;
+
+        // the first children of all but the biggest nodes are taken
+        if (node->kind == NODE_256)
+        {
+            for (size_t i = 0; child == NULL; i++)
+            {
+                child = ((node256_t *) node)->child[i];
+            }
+        }
+        else
+        {
+            child = node->kind == NODE_4 ? ((node4_t *) node)->child[0] : node->kind == NODE_16 ? ((node16_t *) node)->child[0] : ((node48_t *) node)->child[0];
+        }
+
+        if (is_leaf(child))
+        {
+            return as_leaf(child);
+        }
+        node = child;
+    }
+    return node->leaf;
+}
+
+// The number of bytes of the prefix of a node that a word matches from depth on
+static size_t prefix_match(node_t *node, const char *word, size_t length, size_t depth)
+{
+    size_t max = node->prefix_length < length - depth ? node->prefix_length : length - depth;
+    size_t i = 0;
+
+    while (i < max && i < Max_Prefix && node->prefix[i] == (unsigned char) word[depth + i])
+    {
+        i++;
+    }
+    if (i < Max_Prefix || i == max)
+    {
+        return i;
+    }
+
+    leaf_t *below = any_leaf(node);
+    while (i < max && below->word[depth + i] == word[depth + i])
+    {
+        i++;
+    }
+    return i;
+}
+
+// Puts a leaf into a new node whose words branch at depth
+static void add_below(void **ref, leaf_t *leaf, size_t depth)
+{
+    if (leaf->length == depth)
+    {
+        ((node_t *) *ref)->leaf = leaf;
+    }
+    else
+    {
+        add_child(ref, leaf->word[depth], leaf_child(leaf));
+    }
+}
+
+// Replaces a leaf that a new word reached at depth with a node branching where the two
+// words differ
+static node_t *split_leaf(leaf_t *leaf, leaf_t *added, size_t depth)
+{
+    void *node = node_create(NODE_4);
+    size_t common = 0;
+
+    while (depth + common < leaf->length && depth + common < added->length && leaf->word[depth + common] == added->word[depth + common])
+    {
+        common++;
+    }
+    set_prefix(node, (unsigned char *) added->word + depth, common);
+    add_below(&node, leaf, depth + common);
+    add_below(&node, added, depth + common);
+    return node;
+}
+
+// Puts a new node above a node whose prefix a new word leaves after matched bytes
+static node_t *split_prefix(node_t *node, size_t matched, leaf_t *added, size_t depth)
+{
+    void *parent = node_create(NODE_4);
+    // the prefix of the node is all in the node, or all in any word below it
+    const unsigned char *prefix = node->prefix_length <= Max_Prefix ? node->prefix : (unsigned char *) any_leaf(node)->word + depth;
+    unsigned char byte = prefix[matched];
+
+    set_prefix(parent, prefix, matched);
+    set_prefix(node, prefix + matched + 1, node->prefix_length - matched - 1);
+    add_child(&parent, byte, node);
+    add_below(&parent, added, depth + matched);
+    return parent;
+}
+
+void ioopm_radix_tree_add(ioopm_radix_tree_t *tree, const char *word, size_t length, uint32_t count)
+{
+    void **ref = &tree->root;
+    size_t depth = 0;
+
+    while (true)
+    {
+        if (*ref == NULL)
+        {
+            *ref = leaf_child(leaf_create(word, length, count));
+            tree->size++;
+            return;
+        }
+
+        if (is_leaf(*ref))
+        {
+            // the bytes before depth are the same in every word below ref
+            leaf_t *leaf = as_leaf(*ref);
+            if (leaf->length == length && memcmp(leaf->word + depth, word + depth, length - depth) == 0)
+            {
+                leaf_add(leaf, count);
+                return;
+            }
+
+            *ref = split_leaf(leaf, leaf_create(word, length, count), depth);
+            tree->size++;
+            return;
+        }
+
+        node_t *node = *ref;
+        if (node->prefix_length > 0)
+        {
+            size_t matched = prefix_match(node, word, length, depth);
+            if (matched < node->prefix_length)
+            {
+                *ref = split_prefix(node, matched, leaf_create(word, length, count), depth);
+                tree->size++;
+                return;
+            }
+            depth += node->prefix_length;
+        }
+
+        if (depth == length)
+        {
+            if (node->leaf != NULL)
+            {
+                leaf_add(node->leaf, count);
+            }
+            else
+            {
+                node->leaf = leaf_create(word, length, count);
+                tree->size++;
+            }
+            return;
+        }
+
+        void **next = find_child(node, word[depth]);
+        if (next == NULL)
+        {
+            add_child(ref, word[depth], leaf_child(leaf_create(word, length, count)));
+            tree->size++;
+            return;
+        }
+        ref = next;
+        depth++;
+    }
+}
+
+size_t ioopm_radix_tree_size(ioopm_radix_tree_t *tree)
+{
+    return tree->size;
+}
+
+static void collect_leaf(leaf_t *leaf, ioopm_string_entry_t **next)
+{
+    **next = (ioopm_string_entry_t) {.string = leaf->word, .value.unsigned_integer = leaf->count};
+    (*next)++;
+}
+
+// Adds the words below a child in order: a word ending at a node comes before the words
+// that go on, and children in the order of their bytes
+static void collect_below(void *child, ioopm_string_entry_t **next)
+{
+    if (is_leaf(child))
+    {
+        collect_leaf(as_leaf(child), next);
+        return;
+    }
+
+    node_t *node = child;
+    if (node->leaf != NULL)
+    {
+        collect_leaf(node->leaf, next);
+    }
+
+    switch (node->kind)
+    {
+    case NODE_4:
+        for (size_t i = 0; i < node->children; i++)
+        {
+            collect_below(((node4_t *) node)->child[i], next);
+        }
+        break;
+    case NODE_16:
+        for (size_t i = 0; i < node->children; i++)
+        {
+            collect_below(((node16_t *) node)->child[i], next);
+        }
+        break;
+    case NODE_48:
+    {
+        node48_t *n = (node48_t *) node;
+        for (size_t i = 0; i < 256; i++)
+        {
+            if (n->index[i] != 0)
+            {
+                collect_below(n->child[n->index[i] - 1], next);
+            }
+        }
+        break;
+    }
+    case NODE_256:
+        for (size_t i = 0; i < 256; i++)
+        {
+            if (((node256_t *) node)->child[i] != NULL)
+            {
+                collect_below(((node256_t *) node)->child[i], next);
+            }
+        }
+        break;
+    }
+}
+
+ioopm_string_entry_t *ioopm_radix_tree_entries(ioopm_radix_tree_t *tree, size_t *count)
+{
+    ioopm_string_entry_t *entries = calloc(tree->size + 1, sizeof(ioopm_string_entry_t));
+    ioopm_string_entry_t *next = entries;
+
+    if (tree->root != NULL)
+    {
+        collect_below(tree->root, &next);
+    }
+
+    *count = tree->size;
+    return entries;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "string_sort.h"
+
+/**
+ * @file radix_tree.h
+ * @author Tuva Björnberg & Gustav Fridén
+ * @date 29/09-2023
+ * @brief Word counts in an adaptive radix tree (`radix_tree_t`), which keeps the words in
+ * the order of strcmp so that they can be listed without sorting.
+ *
+ * Every inner node branches on one byte of the words below it and holds the bytes that
+ * all of those words share before it, so a prefix shared by many words is stored once.
+ * Nodes come in four sizes, for up to 4, 16, 48 and 256 children, and grow into the
+ * next size when they are full. A word that ends at a node is kept in the node itself,
+ * and a word that is the only one below a byte is kept as a leaf holding the whole word
+ * and its count, without a chain of nodes for its last bytes.
+ */
+
+typedef struct radix_tree ioopm_radix_tree_t;
+
+/// @brief Creates an empty tree
+/// @return the new tree
+ioopm_radix_tree_t *ioopm_radix_tree_create(void);
+
+/// @brief Return the memory of a tree, including its copies of words
+/// @param tree the tree to be destroyed
+void ioopm_radix_tree_destroy(ioopm_radix_tree_t *tree);
+
+/// @brief Add to the count of a word, copying it the first time it is seen
+/// @param tree the tree
+/// @param word the word, which need not end with '\0' and may not hold '\0'
+/// @param length the number of bytes in word
+/// @param count the number of times the word was seen
+void ioopm_radix_tree_add(ioopm_radix_tree_t *tree, const char *word, size_t length, uint32_t count);
+
+/// @brief The number of different words in a tree
+/// @param tree the tree
+/// @return the number of words
+size_t ioopm_radix_tree_size(ioopm_radix_tree_t *tree);
+
+/// @brief The words of a tree with their counts, in the order of strcmp
+/// @param tree the tree
+/// @param count set to the number of words
+/// @return a heap allocated array of words and counts in .unsigned_integer, valid until the tree
+/// is changed. The array is freed by the caller, the words by the tree.
+ioopm_string_entry_t *ioopm_radix_tree_entries(ioopm_radix_tree_t *tree, size_t *count);
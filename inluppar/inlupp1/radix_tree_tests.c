@@ -0,0 +1,228 @@
+#include <CUnit/Basic.h>
+#include "radix_tree.h"
+#include "string_sort.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Random_Words 20000
+
+int init_suite(void)
+{
+    return 0;
+}
+
+int clean_suite(void)
+{
+    return 0;
+}
+
+static void add_word(ioopm_radix_tree_t *tree, char *word)
+{
+    ioopm_radix_tree_add(tree, word, strlen(word), 1);
+}
+
+static int compare_strings(const void *a, const void *b)
+{
+    return strcmp(*(char **) a, *(char **) b);
+}
+
+// Checks that the entries of a tree are the different words of an array in order, each
+// counted as many times as it occurs
+static void check_entries(ioopm_radix_tree_t *tree, char **words, size_t word_count)
+{
+    size_t count;
+    ioopm_string_entry_t *entries = ioopm_radix_tree_entries(tree, &count);
+    size_t entry = 0;
+
+    qsort(words, word_count, sizeof(char *), compare_strings);
+    for (size_t i = 0; i < word_count; entry++)
+    {
+        size_t same = 1;
+        while (i + same < word_count && strcmp(words[i], words[i + same]) == 0)
+        {
+            same++;
+        }
+
+        if (entry >= count)
+        {
+            CU_FAIL("too few entries");
+            break;
+        }
+        CU_ASSERT_STRING_EQUAL(entries[entry].string, words[i]);
+        CU_ASSERT_EQUAL(entries[entry].value.unsigned_integer, same);
+        i += same;
+    }
+    CU_ASSERT_EQUAL(entry, count);
+    CU_ASSERT_EQUAL(ioopm_radix_tree_size(tree), count);
+    free(entries);
+}
+
+void test_empty_tree()
+{
+    ioopm_radix_tree_t *tree = ioopm_radix_tree_create();
+    size_t count = 1;
+
+    ioopm_string_entry_t *entries = ioopm_radix_tree_entries(tree, &count);
+    CU_ASSERT_EQUAL(count, 0);
+    CU_ASSERT_EQUAL(ioopm_radix_tree_size(tree), 0);
+    free(entries);
+    ioopm_radix_tree_destroy(tree);
+}
+
+void test_prefixes()
+{
+    ioopm_radix_tree_t *tree = ioopm_radix_tree_create();
+    // words that end where others go on, in and past a shared prefix, and a shared
+    // prefix longer than the part kept in a node
+    char *words[] = {"there", "the", "then", "t", "the", "theory", "a", "", "internationalisation",
+                     "internationalist", "internationalisations", "international", "intern", "internationalisation"};
+    size_t word_count = sizeof(words) / sizeof(words[0]);
+
+    for (size_t i = 0; i < word_count; i++)
+    {
+        add_word(tree, words[i]);
+    }
+    ioopm_radix_tree_add(tree, "then", 4, 10);
+    // only the first length bytes are the word
+    ioopm_radix_tree_add(tree, "theorem", 5, 1);
+
+    size_t count;
+    ioopm_string_entry_t *entries = ioopm_radix_tree_entries(tree, &count);
+    char *expected[] = {"", "a", "intern", "international", "internationalisation", "internationalisations",
+                        "internationalist", "t", "the", "then", "theor", "theory", "there"};
+    unsigned expected_counts[] = {1, 1, 1, 1, 2, 1, 1, 1, 2, 11, 1, 1, 1};
+
+    CU_ASSERT_EQUAL(count, 13);
+    for (size_t i = 0; i < count && i < 13; i++)
+    {
+        CU_ASSERT_STRING_EQUAL(entries[i].string, expected[i]);
+        CU_ASSERT_EQUAL(entries[i].value.unsigned_integer, expected_counts[i]);
+    }
+    free(entries);
+    ioopm_radix_tree_destroy(tree);
+}
+
+void test_wide_nodes()
+{
+    ioopm_radix_tree_t *tree = ioopm_radix_tree_create();
+    char *words[2 * 255];
+    size_t word_count = 0;
+
+    // every byte but '\0' after a shared prefix, added out of order, so the node below
+    // the prefix grows through every size
+    for (int i = 1; i < 256; i++)
+    {
+        char *word = calloc(4, 1);
+        word[0] = 'x';
+        word[1] = 'y';
+        word[2] = (i * 97) % 255 + 1;
+        words[word_count++] = word;
+        add_word(tree, word);
+    }
+    for (int i = 1; i < 256; i += 2)
+    {
+        words[word_count++] = words[i];
+        add_word(tree, words[i]);
+    }
+
+    char **sorted = calloc(word_count, sizeof(char *));
+    memcpy(sorted, words, word_count * sizeof(char *));
+    check_entries(tree, sorted, word_count);
+    free(sorted);
+
+    for (int i = 0; i < 255; i++)
+    {
+        free(words[i]);
+    }
+    ioopm_radix_tree_destroy(tree);
+}
+
+void test_random_words()
+{
+    ioopm_radix_tree_t *tree = ioopm_radix_tree_create();
+    char **words = calloc(Random_Words, sizeof(char *));
+    uint64_t state = 88172645463325252ull;
+
+    // short words over a small alphabet share many prefixes and repeat, and some long
+    // words share prefixes longer than a node keeps
+    for (size_t i = 0; i < Random_Words; i++)
+    {
+        char word[64];
+        size_t length;
+
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        if (i % 10 == 0)
+        {
+            length = sprintf(word, "pneumonoultramicroscopicsilicovolcanoconiosis%llu", (unsigned long long) (state % 50));
+        }
+        else
+        {
+            length = 1 + state % 6;
+            for (size_t j = 0; j < length; j++)
+            {
+                word[j] = "abcde\xc3\xa5"[(state >> (8 + 3 * j)) % 7];
+            }
+            word[length] = '\0';
+        }
+        words[i] = strdup(word);
+        add_word(tree, word);
+    }
+
+    check_entries(tree, words, Random_Words);
+
+    for (size_t i = 0; i < Random_Words; i++)
+    {
+        free(words[i]);
+    }
+    free(words);
+    ioopm_radix_tree_destroy(tree);
+}
+
+int main()
+{
+    // First we try to set up CUnit, and exit if we fail
+    if (CU_initialize_registry() != CUE_SUCCESS)
+        return CU_get_error();
+
+    // We then create an empty test suite and specify the name and
+    // the init and cleanup functions
+    CU_pSuite my_test_suite = CU_add_suite("Tests for radix_tree.c", init_suite, clean_suite);
+    if (my_test_suite == NULL)
+    {
+        // If the test suite could not be added, tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // This is where we add the test functions to our test suite.
+    // For each call to CU_add_test we specify the test suite, the
+    // name or description of the test, and the function that runs
+    // the test in question. If you want to add another test, just
+    // copy a line below and change the information
+    if (
+        (CU_add_test(my_test_suite, "An empty tree has no words", test_empty_tree) == NULL ||
+         CU_add_test(my_test_suite, "Words that are prefixes of each other", test_prefixes) == NULL ||
+         CU_add_test(my_test_suite, "Nodes grow through every size", test_wide_nodes) == NULL ||
+         CU_add_test(my_test_suite, "Random words are listed in order", test_random_words) == NULL))
+    {
+        // If adding any of the tests fails, we tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Set the running mode. Use CU_BRM_VERBOSE for maximum output.
+    // Use CU_BRM_NORMAL to only print errors and a summary
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+
+    // This is where the tests are actually run!
+    CU_basic_run_tests();
+
+    // Tear down CUnit before exiting
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,407 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "sketch.h"
+
+#define Min_Precision 4
+#define Max_Precision 18
+// the most counters in a row of a count-min sketch, for an epsilon of about 1e-7
+#define Max_Width (1 << 25)
+
+typedef struct hitter hitter_t;
+
+struct count_min
+{
+    uint32_t *counters;     // depth rows of width counters
+    size_t width;           // a power of 2
+    size_t depth;
+    uint64_t total;
+};
+
+struct hitter
+{
+    char *word;
+    size_t length;
+    uint64_t hash;
+    uint32_t count;
+    size_t slot;            // the index of this hitter in slots
+};
+
+struct heavy_hitters
+{
+    hitter_t *heap;         // a min-heap on count, the lowest counted word at the root
+    size_t size;
+    size_t capacity;
+    size_t *slots;          // finds a word by hash: the heap index + 1 of a hitter, or 0
+    size_t slot_mask;       // one less than the number of slots, a power of 2
+};
+
+struct hyperloglog
+{
+    uint8_t *registers;     // the longest run of zeros seen + 1 for each part of the hashes
+    unsigned precision;     // 2^precision registers
+};
+
+uint64_t ioopm_sketch_hash(const char *word, size_t length)
+{
+    // FNV-1a, with the bits mixed afterwards since the summaries use both ends of the hash
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ (unsigned char) word[i]) * 0x100000001b3ull;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// The smallest power of 2 at least value, but at most max so that a huge value cannot
+// overflow
+static size_t power_of_two_above(double value, size_t max)
+{
+    size_t power = 1;
+
+    while (power < value && power < max)
+    {
+        power *= 2;
+    }
+    return power;
+}
+
+ioopm_count_min_t *ioopm_count_min_create(double epsilon, double delta)
+{
+    ioopm_count_min_t *sketch = calloc(1, sizeof(ioopm_count_min_t));
+
+    sketch->width = power_of_two_above(exp(1) / epsilon, Max_Width);
+    sketch->depth = ceil(log(1 / delta));
+    if (sketch->depth < 1)
+    {
+        sketch->depth = 1;
+    }
+    sketch->counters = calloc(sketch->width * sketch->depth, sizeof(uint32_t));
+    if (sketch->counters == NULL)
+    {
+        free(sketch);
+        return NULL;
+    }
+
+    return sketch;
+}
+
+void ioopm_count_min_destroy(ioopm_count_min_t *sketch)
+{
+    free(sketch->counters);
+    free(sketch);
+}
+
+// The counter of a word in a row. The rows use hashes h1 + row * h2 made from the two
+// halves of the hash.
+static inline uint32_t *counter_of(ioopm_count_min_t *sketch, uint64_t hash, size_t row)
+{
+    uint64_t h1 = hash & 0xffffffffu;
+    uint64_t h2 = (hash >> 32) | 1;
+
+    return &sketch->counters[row * sketch->width + ((h1 + row * h2) & (sketch->width - 1))];
+}
+
+uint32_t ioopm_count_min_estimate(ioopm_count_min_t *sketch, uint64_t hash)
+{
+    uint32_t estimate = UINT32_MAX;
+
+    for (size_t row = 0; row < sketch->depth; row++)
+    {
+        uint32_t counter = *counter_of(sketch, hash, row);
+        estimate = counter < estimate ? counter : estimate;
+    }
+    return estimate;
+}
+
+uint32_t ioopm_count_min_add(ioopm_count_min_t *sketch, uint64_t hash, uint32_t count)
+{
+    uint32_t estimate = ioopm_count_min_estimate(sketch, hash);
+    // counters stop at the largest value instead of wrapping around
+    uint32_t updated = estimate > UINT32_MAX - count ? UINT32_MAX : estimate + count;
+
+    // conservative update: no counter is raised above what the word can have reached
+    for (size_t row = 0; row < sketch->depth; row++)
+    {
+        uint32_t *counter = counter_of(sketch, hash, row);
+
+        if (*counter < updated)
+        {
+            *counter = updated;
+        }
+    }
+
+    sketch->total += count;
+    return updated;
+}
+
+uint64_t ioopm_count_min_total(ioopm_count_min_t *sketch)
+{
+    return sketch->total;
+}
+
+void ioopm_count_min_error(ioopm_count_min_t *sketch, double *epsilon, double *delta)
+{
+    *epsilon = exp(1) / sketch->width;
+    *delta = exp(-(double) sketch->depth);
+}
+
+size_t ioopm_count_min_bytes(ioopm_count_min_t *sketch)
+{
+    return sketch->width * sketch->depth * sizeof(uint32_t);
+}
+
+ioopm_heavy_hitters_t *ioopm_heavy_hitters_create(size_t capacity)
+{
+    ioopm_heavy_hitters_t *hitters = calloc(1, sizeof(ioopm_heavy_hitters_t));
+
+    hitters->capacity = capacity > 0 ? capacity : 1;
+    // at least half the slots stay empty, so a search always ends
+    size_t slot_count = power_of_two_above(2.0 * hitters->capacity, SIZE_MAX / 2 + 1);
+    hitters->heap = calloc(hitters->capacity, sizeof(hitter_t));
+    hitters->slots = calloc(slot_count, sizeof(size_t));
+    hitters->slot_mask = slot_count - 1;
+
+    return hitters;
+}
+
+void ioopm_heavy_hitters_destroy(ioopm_heavy_hitters_t *hitters)
+{
+    for (size_t i = 0; i < hitters->size; i++)
+    {
+        free(hitters->heap[i].word);
+    }
+    free(hitters->slots);
+    free(hitters->heap);
+    free(hitters);
+}
+
+// Returns the slot of a word, or the empty slot where it belongs if it is missing
+static size_t slot_find(ioopm_heavy_hitters_t *hitters, const char *word, size_t length, uint64_t hash)
+{
+    size_t slot = hash & hitters->slot_mask;
+
+    while (hitters->slots[slot] != 0)
+    {
+        hitter_t *hitter = &hitters->heap[hitters->slots[slot] - 1];
+
+        if (hitter->hash == hash && hitter->length == length && memcmp(hitter->word, word, length) == 0)
+        {
+            return slot;
+        }
+        slot = (slot + 1) & hitters->slot_mask;
+    }
+    return slot;
+}
+
+// Empties a slot, moving later slots of the same run back so that every word can still
+// be found from its first slot
+static void slot_remove(ioopm_heavy_hitters_t *hitters, size_t slot)
+{
+    size_t mask = hitters->slot_mask;
+    size_t next = slot;
+
+    hitters->slots[slot] = 0;
+    while (true)
+    {
+        next = (next + 1) & mask;
+        if (hitters->slots[next] == 0)
+        {
+            return;
+        }
+
+        hitter_t *hitter = &hitters->heap[hitters->slots[next] - 1];
+        size_t home = hitter->hash & mask;
+
+        // the word may move back unless its first slot lies between the hole and next
+        if (((next - home) & mask) >= ((next - slot) & mask))
+        {
+            hitters->slots[slot] = hitters->slots[next];
+            hitters->slots[next] = 0;
+            hitter->slot = slot;
+            slot = next;
+        }
+    }
+}
+
+static void hitter_swap(ioopm_heavy_hitters_t *hitters, size_t i, size_t j)
+{
+    hitter_t tmp = hitters->heap[i];
+    hitters->heap[i] = hitters->heap[j];
+    hitters->heap[j] = tmp;
+
+    hitters->slots[hitters->heap[i].slot] = i + 1;
+    hitters->slots[hitters->heap[j].slot] = j + 1;
+}
+
+static void hitter_sift_up(ioopm_heavy_hitters_t *hitters, size_t i)
+{
+    while (i > 0 && hitters->heap[i].count < hitters->heap[(i - 1) / 2].count)
+    {
+        hitter_swap(hitters, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void hitter_sift_down(ioopm_heavy_hitters_t *hitters, size_t i)
+{
+    while (true)
+    {
+        size_t lowest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < hitters->size && hitters->heap[left].count < hitters->heap[lowest].count)
+        {
+            lowest = left;
+        }
+        if (right < hitters->size && hitters->heap[right].count < hitters->heap[lowest].count)
+        {
+            lowest = right;
+        }
+        if (lowest == i)
+        {
+            return;
+        }
+        hitter_swap(hitters, i, lowest);
+        i = lowest;
+    }
+}
+
+void ioopm_heavy_hitters_offer(ioopm_heavy_hitters_t *hitters, const char *word, size_t length, uint64_t hash, uint32_t count)
+{
+    size_t slot = slot_find(hitters, word, length, hash);
+
+    if (hitters->slots[slot] != 0)
+    {
+        size_t index = hitters->slots[slot] - 1;
+        hitters->heap[index].count = count;
+        hitter_sift_down(hitters, index);
+        return;
+    }
+
+    size_t index;
+    if (hitters->size < hitters->capacity)
+    {
+        index = hitters->size++;
+    }
+    else if (count > hitters->heap[0].count)
+    {
+        // drop the lowest counted word to make room
+        index = 0;
+        free(hitters->heap[0].word);
+        slot_remove(hitters, hitters->heap[0].slot);
+        slot = slot_find(hitters, word, length, hash);
+    }
+    else
+    {
+        return;
+    }
+
+    hitters->heap[index] = (hitter_t) {.word = strndup(word, length), .length = length, .hash = hash, .count = count, .slot = slot};
+    hitters->slots[slot] = index + 1;
+
+    if (index == 0)
+    {
+        hitter_sift_down(hitters, index);
+    }
+    else
+    {
+        hitter_sift_up(hitters, index);
+    }
+}
+
+static int entry_rank_cmp(const void *a, const void *b)
+{
+    const ioopm_string_entry_t *first = a;
+    const ioopm_string_entry_t *second = b;
+
+    if (first->value.unsigned_integer != second->value.unsigned_integer)
+    {
+        return first->value.unsigned_integer > second->value.unsigned_integer ? -1 : 1;
+    }
+    return strcmp(first->string, second->string);
+}
+
+ioopm_string_entry_t *ioopm_heavy_hitters_entries(ioopm_heavy_hitters_t *hitters, size_t *count)
+{
+    ioopm_string_entry_t *entries = calloc(hitters->size + 1, sizeof(ioopm_string_entry_t));
+
+    for (size_t i = 0; i < hitters->size; i++)
+    {
+        entries[i].string = hitters->heap[i].word;
+        entries[i].value.unsigned_integer = hitters->heap[i].count;
+    }
+    qsort(entries, hitters->size, sizeof(ioopm_string_entry_t), entry_rank_cmp);
+
+    *count = hitters->size;
+    return entries;
+}
+
+ioopm_hyperloglog_t *ioopm_hyperloglog_create(double error)
+{
+    ioopm_hyperloglog_t *counter = calloc(1, sizeof(ioopm_hyperloglog_t));
+    // the standard error is 1.04 / sqrt(2^precision)
+    unsigned precision = ceil(log2(pow(1.04 / error, 2)));
+
+    counter->precision = precision < Min_Precision ? Min_Precision : precision > Max_Precision ? Max_Precision : precision;
+    counter->registers = calloc((size_t) 1 << counter->precision, 1);
+
+    return counter;
+}
+
+void ioopm_hyperloglog_destroy(ioopm_hyperloglog_t *counter)
+{
+    free(counter->registers);
+    free(counter);
+}
+
+void ioopm_hyperloglog_add(ioopm_hyperloglog_t *counter, uint64_t hash)
+{
+    size_t index = hash >> (64 - counter->precision);
+    // a bit below the remaining ones bounds the run of zeros
+    uint64_t rest = (hash << counter->precision) | ((uint64_t) 1 << (counter->precision - 1));
+    uint8_t rank = __builtin_clzll(rest) + 1;
+
+    if (counter->registers[index] < rank)
+    {
+        counter->registers[index] = rank;
+    }
+}
+
+double ioopm_hyperloglog_estimate(ioopm_hyperloglog_t *counter)
+{
+    size_t registers = (size_t) 1 << counter->precision;
+    double sum = 0;
+    size_t zeros = 0;
+
+    for (size_t i = 0; i < registers; i++)
+    {
+        sum += ldexp(1, -counter->registers[i]);
+        zeros += counter->registers[i] == 0;
+    }
+
+    double alpha = registers == 16 ? 0.673 : registers == 32 ? 0.697 : registers == 64 ? 0.709 : 0.7213 / (1 + 1.079 / registers);
+    double estimate = alpha * registers * registers / sum;
+
+    // few words leave many registers empty, then counting the empty ones is more precise
+    if (estimate <= 2.5 * registers && zeros > 0)
+    {
+        estimate = registers * log((double) registers / zeros);
+    }
+    return estimate;
+}
+
+double ioopm_hyperloglog_error(ioopm_hyperloglog_t *counter)
+{
+    return 1.04 / sqrt((double) ((size_t) 1 << counter->precision));
+}
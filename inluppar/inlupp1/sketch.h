@@ -0,0 +1,123 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "string_sort.h"
+
+/**
+ * @file sketch.h
+ * @author Tuva Björnberg & Gustav Fridén
+ * @date 29/09-2023
+ * @brief Fixed size summaries of a stream of words: approximate counts of each word
+ * (`count_min_t`), the most frequent words (`heavy_hitters_t`) and the number of
+ * different words (`hyperloglog_t`).
+ *
+ * The memory of each summary is chosen when it is created from the error allowed and
+ * does not grow with the stream. Words are given by a 64 bit hash from
+ * ioopm_sketch_hash, and the heavy hitters also keep a copy of their words.
+ *
+ * A count-min sketch never counts a word too low. With the conservative update used
+ * here a count is only too high by at most epsilon times the number of words added,
+ * except with probability delta.
+ */
+
+typedef struct count_min ioopm_count_min_t;
+typedef struct heavy_hitters ioopm_heavy_hitters_t;
+typedef struct hyperloglog ioopm_hyperloglog_t;
+
+/// @brief Hash a word for the summaries
+/// @param word the word, which need not end with '\0'
+/// @param length the number of bytes in word
+/// @return a 64 bit hash of the word
+uint64_t ioopm_sketch_hash(const char *word, size_t length);
+
+/// @brief Creates a count-min sketch
+/// @param epsilon how much too high a count may be, as a fraction of all words added. Below
+/// about 1e-7 the rows get no wider, so the bound is not met.
+/// @param delta the probability that a count is off by more than that
+/// @return a new sketch with all counts 0, or NULL if its counters do not fit in memory
+ioopm_count_min_t *ioopm_count_min_create(double epsilon, double delta);
+
+/// @brief Return the memory of a count-min sketch
+/// @param sketch the sketch to be destroyed
+void ioopm_count_min_destroy(ioopm_count_min_t *sketch);
+
+/// @brief Add to the count of a word
+/// @param sketch the sketch
+/// @param hash the hash of the word
+/// @param count the number of times the word was seen
+/// @return the new estimate of the count of the word
+uint32_t ioopm_count_min_add(ioopm_count_min_t *sketch, uint64_t hash, uint32_t count);
+
+/// @brief Estimate the count of a word
+/// @param sketch the sketch
+/// @param hash the hash of the word
+/// @return at least the number of times the word was added
+uint32_t ioopm_count_min_estimate(ioopm_count_min_t *sketch, uint64_t hash);
+
+/// @brief The number of words added to a sketch, counting repeats
+/// @param sketch the sketch
+/// @return the sum of all counts added
+uint64_t ioopm_count_min_total(ioopm_count_min_t *sketch);
+
+/// @brief The error bound of a sketch, which is at least as tight as the one asked for
+/// @param sketch the sketch
+/// @param epsilon set to how much too high a count may be, as a fraction of all words added
+/// @param delta set to the probability that a count is off by more than that
+void ioopm_count_min_error(ioopm_count_min_t *sketch, double *epsilon, double *delta);
+
+/// @brief The size of a sketch
+/// @param sketch the sketch
+/// @return the number of bytes used by the counters
+size_t ioopm_count_min_bytes(ioopm_count_min_t *sketch);
+
+/// @brief Creates a list of the most frequent words
+/// @param capacity the number of words kept, where 0 is taken as 1
+/// @return a new empty list
+ioopm_heavy_hitters_t *ioopm_heavy_hitters_create(size_t capacity);
+
+/// @brief Return the memory of a list of frequent words, including its copies of words
+/// @param hitters the list to be destroyed
+void ioopm_heavy_hitters_destroy(ioopm_heavy_hitters_t *hitters);
+
+/// @brief Update the list with the current count of a word. The word is kept if it is
+/// already in the list, if the list is not full or if it is counted higher than the
+/// lowest word in the list, which is then dropped.
+/// @param hitters the list
+/// @param word the word, which need not end with '\0'
+/// @param length the number of bytes in word
+/// @param hash the hash of the word from ioopm_sketch_hash
+/// @param count the count of the word, which must not be lower than earlier counts of it
+void ioopm_heavy_hitters_offer(ioopm_heavy_hitters_t *hitters, const char *word, size_t length, uint64_t hash, uint32_t count);
+
+/// @brief The words in the list with their counts, the most frequent first and equal
+/// counts in alphabetical order
+/// @param hitters the list
+/// @param count set to the number of words
+/// @return a heap allocated array of words and counts in .unsigned_integer, valid until the list
+/// is changed. The array is freed by the caller, the words by the list.
+ioopm_string_entry_t *ioopm_heavy_hitters_entries(ioopm_heavy_hitters_t *hitters, size_t *count);
+
+/// @brief Creates a HyperLogLog counter of different words
+/// @param error the relative standard error allowed, between 0.0025 and 0.26
+/// @return a new counter that has seen no words
+ioopm_hyperloglog_t *ioopm_hyperloglog_create(double error);
+
+/// @brief Return the memory of a HyperLogLog counter
+/// @param counter the counter to be destroyed
+void ioopm_hyperloglog_destroy(ioopm_hyperloglog_t *counter);
+
+/// @brief Add a word to a HyperLogLog counter
+/// @param counter the counter
+/// @param hash the hash of the word
+void ioopm_hyperloglog_add(ioopm_hyperloglog_t *counter, uint64_t hash);
+
+/// @brief Estimate the number of different words added
+/// @param counter the counter
+/// @return the estimate
+double ioopm_hyperloglog_estimate(ioopm_hyperloglog_t *counter);
+
+/// @brief The relative standard error of the estimates of a counter
+/// @param counter the counter
+/// @return the error, at most the one asked for
+double ioopm_hyperloglog_error(ioopm_hyperloglog_t *counter);
@@ -0,0 +1,305 @@
+#include <CUnit/Basic.h>
+#include "sketch.h"
+#include "string_sort.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define Distinct_Words 20000
+
+int init_suite(void)
+{
+    return 0;
+}
+
+int clean_suite(void)
+{
+    return 0;
+}
+
+// Word i of a test stream, seen Distinct_Words / (i + 1) times so a few words are frequent
+static size_t word_of(int i, char *buf)
+{
+    return sprintf(buf, "word%d", i);
+}
+
+static uint32_t times_of(int i)
+{
+    return Distinct_Words / (i + 1);
+}
+
+void test_sketch_hash()
+{
+    CU_ASSERT_EQUAL(ioopm_sketch_hash("hello", 5), ioopm_sketch_hash("hello world", 5));
+    CU_ASSERT_NOT_EQUAL(ioopm_sketch_hash("hello", 5), ioopm_sketch_hash("hellp", 5));
+    CU_ASSERT_NOT_EQUAL(ioopm_sketch_hash("", 0), ioopm_sketch_hash("a", 1));
+}
+
+void test_count_min()
+{
+    ioopm_count_min_t *sketch = ioopm_count_min_create(0.001, 0.01);
+    char buf[32];
+    uint64_t total = 0;
+    double epsilon;
+    double delta;
+
+    ioopm_count_min_error(sketch, &epsilon, &delta);
+    CU_ASSERT_TRUE(epsilon <= 0.001);
+    CU_ASSERT_TRUE(delta <= 0.01);
+    CU_ASSERT_EQUAL(ioopm_count_min_estimate(sketch, ioopm_sketch_hash("missing", 7)), 0);
+
+    for (int i = 0; i < Distinct_Words; i++)
+    {
+        uint64_t hash = ioopm_sketch_hash(buf, word_of(i, buf));
+
+        // adding one at a time gives the same as adding all at once
+        for (uint32_t j = 0; j < times_of(i) % 3; j++)
+        {
+            ioopm_count_min_add(sketch, hash, 1);
+        }
+        ioopm_count_min_add(sketch, hash, times_of(i) - times_of(i) % 3);
+        total += times_of(i);
+    }
+    CU_ASSERT_EQUAL(ioopm_count_min_total(sketch), total);
+
+    bool never_low = true;
+    int too_high = 0;
+    for (int i = 0; i < Distinct_Words; i++)
+    {
+        uint32_t estimate = ioopm_count_min_estimate(sketch, ioopm_sketch_hash(buf, word_of(i, buf)));
+
+        never_low = never_low && estimate >= times_of(i);
+        too_high += estimate > times_of(i) + epsilon * total;
+    }
+    CU_ASSERT_TRUE(never_low);
+    // at most delta of the words may be off by more than the bound, with a margin
+    CU_ASSERT_TRUE(too_high <= 2 * delta * Distinct_Words);
+    CU_ASSERT_TRUE(ioopm_count_min_bytes(sketch) > 0);
+
+    ioopm_count_min_destroy(sketch);
+}
+
+void test_count_min_saturates()
+{
+    ioopm_count_min_t *sketch = ioopm_count_min_create(0.1, 0.1);
+    uint64_t hash = ioopm_sketch_hash("many", 4);
+
+    ioopm_count_min_add(sketch, hash, UINT32_MAX - 1);
+    CU_ASSERT_EQUAL(ioopm_count_min_add(sketch, hash, 5), UINT32_MAX);
+    CU_ASSERT_EQUAL(ioopm_count_min_estimate(sketch, hash), UINT32_MAX);
+
+    ioopm_count_min_destroy(sketch);
+}
+
+void test_count_min_tiny_epsilon()
+{
+    // the rows stop growing instead of needing more memory than there is
+    ioopm_count_min_t *sketch = ioopm_count_min_create(1e-300, 0.5);
+    uint64_t hash = ioopm_sketch_hash("rare", 4);
+
+    CU_ASSERT_PTR_NOT_NULL(sketch);
+    ioopm_count_min_add(sketch, hash, 3);
+    CU_ASSERT_EQUAL(ioopm_count_min_estimate(sketch, hash), 3);
+
+    ioopm_count_min_destroy(sketch);
+}
+
+static void check_hyperloglog(double error, int words)
+{
+    ioopm_hyperloglog_t *counter = ioopm_hyperloglog_create(error);
+    char buf[32];
+
+    CU_ASSERT_TRUE(ioopm_hyperloglog_error(counter) <= error);
+    CU_ASSERT_DOUBLE_EQUAL(ioopm_hyperloglog_estimate(counter), 0, 0.5);
+
+    for (int i = 0; i < words; i++)
+    {
+        uint64_t hash = ioopm_sketch_hash(buf, word_of(i, buf));
+
+        // repeats do not change the estimate
+        ioopm_hyperloglog_add(counter, hash);
+        ioopm_hyperloglog_add(counter, hash);
+    }
+
+    double estimate = ioopm_hyperloglog_estimate(counter);
+    CU_ASSERT_TRUE(fabs(estimate - words) <= 3 * ioopm_hyperloglog_error(counter) * words + 1);
+
+    ioopm_hyperloglog_destroy(counter);
+}
+
+void test_hyperloglog()
+{
+    check_hyperloglog(0.01, 10);
+    check_hyperloglog(0.01, 1000);
+    check_hyperloglog(0.01, 200000);
+    check_hyperloglog(0.05, 200000);
+}
+
+void test_heavy_hitters()
+{
+    ioopm_heavy_hitters_t *hitters = ioopm_heavy_hitters_create(10);
+    char buf[32];
+    size_t count;
+
+    ioopm_string_entry_t *entries = ioopm_heavy_hitters_entries(hitters, &count);
+    CU_ASSERT_EQUAL(count, 0);
+    free(entries);
+
+    // every word is offered once per occurrence, in an order mixing frequent and rare words
+    uint32_t *seen = calloc(Distinct_Words, sizeof(uint32_t));
+    for (int round = 0; round < Distinct_Words; round++)
+    {
+        for (int i = 0; i < Distinct_Words && times_of(i) > (uint32_t) round; i++)
+        {
+            size_t length = word_of(i, buf);
+            ioopm_heavy_hitters_offer(hitters, buf, length, ioopm_sketch_hash(buf, length), ++seen[i]);
+        }
+    }
+
+    entries = ioopm_heavy_hitters_entries(hitters, &count);
+    CU_ASSERT_EQUAL(count, 10);
+
+    bool top_found = true;
+    for (int i = 0; i < 10; i++)
+    {
+        word_of(i, buf);
+        top_found = top_found && strcmp(entries[i].string, buf) == 0 && entries[i].value.unsigned_integer == times_of(i);
+    }
+    CU_ASSERT_TRUE(top_found);
+
+    free(entries);
+    free(seen);
+    ioopm_heavy_hitters_destroy(hitters);
+}
+
+void test_heavy_hitters_evict()
+{
+    ioopm_heavy_hitters_t *hitters = ioopm_heavy_hitters_create(2);
+    size_t count;
+
+    ioopm_heavy_hitters_offer(hitters, "a", 1, ioopm_sketch_hash("a", 1), 3);
+    ioopm_heavy_hitters_offer(hitters, "b", 1, ioopm_sketch_hash("b", 1), 1);
+    // not higher than the lowest word, so it is not kept
+    ioopm_heavy_hitters_offer(hitters, "c", 1, ioopm_sketch_hash("c", 1), 1);
+    // higher than b, which is dropped
+    ioopm_heavy_hitters_offer(hitters, "dd", 2, ioopm_sketch_hash("dd", 2), 2);
+    // a word already in the list is updated
+    ioopm_heavy_hitters_offer(hitters, "dd", 2, ioopm_sketch_hash("dd", 2), 4);
+    // b is counted again after it was dropped
+    ioopm_heavy_hitters_offer(hitters, "b", 1, ioopm_sketch_hash("b", 1), 3);
+
+    ioopm_string_entry_t *entries = ioopm_heavy_hitters_entries(hitters, &count);
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_STRING_EQUAL(entries[0].string, "dd");
+    CU_ASSERT_EQUAL(entries[0].value.unsigned_integer, 4);
+    CU_ASSERT_STRING_EQUAL(entries[1].string, "a");
+    CU_ASSERT_EQUAL(entries[1].value.unsigned_integer, 3);
+    free(entries);
+
+    // equal counts are listed alphabetically
+    ioopm_heavy_hitters_offer(hitters, "a", 1, ioopm_sketch_hash("a", 1), 4);
+    entries = ioopm_heavy_hitters_entries(hitters, &count);
+    CU_ASSERT_STRING_EQUAL(entries[0].string, "a");
+    CU_ASSERT_STRING_EQUAL(entries[1].string, "dd");
+    free(entries);
+
+    ioopm_heavy_hitters_destroy(hitters);
+}
+
+void test_heavy_hitters_no_capacity()
+{
+    ioopm_heavy_hitters_t *hitters = ioopm_heavy_hitters_create(0);
+    size_t count;
+
+    // one word is kept, and looking up another one ends at an empty slot
+    ioopm_heavy_hitters_offer(hitters, "a", 1, ioopm_sketch_hash("a", 1), 1);
+    ioopm_heavy_hitters_offer(hitters, "b", 1, ioopm_sketch_hash("b", 1), 2);
+    ioopm_heavy_hitters_offer(hitters, "c", 1, ioopm_sketch_hash("c", 1), 1);
+
+    ioopm_string_entry_t *entries = ioopm_heavy_hitters_entries(hitters, &count);
+    CU_ASSERT_EQUAL(count, 1);
+    CU_ASSERT_STRING_EQUAL(entries[0].string, "b");
+    free(entries);
+
+    ioopm_heavy_hitters_destroy(hitters);
+}
+
+// Words that all start in the same slot exercise the moves when a word is dropped
+void test_heavy_hitters_churn()
+{
+    ioopm_heavy_hitters_t *hitters = ioopm_heavy_hitters_create(4);
+    char buf[32];
+    size_t count;
+
+    for (int i = 0; i < 1000; i++)
+    {
+        size_t length = word_of(i, buf);
+        ioopm_heavy_hitters_offer(hitters, buf, length, ioopm_sketch_hash(buf, length) & ~(uint64_t) 7, i + 1);
+    }
+
+    ioopm_string_entry_t *entries = ioopm_heavy_hitters_entries(hitters, &count);
+    CU_ASSERT_EQUAL(count, 4);
+    CU_ASSERT_STRING_EQUAL(entries[0].string, "word999");
+    CU_ASSERT_STRING_EQUAL(entries[3].string, "word996");
+    free(entries);
+
+    // the kept words are still found and updated in place
+    ioopm_heavy_hitters_offer(hitters, "word996", 7, ioopm_sketch_hash("word996", 7) & ~(uint64_t) 7, 5000);
+    entries = ioopm_heavy_hitters_entries(hitters, &count);
+    CU_ASSERT_EQUAL(count, 4);
+    CU_ASSERT_STRING_EQUAL(entries[0].string, "word996");
+    free(entries);
+
+    ioopm_heavy_hitters_destroy(hitters);
+}
+
+int main()
+{
+    // First we try to set up CUnit, and exit if we fail
+    if (CU_initialize_registry() != CUE_SUCCESS)
+        return CU_get_error();
+
+    // We then create an empty test suite and specify the name and
+    // the init and cleanup functions
+    CU_pSuite my_test_suite = CU_add_suite("Tests for sketch.c", init_suite, clean_suite);
+    if (my_test_suite == NULL)
+    {
+        // If the test suite could not be added, tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // This is where we add the test functions to our test suite.
+    // For each call to CU_add_test we specify the test suite, the
+    // name or description of the test, and the function that runs
+    // the test in question. If you want to add another test, just
+    // copy a line below and change the information
+    if (
+        (CU_add_test(my_test_suite, "Hash words for the summaries", test_sketch_hash) == NULL ||
+         CU_add_test(my_test_suite, "Count-min estimates are never low and within the bound", test_count_min) == NULL ||
+         CU_add_test(my_test_suite, "Count-min counters saturate", test_count_min_saturates) == NULL ||
+         CU_add_test(my_test_suite, "Count-min rows are capped for a tiny epsilon", test_count_min_tiny_epsilon) == NULL ||
+         CU_add_test(my_test_suite, "HyperLogLog estimates within the error", test_hyperloglog) == NULL ||
+         CU_add_test(my_test_suite, "Heavy hitters find the most frequent words", test_heavy_hitters) == NULL ||
+         CU_add_test(my_test_suite, "Heavy hitters drop the lowest word", test_heavy_hitters_evict) == NULL ||
+         CU_add_test(my_test_suite, "Heavy hitters created for no words keep one", test_heavy_hitters_no_capacity) == NULL ||
+         CU_add_test(my_test_suite, "Heavy hitters with colliding words", test_heavy_hitters_churn) == NULL))
+    {
+        // If adding any of the tests fails, we tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Set the running mode. Use CU_BRM_VERBOSE for maximum output.
+    // Use CU_BRM_NORMAL to only print errors and a summary
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+
+    // This is where the tests are actually run!
+    CU_basic_run_tests();
+
+    // Tear down CUnit before exiting
+    CU_cleanup_registry();
+    return CU_get_error();
+}
@@ -0,0 +1,162 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "string_sort.h"
+
+#define CHUNK_SIZE 8
+#define INSERTION_LIMIT 16
+
+typedef struct record record_t;
+
+struct record
+{
+    uint64_t chunk;     // the characters of string at the current depth, the first one highest
+    ioopm_string_entry_t entry;
+};
+
+// Reads CHUNK_SIZE characters from depth, padded with 0 after the end of the string, so
+// that chunks compare like strcmp
+static uint64_t chunk_at(const char *string, size_t depth)
+{
+    const unsigned char *c = (const unsigned char *) string + depth;
+    uint64_t chunk = 0;
+
+    for (int i = 0; i < CHUNK_SIZE; i++)
+    {
+        chunk <<= 8;
+        if (*c != '\0')
+        {
+            chunk |= *c++;
+        }
+    }
+    return chunk;
+}
+
+// True if the string of a chunk ends within it, so that equal chunks mean equal strings
+static inline bool chunk_ends(uint64_t chunk)
+{
+    return (chunk & 0xff) == 0;
+}
+
+static inline void record_swap(record_t *records, size_t i, size_t j)
+{
+    record_t tmp = records[i];
+    records[i] = records[j];
+    records[j] = tmp;
+}
+
+// Compares two records whose strings agree before depth
+static int record_cmp(record_t *a, record_t *b, size_t depth)
+{
+    if (a->chunk != b->chunk)
+    {
+        return a->chunk < b->chunk ? -1 : 1;
+    }
+    if (chunk_ends(a->chunk))
+    {
+        return 0;
+    }
+    return strcmp(a->entry.string + depth + CHUNK_SIZE, b->entry.string + depth + CHUNK_SIZE);
+}
+
+static void insertion_sort(record_t *records, size_t count, size_t depth)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        record_t current = records[i];
+        size_t j = i;
+
+        for (; j > 0 && record_cmp(&records[j - 1], &current, depth) > 0; j--)
+        {
+            records[j] = records[j - 1];
+        }
+        records[j] = current;
+    }
+}
+
+static uint64_t median_of_three(uint64_t a, uint64_t b, uint64_t c)
+{
+    if (a < b)
+    {
+        return b < c ? b : (a < c ? c : a);
+    }
+    return a < c ? a : (b < c ? c : b);
+}
+
+// Sorts records whose strings agree before depth and whose chunks are read at depth
+static void multikey_quicksort(record_t *records, size_t count, size_t depth)
+{
+    while (count > INSERTION_LIMIT)
+    {
+        uint64_t pivot = median_of_three(records[0].chunk, records[count / 2].chunk, records[count - 1].chunk);
+        size_t less = 0;
+        size_t i = 0;
+        size_t greater = count;
+
+        // records[0, less) < pivot, records[less, i) == pivot, records[greater, count) > pivot
+        while (i < greater)
+        {
+            if (records[i].chunk < pivot)
+            {
+                record_swap(records, less++, i++);
+            }
+            else if (records[i].chunk > pivot)
+            {
+                record_swap(records, i, --greater);
+            }
+            else
+            {
+                i++;
+            }
+        }
+
+        // the strings equal to the pivot so far are sorted on their next characters
+        if (!chunk_ends(pivot))
+        {
+            for (size_t j = less; j < greater; j++)
+            {
+                records[j].chunk = chunk_at(records[j].entry.string, depth + CHUNK_SIZE);
+            }
+            multikey_quicksort(records + less, greater - less, depth + CHUNK_SIZE);
+        }
+
+        // recurse on the smaller side and loop on the larger to bound the stack
+        if (less < count - greater)
+        {
+            multikey_quicksort(records, less, depth);
+            records += greater;
+            count -= greater;
+        }
+        else
+        {
+            multikey_quicksort(records + greater, count - greater, depth);
+            count = less;
+        }
+    }
+
+    insertion_sort(records, count, depth);
+}
+
+void ioopm_string_sort(ioopm_string_entry_t *entries, size_t count)
+{
+    if (count < 2)
+    {
+        return;
+    }
+
+    record_t *records = calloc(count, sizeof(record_t));
+    for (size_t i = 0; i < count; i++)
+    {
+        records[i].chunk = chunk_at(entries[i].string, 0);
+        records[i].entry = entries[i];
+    }
+
+    multikey_quicksort(records, count, 0);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        entries[i] = records[i].entry;
+    }
+    free(records);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <stddef.h>
+#include "common.h"
+
+/**
+ * @file string_sort.h
+ * @author Tuva Björnberg & Gustav Fridén
+ * @date 29/09-2023
+ * @brief Sorts strings, each with a value carried along, in the order of strcmp.
+ *
+ * The sort is a multikey quicksort that works on 8 characters at a time. Next to every
+ * string it keeps the 8 characters at the depth being sorted, read as one 64 bit number,
+ * so most comparisons are one integer comparison without following the string pointer.
+ * Strings that share those 8 characters are sorted on the next 8, and short ranges are
+ * finished with insertion sort.
+ *
+ * The sort is not stable, which only matters for equal strings.
+ */
+
+typedef struct string_entry ioopm_string_entry_t;
+
+struct string_entry
+{
+    char *string;
+    elem_t value;   // moved along with the string
+};
+
+/// @brief Sort entries by their strings in the order of strcmp
+/// @param entries the entries to be sorted
+/// @param count the number of entries
+void ioopm_string_sort(ioopm_string_entry_t *entries, size_t count);
@@ -0,0 +1,163 @@
+#include <CUnit/Basic.h>
+#include "string_sort.h"
+#include "common.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Random_Strings 5000
+
+int init_suite(void)
+{
+    return 0;
+}
+
+int clean_suite(void)
+{
+    return 0;
+}
+
+static int cmp_entry(const void *a, const void *b)
+{
+    return strcmp(((const ioopm_string_entry_t *) a)->string, ((const ioopm_string_entry_t *) b)->string);
+}
+
+// Sorts entries with ioopm_string_sort and checks the order against qsort, and that
+// every value is still next to its string
+static void check_sorted(ioopm_string_entry_t *entries, size_t count)
+{
+    ioopm_string_entry_t *expected = calloc(count + 1, sizeof(ioopm_string_entry_t));
+    memcpy(expected, entries, count * sizeof(ioopm_string_entry_t));
+    qsort(expected, count, sizeof(ioopm_string_entry_t), cmp_entry);
+
+    ioopm_string_sort(entries, count);
+
+    bool same_order = true;
+    bool values_follow = true;
+    for (size_t i = 0; i < count; i++)
+    {
+        same_order = same_order && strcmp(entries[i].string, expected[i].string) == 0;
+        // every test gives a string the value of its first character
+        values_follow = values_follow && entries[i].value.integer == (unsigned char) entries[i].string[0];
+    }
+    CU_ASSERT_TRUE(same_order);
+    CU_ASSERT_TRUE(values_follow);
+
+    free(expected);
+}
+
+static ioopm_string_entry_t entry_of(char *string)
+{
+    return (ioopm_string_entry_t) {.string = string, .value = int_elem((unsigned char) string[0])};
+}
+
+void test_sort_small()
+{
+    char *strings[] = {"pear", "apple", "", "applesauce", "apple", "b", "\xc3\xa5ngest", "Zebra", "apples", "applesaucy"};
+    ioopm_string_entry_t entries[10];
+
+    for (int i = 0; i < 10; i++)
+    {
+        entries[i] = entry_of(strings[i]);
+    }
+    check_sorted(entries, 10);
+    CU_ASSERT_STRING_EQUAL(entries[0].string, "");
+    CU_ASSERT_STRING_EQUAL(entries[1].string, "Zebra");
+    CU_ASSERT_STRING_EQUAL(entries[9].string, "\xc3\xa5ngest");
+
+    check_sorted(entries, 0);
+    check_sorted(entries, 1);
+}
+
+// Fills strings with random words, each starting with a common prefix of random length
+static void random_strings(ioopm_string_entry_t *entries, char **strings, size_t count, const char *alphabet)
+{
+    size_t letters = strlen(alphabet);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t prefix = rand() % 20;
+        size_t length = prefix + rand() % 12;
+        strings[i] = calloc(length + 1, 1);
+
+        for (size_t j = 0; j < length; j++)
+        {
+            strings[i][j] = j < prefix ? 'a' + j % 3 : alphabet[rand() % letters];
+        }
+        entries[i] = entry_of(strings[i]);
+    }
+}
+
+void test_sort_random()
+{
+    ioopm_string_entry_t *entries = calloc(Random_Strings, sizeof(ioopm_string_entry_t));
+    char **strings = calloc(Random_Strings, sizeof(char *));
+    const char *alphabets[] = {"ab", "abcdefghijklmnopqrstuvwxyz", "xy\x80\xff"};
+
+    srand(3);
+    for (int a = 0; a < 3; a++)
+    {
+        random_strings(entries, strings, Random_Strings, alphabets[a]);
+        check_sorted(entries, Random_Strings);
+
+        // sorted and reversed input
+        check_sorted(entries, Random_Strings);
+        for (size_t i = 0; i < Random_Strings / 2; i++)
+        {
+            ioopm_string_entry_t tmp = entries[i];
+            entries[i] = entries[Random_Strings - 1 - i];
+            entries[Random_Strings - 1 - i] = tmp;
+        }
+        check_sorted(entries, Random_Strings);
+
+        for (size_t i = 0; i < Random_Strings; i++)
+        {
+            free(strings[i]);
+        }
+    }
+
+    free(strings);
+    free(entries);
+}
+
+int main()
+{
+    // First we try to set up CUnit, and exit if we fail
+    if (CU_initialize_registry() != CUE_SUCCESS)
+        return CU_get_error();
+
+    // We then create an empty test suite and specify the name and
+    // the init and cleanup functions
+    CU_pSuite my_test_suite = CU_add_suite("Tests for string_sort.c", init_suite, clean_suite);
+    if (my_test_suite == NULL)
+    {
+        // If the test suite could not be added, tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // This is where we add the test functions to our test suite.
+    // For each call to CU_add_test we specify the test suite, the
+    // name or description of the test, and the function that runs
+    // the test in question. If you want to add another test, just
+    // copy a line below and change the information
+    if (
+        (CU_add_test(my_test_suite, "Sort a few strings with shared prefixes", test_sort_small) == NULL ||
+         CU_add_test(my_test_suite, "Sort random strings like qsort and strcmp", test_sort_random) == NULL))
+    {
+        // If adding any of the tests fails, we tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Set the running mode. Use CU_BRM_VERBOSE for maximum output.
+    // Use CU_BRM_NORMAL to only print errors and a summary
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+
+    // This is where the tests are actually run!
+    CU_basic_run_tests();
+
+    // Tear down CUnit before exiting
+    CU_cleanup_registry();
+    return CU_get_error();
+}
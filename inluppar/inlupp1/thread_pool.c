@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+struct thread_pool
+{
+    pthread_t *workers;
+    size_t worker_count;    // threads started by the pool, one less than the pool size
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    unsigned long batch;    // incremented for every batch so sleeping workers see a new one
+    bool stopping;
+
+    // the current batch, protected by lock
+    ioopm_task_function task;
+    char *args;
+    size_t arg_size;
+    size_t count;
+    size_t next;            // the next task to hand out
+    size_t unfinished;      // tasks handed out or waiting that have not finished
+};
+
+// Runs tasks of the current batch until there are none left. Called with lock held.
+static void batch_work(ioopm_thread_pool_t *pool)
+{
+    while (pool->next < pool->count)
+    {
+        size_t index = pool->next++;
+        void *arg = pool->args + index * pool->arg_size;
+
+        pthread_mutex_unlock(&pool->lock);
+        pool->task(arg);
+        pthread_mutex_lock(&pool->lock);
+
+        if (--pool->unfinished == 0)
+        {
+            pthread_cond_broadcast(&pool->work_done);
+        }
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    ioopm_thread_pool_t *pool = arg;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while (true)
+    {
+        while (!pool->stopping && pool->batch == seen)
+        {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+
+        if (pool->stopping)
+        {
+            break;
+        }
+
+        seen = pool->batch;
+        batch_work(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+ioopm_thread_pool_t *ioopm_thread_pool_create(size_t threads)
+{
+    if (threads == 0)
+    {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? online : 1;
+    }
+
+    ioopm_thread_pool_t *pool = calloc(1, sizeof(ioopm_thread_pool_t));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    pool->worker_count = threads - 1;
+    pool->workers = calloc(threads, sizeof(pthread_t));
+    for (size_t i = 0; i < pool->worker_count; i++)
+    {
+        pthread_create(&pool->workers[i], NULL, worker_main, pool);
+    }
+
+    return pool;
+}
+
+void ioopm_thread_pool_destroy(ioopm_thread_pool_t *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->worker_count; i++)
+    {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
+
+size_t ioopm_thread_pool_size(ioopm_thread_pool_t *pool)
+{
+    return pool->worker_count + 1;
+}
+
+void ioopm_thread_pool_run(ioopm_thread_pool_t *pool, ioopm_task_function task, void *args, size_t arg_size, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->args = args;
+    pool->arg_size = arg_size;
+    pool->count = count;
+    pool->next = 0;
+    pool->unfinished = count;
+    pool->batch++;
+    pthread_cond_broadcast(&pool->work_ready);
+
+    // the calling thread takes tasks too, then waits for the ones still running
+    batch_work(pool);
+    while (pool->unfinished > 0)
+    {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <stddef.h>
+
+/**
+ * @file thread_pool.h
+ * @author Tuva Björnberg & Gustav Fridén
+ * @date 29/09-2023
+ * @brief A fixed set of worker threads (`thread_pool_t`) that run batches of tasks.
+ *
+ * The threads are started once when the pool is created and sleep between batches.
+ * A batch is a task function and an array of arguments, one per task. The calling
+ * thread works on the batch too and returns when every task has finished.
+ *
+ * The pool needs to be linked with -pthread. Only one thread at a time may run batches
+ * on a pool.
+ */
+
+typedef struct thread_pool ioopm_thread_pool_t;
+
+typedef void(*ioopm_task_function)(void *arg);
+
+/// @brief Creates a pool and starts its worker threads
+/// @param threads the number of threads working on a batch, including the calling thread,
+/// or 0 for the number of online processors
+/// @return a new pool
+ioopm_thread_pool_t *ioopm_thread_pool_create(size_t threads);
+
+/// @brief Stop the worker threads and return the resources of the pool
+/// @param pool the pool to be destroyed
+void ioopm_thread_pool_destroy(ioopm_thread_pool_t *pool);
+
+/// @brief The number of threads working on a batch, including the calling thread
+/// @param pool the pool
+/// @return the number of threads
+size_t ioopm_thread_pool_size(ioopm_thread_pool_t *pool);
+
+/// @brief Run task once for every argument in args, spread over the threads of the pool,
+/// and wait until all of them have finished
+/// @param pool the pool
+/// @param task the function run by every task
+/// @param args an array of count arguments, each arg_size bytes
+/// @param arg_size the size of one argument in bytes
+/// @param count the number of tasks
+void ioopm_thread_pool_run(ioopm_thread_pool_t *pool, ioopm_task_function task, void *args, size_t arg_size, size_t count);
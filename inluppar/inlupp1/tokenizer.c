@@ -0,0 +1,568 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "tokenizer.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define Has_x86_simd 1
+#else
+#define Has_x86_simd 0
+#endif
+
+/// Normalized text is folded and tokenized in chunks of about this many bytes, which are
+/// still in the cache when they are tokenized
+#define Fold_Chunk (1 << 14)
+/// The folded text is at most 3 times as long, when every byte is replaced with U+FFFD,
+/// plus room for a vector stored past the end
+#define Fold_Capacity(length) (3 * (length) + 32)
+
+typedef struct fold_range fold_range_t;
+
+typedef size_t(*tokenize_function)(ioopm_tokenizer_t *tokenizer, const char *text, size_t length, ioopm_word_function fun, void *extra);
+typedef size_t(*fold_function)(ioopm_tokenizer_t *tokenizer, const unsigned char *text, size_t length, unsigned char *folded);
+
+// Upper case letters from first to last, every step:th of them, are lower case letters
+// offset code points further on
+struct fold_range
+{
+    uint16_t first;
+    uint16_t last;
+    uint16_t step;
+    int16_t offset;
+};
+
+// The upper case letters below U+0800 whose lower case letter also is below U+0800, so
+// that both take as many bytes in UTF-8. Letters like U+0130 I with dot above are left.
+static const fold_range_t fold_ranges[] =
+{
+    {'A', 'Z', 1, 32},
+    {0xc0, 0xd6, 1, 32}, {0xd8, 0xde, 1, 32},               // Latin-1
+    {0x100, 0x12e, 2, 1}, {0x132, 0x136, 2, 1},             // Latin Extended-A
+    {0x139, 0x147, 2, 1}, {0x14a, 0x176, 2, 1},
+    {0x178, 0x178, 1, 0xff - 0x178}, {0x179, 0x17d, 2, 1},
+    {0x386, 0x386, 1, 0x3ac - 0x386}, {0x388, 0x38a, 1, 37}, // Greek
+    {0x38c, 0x38c, 1, 64}, {0x38e, 0x38f, 1, 63},
+    {0x391, 0x3a1, 1, 32}, {0x3a3, 0x3ab, 1, 32},
+    {0x400, 0x40f, 1, 80}, {0x410, 0x42f, 1, 32},           // Cyrillic
+    {0x460, 0x480, 2, 1}, {0x48a, 0x4be, 2, 1},
+    {0x4c0, 0x4c0, 1, 15}, {0x4c1, 0x4cd, 2, 1}, {0x4d0, 0x52e, 2, 1},
+    {0x531, 0x556, 1, 48},                                  // Armenian
+};
+
+struct tokenizer
+{
+    bool delimiter[256];            // indexed by unsigned char, true for the bytes separating words
+    // A byte b is a delimiter when low_nibble[b & 15] & high_nibble[b >> 4] is not 0. Each
+    // high nibble used by a delimiter has a bit of its own, so at most 8 of them fit.
+    uint8_t low_nibble[16];
+    uint8_t high_nibble[16];
+    const char *kind;
+    tokenize_function tokenize;
+    bool normalize;                 // fold the case of words and replace invalid UTF-8
+    fold_function fold;
+    uint16_t lower[0x800];          // the lower case of every code point below U+0800
+};
+
+// Walks the text one byte at a time from a given state, calling fun for every word that
+// ends before length. Returns the new state through in_word and start.
+static size_t tokenize_bytes(ioopm_tokenizer_t *tokenizer, const char *text, size_t i, size_t length, bool *in_word, size_t *start, ioopm_word_function fun, void *extra)
+{
+    const unsigned char *bytes = (const unsigned char *) text;
+    const bool *delimiter = tokenizer->delimiter;
+    size_t words = 0;
+
+    for (; i < length; i++)
+    {
+        if (delimiter[bytes[i]] == *in_word)
+        {
+            if (*in_word)
+            {
+                fun(text + *start, i - *start, extra);
+                words++;
+            }
+            else
+            {
+                *start = i;
+            }
+            *in_word = !*in_word;
+        }
+    }
+
+    return words;
+}
+
+static size_t tokenize_scalar(ioopm_tokenizer_t *tokenizer, const char *text, size_t length, ioopm_word_function fun, void *extra)
+{
+    bool in_word = false;
+    size_t start = 0;
+    size_t words = tokenize_bytes(tokenizer, text, 0, length, &in_word, &start, fun, extra);
+
+    if (in_word)
+    {
+        fun(text + start, length - start, extra);
+        words++;
+    }
+    return words;
+}
+
+// Calls fun for every word that ends in a block, given a mask with a bit set for every
+// delimiter in the block. Returns the number of words.
+static inline size_t tokenize_mask(uint32_t delimiters, unsigned block_size, const char *text, size_t block_start, bool *in_word, size_t *start, ioopm_word_function fun, void *extra)
+{
+    uint32_t letters = ~delimiters & (uint32_t) ((1ull << block_size) - 1);
+    unsigned bit = 0;
+    size_t words = 0;
+
+    while (bit < block_size)
+    {
+        // the next byte where the state changes
+        uint32_t changes = (*in_word ? delimiters : letters) >> bit;
+
+        if (changes == 0)
+        {
+            break;
+        }
+        bit += __builtin_ctz(changes);
+
+        if (*in_word)
+        {
+            fun(text + *start, block_start + bit - *start, extra);
+            words++;
+        }
+        else
+        {
+            *start = block_start + bit;
+        }
+        *in_word = !*in_word;
+    }
+
+    return words;
+}
+
+#if Has_x86_simd
+
+__attribute__((target("ssse3")))
+static size_t tokenize_ssse3(ioopm_tokenizer_t *tokenizer, const char *text, size_t length, ioopm_word_function fun, void *extra)
+{
+    const __m128i low_table = _mm_loadu_si128((const __m128i *) tokenizer->low_nibble);
+    const __m128i high_table = _mm_loadu_si128((const __m128i *) tokenizer->high_nibble);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    bool in_word = false;
+    size_t start = 0;
+    size_t words = 0;
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *) (text + i));
+        __m128i low = _mm_shuffle_epi8(low_table, _mm_and_si128(block, nibble));
+        __m128i high = _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi16(block, 4), nibble));
+        __m128i is_letter = _mm_cmpeq_epi8(_mm_and_si128(low, high), _mm_setzero_si128());
+        uint32_t delimiters = ~_mm_movemask_epi8(is_letter) & 0xffff;
+
+        words += tokenize_mask(delimiters, 16, text, i, &in_word, &start, fun, extra);
+    }
+
+    words += tokenize_bytes(tokenizer, text, i, length, &in_word, &start, fun, extra);
+    if (in_word)
+    {
+        fun(text + start, length - start, extra);
+        words++;
+    }
+    return words;
+}
+
+__attribute__((target("avx2")))
+static size_t tokenize_avx2(ioopm_tokenizer_t *tokenizer, const char *text, size_t length, ioopm_word_function fun, void *extra)
+{
+    const __m256i low_table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) tokenizer->low_nibble));
+    const __m256i high_table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) tokenizer->high_nibble));
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    bool in_word = false;
+    size_t start = 0;
+    size_t words = 0;
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *) (text + i));
+        __m256i low = _mm256_shuffle_epi8(low_table, _mm256_and_si256(block, nibble));
+        __m256i high = _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble));
+        __m256i is_letter = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+        uint32_t delimiters = ~(uint32_t) _mm256_movemask_epi8(is_letter);
+
+        words += tokenize_mask(delimiters, 32, text, i, &in_word, &start, fun, extra);
+    }
+
+    words += tokenize_bytes(tokenizer, text, i, length, &in_word, &start, fun, extra);
+    if (in_word)
+    {
+        fun(text + start, length - start, extra);
+        words++;
+    }
+    return words;
+}
+
+#endif
+
+// Returns the number of bytes of the UTF-8 character at text[i], or 0 if the bytes there
+// are not valid UTF-8: a stray continuation byte, a cut off character, an overlong
+// encoding, a surrogate or a code point above U+10FFFF
+static inline size_t utf8_length(const unsigned char *text, size_t i, size_t length)
+{
+    unsigned char lead = text[i];
+    unsigned char low = 0x80;
+    unsigned char high = 0xbf;
+    size_t size;
+
+    if (lead < 0x80)
+    {
+        return 1;
+    }
+    else if (lead >= 0xc2 && lead <= 0xdf)
+    {
+        size = 2;
+    }
+    else if (lead >= 0xe0 && lead <= 0xef)
+    {
+        size = 3;
+        low = lead == 0xe0 ? 0xa0 : low;
+        high = lead == 0xed ? 0x9f : high;
+    }
+    else if (lead >= 0xf0 && lead <= 0xf4)
+    {
+        size = 4;
+        low = lead == 0xf0 ? 0x90 : low;
+        high = lead == 0xf4 ? 0x8f : high;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (i + size > length || text[i + 1] < low || text[i + 1] > high)
+    {
+        return 0;
+    }
+    for (size_t k = 2; k < size; k++)
+    {
+        if ((text[i + k] & 0xc0) != 0x80)
+        {
+            return 0;
+        }
+    }
+    return size;
+}
+
+// Folds the character at text[*i] into folded[*out] and moves past both. Characters of
+// one or two bytes are looked up in the table of lower case letters, longer ones are
+// copied and an invalid byte is replaced with U+FFFD.
+static inline void fold_char(ioopm_tokenizer_t *tokenizer, const unsigned char *text, size_t *i, size_t length, unsigned char *folded, size_t *out)
+{
+    size_t size = utf8_length(text, *i, length);
+
+    if (size == 1)
+    {
+        folded[(*out)++] = tokenizer->lower[text[*i]];
+    }
+    else if (size == 2)
+    {
+        uint16_t lower = tokenizer->lower[(text[*i] & 0x1f) << 6 | (text[*i + 1] & 0x3f)];
+
+        folded[(*out)++] = 0xc0 | lower >> 6;
+        folded[(*out)++] = 0x80 | (lower & 0x3f);
+    }
+    else if (size > 2)
+    {
+        memcpy(folded + *out, text + *i, size);
+        *out += size;
+    }
+    else
+    {
+        memcpy(folded + *out, "\xef\xbf\xbd", 3);
+        *out += 3;
+        size = 1;
+    }
+    *i += size;
+}
+
+static size_t fold_scalar(ioopm_tokenizer_t *tokenizer, const unsigned char *text, size_t length, unsigned char *folded)
+{
+    size_t out = 0;
+
+    for (size_t i = 0; i < length;)
+    {
+        fold_char(tokenizer, text, &i, length, folded, &out);
+    }
+    return out;
+}
+
+#if Has_x86_simd
+
+// Blocks of ASCII, which is most text, are folded 16 or 32 bytes at a time by adding
+// 0x20 to the bytes from 'A' to 'Z'. A block with other bytes is folded as ASCII up to
+// the first of them and one character at a time from there to the end of the block.
+
+__attribute__((target("ssse3")))
+static size_t fold_ssse3(ioopm_tokenizer_t *tokenizer, const unsigned char *text, size_t length, unsigned char *folded)
+{
+    const __m128i before_a = _mm_set1_epi8('A' - 1);
+    const __m128i after_z = _mm_set1_epi8('Z' + 1);
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    size_t out = 0;
+    size_t i = 0;
+
+    while (i + 16 <= length)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *) (text + i));
+        // bytes outside ASCII are negative, so they are never taken for upper case
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(block, before_a), _mm_cmplt_epi8(block, after_z));
+        uint32_t other = _mm_movemask_epi8(block);
+
+        _mm_storeu_si128((__m128i *) (folded + out), _mm_or_si128(block, _mm_and_si128(upper, case_bit)));
+        if (other == 0)
+        {
+            i += 16;
+            out += 16;
+            continue;
+        }
+
+        size_t end = i + 16;
+        size_t ascii = __builtin_ctz(other);
+        i += ascii;
+        out += ascii;
+        while (i < end)
+        {
+            fold_char(tokenizer, text, &i, length, folded, &out);
+        }
+    }
+
+    while (i < length)
+    {
+        fold_char(tokenizer, text, &i, length, folded, &out);
+    }
+    return out;
+}
+
+__attribute__((target("avx2")))
+static size_t fold_avx2(ioopm_tokenizer_t *tokenizer, const unsigned char *text, size_t length, unsigned char *folded)
+{
+    const __m256i before_a = _mm256_set1_epi8('A' - 1);
+    const __m256i after_z = _mm256_set1_epi8('Z' + 1);
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+    size_t out = 0;
+    size_t i = 0;
+
+    while (i + 32 <= length)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *) (text + i));
+        __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(block, before_a), _mm256_cmpgt_epi8(after_z, block));
+        uint32_t other = _mm256_movemask_epi8(block);
+
+        _mm256_storeu_si256((__m256i *) (folded + out), _mm256_or_si256(block, _mm256_and_si256(upper, case_bit)));
+        if (other == 0)
+        {
+            i += 32;
+            out += 32;
+            continue;
+        }
+
+        size_t end = i + 32;
+        size_t ascii = __builtin_ctz(other);
+        i += ascii;
+        out += ascii;
+        while (i < end)
+        {
+            fold_char(tokenizer, text, &i, length, folded, &out);
+        }
+    }
+
+    while (i < length)
+    {
+        fold_char(tokenizer, text, &i, length, folded, &out);
+    }
+    return out;
+}
+
+#endif
+
+// Folds and tokenizes a text one chunk at a time. Every chunk but the last ends at a
+// delimiter, which is ASCII and so never inside a character.
+static size_t tokenize_normalized(ioopm_tokenizer_t *tokenizer, const char *text, size_t length, ioopm_word_function fun, void *extra)
+{
+    size_t capacity = Fold_Capacity(Fold_Chunk);
+    unsigned char *folded = malloc(capacity);
+    size_t words = 0;
+    size_t start = 0;
+
+    while (start < length)
+    {
+        size_t end = length - start > Fold_Chunk ? start + Fold_Chunk : length;
+
+        while (end < length && !tokenizer->delimiter[(unsigned char) text[end]])
+        {
+            end++;
+        }
+        // only a word longer than a chunk needs more room
+        if (Fold_Capacity(end - start) > capacity)
+        {
+            capacity = Fold_Capacity(end - start);
+            folded = realloc(folded, capacity);
+        }
+
+        size_t folded_length = tokenizer->fold(tokenizer, (const unsigned char *) text + start, end - start, folded);
+        words += tokenizer->tokenize(tokenizer, (const char *) folded, folded_length, fun, extra);
+        start = end;
+    }
+
+    free(folded);
+    return words;
+}
+
+static void lower_table_create(ioopm_tokenizer_t *tokenizer)
+{
+    for (int c = 0; c < 0x800; c++)
+    {
+        tokenizer->lower[c] = c;
+    }
+    for (size_t r = 0; r < sizeof(fold_ranges) / sizeof(fold_ranges[0]); r++)
+    {
+        for (int c = fold_ranges[r].first; c <= fold_ranges[r].last; c += fold_ranges[r].step)
+        {
+            tokenizer->lower[c] = c + fold_ranges[r].offset;
+        }
+    }
+}
+
+// Fills in the nibble tables, returning false if the delimiters use more than 8 high nibbles
+static bool nibbles_create(ioopm_tokenizer_t *tokenizer)
+{
+    int bits = 0;
+
+    for (int high = 0; high < 16; high++)
+    {
+        bool used = false;
+
+        for (int low = 0; low < 16; low++)
+        {
+            used = used || tokenizer->delimiter[high << 4 | low];
+        }
+        if (!used)
+        {
+            continue;
+        }
+        if (bits == 8)
+        {
+            return false;
+        }
+
+        tokenizer->high_nibble[high] = 1 << bits;
+        for (int low = 0; low < 16; low++)
+        {
+            if (tokenizer->delimiter[high << 4 | low])
+            {
+                tokenizer->low_nibble[low] |= 1 << bits;
+            }
+        }
+        bits++;
+    }
+    return true;
+}
+
+ioopm_tokenizer_t *ioopm_tokenizer_create_using(const char *delimiters, const char *kind)
+{
+    ioopm_tokenizer_t *tokenizer = calloc(1, sizeof(ioopm_tokenizer_t));
+
+    tokenizer->delimiter['\0'] = true;
+    for (const unsigned char *c = (const unsigned char *) delimiters; *c != '\0'; c++)
+    {
+        tokenizer->delimiter[*c] = true;
+    }
+
+    tokenizer->kind = "scalar";
+    tokenizer->tokenize = tokenize_scalar;
+    tokenizer->fold = fold_scalar;
+#if Has_x86_simd
+    bool fits_nibbles = nibbles_create(tokenizer);
+    bool any = kind == NULL;
+
+    __builtin_cpu_init();
+    if (fits_nibbles && (any || strcmp(kind, "avx2") == 0) && __builtin_cpu_supports("avx2"))
+    {
+        tokenizer->kind = "avx2";
+        tokenizer->tokenize = tokenize_avx2;
+        tokenizer->fold = fold_avx2;
+    }
+    else if (fits_nibbles && (any || strcmp(kind, "ssse3") == 0) && __builtin_cpu_supports("ssse3"))
+    {
+        tokenizer->kind = "ssse3";
+        tokenizer->tokenize = tokenize_ssse3;
+        tokenizer->fold = fold_ssse3;
+    }
+#endif
+
+    if (kind != NULL && strcmp(kind, tokenizer->kind) != 0)
+    {
+        free(tokenizer);
+        return NULL;
+    }
+    return tokenizer;
+}
+
+ioopm_tokenizer_t *ioopm_tokenizer_create(const char *delimiters)
+{
+    return ioopm_tokenizer_create_using(delimiters, NULL);
+}
+
+ioopm_tokenizer_t *ioopm_tokenizer_create_normalizing(const char *delimiters, const char *kind)
+{
+    // folding must not change which bytes are delimiters, and a delimiter must never be
+    // part of a character
+    for (const unsigned char *c = (const unsigned char *) delimiters; *c != '\0'; c++)
+    {
+        if (*c >= 0x80 || (*c >= 'A' && *c <= 'Z') || (*c >= 'a' && *c <= 'z'))
+        {
+            return NULL;
+        }
+    }
+
+    ioopm_tokenizer_t *tokenizer = ioopm_tokenizer_create_using(delimiters, kind);
+
+    if (tokenizer != NULL)
+    {
+        tokenizer->normalize = true;
+        lower_table_create(tokenizer);
+    }
+    return tokenizer;
+}
+
+bool ioopm_tokenizer_normalizes(ioopm_tokenizer_t *tokenizer)
+{
+    return tokenizer->normalize;
+}
+
+void ioopm_tokenizer_destroy(ioopm_tokenizer_t *tokenizer)
+{
+    free(tokenizer);
+}
+
+const char *ioopm_tokenizer_kind(ioopm_tokenizer_t *tokenizer)
+{
+    return tokenizer->kind;
+}
+
+bool ioopm_tokenizer_is_delimiter(ioopm_tokenizer_t *tokenizer, char c)
+{
+    return tokenizer->delimiter[(unsigned char) c];
+}
+
+size_t ioopm_tokenize(ioopm_tokenizer_t *tokenizer, const char *text, size_t length, ioopm_word_function fun, void *extra)
+{
+    if (tokenizer->normalize)
+    {
+        return tokenize_normalized(tokenizer, text, length, fun, extra);
+    }
+    return tokenizer->tokenize(tokenizer, text, length, fun, extra);
+}
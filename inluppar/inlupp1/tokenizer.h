@@ -0,0 +1,80 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file tokenizer.h
+ * @author Tuva Björnberg & Gustav Fridén
+ * @date 29/09-2023
+ * @brief Splits text into words (`tokenizer_t`) without changing the text.
+ *
+ * Words are the longest runs of bytes that are not delimiters. Every word is passed on
+ * as a pointer into the text and a length, so the text does not need to be writable or
+ * end with '\0', and it can be a file mapped into memory.
+ *
+ * The text is classified 32 or 16 bytes at a time with AVX2 or SSSE3 when the processor
+ * has them, checked when the tokenizer is created, and one byte at a time otherwise. The
+ * vector versions look up the two halves of each byte in 16 entry tables, which works for
+ * any set of delimiters that spans at most 8 different values of the upper half.
+ *
+ * The '\0' byte always separates words, so a word never holds one.
+ *
+ * A normalizing tokenizer also folds the words to lower case and makes them valid UTF-8,
+ * so that "The" and "the" are the same word. Each chunk of text is copied to a buffer and
+ * folded there while it is still in the cache: runs of ASCII 16 or 32 bytes at a time,
+ * like the delimiters, and other characters one at a time through a table of the lower
+ * case of letters with two byte encodings (Latin, Greek, Cyrillic and Armenian). Longer
+ * characters are kept as they are and every byte that is not part of valid UTF-8 is
+ * replaced with U+FFFD. The words then point into that buffer instead of the text.
+ */
+
+typedef struct tokenizer ioopm_tokenizer_t;
+
+typedef void(*ioopm_word_function)(const char *word, size_t length, void *extra);
+
+/// @brief Creates a tokenizer for a set of delimiters
+/// @param delimiters the characters separating words, like the second argument of strtok
+/// @return a new tokenizer
+ioopm_tokenizer_t *ioopm_tokenizer_create(const char *delimiters);
+
+/// @brief Creates a tokenizer using a given implementation, mainly for testing
+/// @param delimiters the characters separating words, like the second argument of strtok
+/// @param kind "avx2", "ssse3" or "scalar", or NULL for the fastest one available
+/// @return a new tokenizer, or NULL if kind cannot be used on this processor or for these delimiters
+ioopm_tokenizer_t *ioopm_tokenizer_create_using(const char *delimiters, const char *kind);
+
+/// @brief Creates a tokenizer that folds words to lower case and replaces invalid UTF-8
+/// @param delimiters the characters separating words, which must be ASCII and not letters
+/// @param kind "avx2", "ssse3" or "scalar", or NULL for the fastest one available
+/// @return a new tokenizer, or NULL if kind cannot be used or the delimiters are not allowed
+ioopm_tokenizer_t *ioopm_tokenizer_create_normalizing(const char *delimiters, const char *kind);
+
+/// @brief Return the memory of a tokenizer
+/// @param tokenizer the tokenizer to be destroyed
+void ioopm_tokenizer_destroy(ioopm_tokenizer_t *tokenizer);
+
+/// @brief The implementation used by a tokenizer
+/// @param tokenizer the tokenizer
+/// @return "avx2", "ssse3" or "scalar"
+const char *ioopm_tokenizer_kind(ioopm_tokenizer_t *tokenizer);
+
+/// @brief Check if a tokenizer normalizes words
+/// @param tokenizer the tokenizer
+/// @return true if it was created with ioopm_tokenizer_create_normalizing
+bool ioopm_tokenizer_normalizes(ioopm_tokenizer_t *tokenizer);
+
+/// @brief Check if a character separates words
+/// @param tokenizer the tokenizer
+/// @param c the character
+/// @return true if c is a delimiter
+bool ioopm_tokenizer_is_delimiter(ioopm_tokenizer_t *tokenizer, char c);
+
+/// @brief Call a function for every word in a text, in order
+/// @param tokenizer the tokenizer
+/// @param text the text, which need not end with '\0'
+/// @param length the number of bytes in text
+/// @param fun the function called with the start and length of each word, which for a
+/// normalizing tokenizer is only valid during the call
+/// @param extra an additional argument (may be NULL) that will be passed to all calls of fun
+/// @return the number of words
+size_t ioopm_tokenize(ioopm_tokenizer_t *tokenizer, const char *text, size_t length, ioopm_word_function fun, void *extra);
@@ -0,0 +1,358 @@
+#include <CUnit/Basic.h>
+#include "tokenizer.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define Delimiters "+-#@()[]{}.,:;!? \t\n\r"
+#define Max_Words 4096
+#define Random_Length 20000
+
+int init_suite(void)
+{
+    return 0;
+}
+
+int clean_suite(void)
+{
+    return 0;
+}
+
+typedef struct words words_t;
+
+struct words
+{
+    char *found[Max_Words];
+    size_t count;
+};
+
+static void collect_word(const char *word, size_t length, void *extra)
+{
+    words_t *words = extra;
+
+    if (words->count < Max_Words)
+    {
+        words->found[words->count] = strndup(word, length);
+    }
+    words->count++;
+}
+
+static void words_clear(words_t *words)
+{
+    for (size_t i = 0; i < words->count && i < Max_Words; i++)
+    {
+        free(words->found[i]);
+    }
+    words->count = 0;
+}
+
+static char *kinds[] = {"scalar", "ssse3", "avx2"};
+
+// Runs check on a tokenizer of every kind this processor supports
+static void for_each_kind(const char *delimiters, void (*check)(ioopm_tokenizer_t *tokenizer))
+{
+    for (int i = 0; i < 3; i++)
+    {
+        ioopm_tokenizer_t *tokenizer = ioopm_tokenizer_create_using(delimiters, kinds[i]);
+
+        if (tokenizer != NULL)
+        {
+            CU_ASSERT_STRING_EQUAL(ioopm_tokenizer_kind(tokenizer), kinds[i]);
+            check(tokenizer);
+            ioopm_tokenizer_destroy(tokenizer);
+        }
+    }
+}
+
+// Checks that text holds exactly the expected words
+static void check_words(ioopm_tokenizer_t *tokenizer, const char *text, size_t length, char *expected[], size_t expected_count)
+{
+    words_t words = {.count = 0};
+
+    CU_ASSERT_EQUAL(ioopm_tokenize(tokenizer, text, length, collect_word, &words), expected_count);
+    CU_ASSERT_EQUAL(words.count, expected_count);
+    for (size_t i = 0; i < expected_count && i < words.count; i++)
+    {
+        CU_ASSERT_STRING_EQUAL(words.found[i], expected[i]);
+    }
+    words_clear(&words);
+}
+
+static void check_simple(ioopm_tokenizer_t *tokenizer)
+{
+    char *text = "Hello, world! (this) is-a [test]";
+    char *expected[] = {"Hello", "world", "this", "is", "a", "test"};
+
+    check_words(tokenizer, text, strlen(text), expected, 6);
+    check_words(tokenizer, "", 0, NULL, 0);
+    check_words(tokenizer, " \t\n.,;", 6, NULL, 0);
+
+    char *single[] = {"word"};
+    check_words(tokenizer, "word", 4, single, 1);
+    check_words(tokenizer, "\n\nword\r\n", 8, single, 1);
+
+    CU_ASSERT_TRUE(ioopm_tokenizer_is_delimiter(tokenizer, ' '));
+    CU_ASSERT_TRUE(ioopm_tokenizer_is_delimiter(tokenizer, '\0'));
+    CU_ASSERT_FALSE(ioopm_tokenizer_is_delimiter(tokenizer, 'a'));
+    CU_ASSERT_FALSE(ioopm_tokenizer_is_delimiter(tokenizer, '\xc3'));
+}
+
+void test_tokenize_simple()
+{
+    for_each_kind(Delimiters, check_simple);
+}
+
+static void check_slices(ioopm_tokenizer_t *tokenizer)
+{
+    // the text need not end with '\0' and is not changed
+    char text[] = {'a', 'b', ' ', 'c', 'd', 'e', 'f'};
+    char *expected[] = {"ab", "cd"};
+    check_words(tokenizer, text, 5, expected, 2);
+    CU_ASSERT_EQUAL(text[2], ' ');
+
+    // '\0' separates words, bytes outside ASCII belong to words
+    char *with_nul[] = {"one", "two", "r\xc3\xa4ksm\xc3\xb6rg\xc3\xa5s"};
+    check_words(tokenizer, "one\0two r\xc3\xa4ksm\xc3\xb6rg\xc3\xa5s", 21, with_nul, 3);
+
+    // words crossing and filling whole blocks of 16 and 32 bytes
+    char *long_words[] = {"abcdefghijklmnopqrstuvwxyz0123456789", "x", "ABCDEFGHIJKLMNOP"};
+    check_words(tokenizer, "abcdefghijklmnopqrstuvwxyz0123456789 x...............ABCDEFGHIJKLMNOP", 70, long_words, 3);
+}
+
+void test_tokenize_slices()
+{
+    for_each_kind(Delimiters, check_slices);
+}
+
+static void check_like_strtok(ioopm_tokenizer_t *tokenizer)
+{
+    char alphabet[] = "ab\xc3\xa5Z09" Delimiters;
+    char *text = calloc(Random_Length + 1, 1);
+    words_t words = {.count = 0};
+
+    srand(42);
+    for (int i = 0; i < Random_Length; i++)
+    {
+        text[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+    }
+
+    ioopm_tokenize(tokenizer, text, Random_Length, collect_word, &words);
+
+    size_t matching = 0;
+    size_t i = 0;
+    for (char *word = strtok(text, Delimiters); word; word = strtok(NULL, Delimiters), i++)
+    {
+        matching += i < words.count && i < Max_Words && strcmp(word, words.found[i]) == 0;
+    }
+    CU_ASSERT_EQUAL(words.count, i);
+    CU_ASSERT_EQUAL(matching, i < Max_Words ? i : Max_Words);
+
+    words_clear(&words);
+    free(text);
+}
+
+void test_tokenize_like_strtok()
+{
+    for_each_kind(Delimiters, check_like_strtok);
+}
+
+static void count_word(const char *word, size_t length, void *extra)
+{
+    *(size_t *) extra += length;
+}
+
+void test_tokenize_kinds_agree()
+{
+    ioopm_tokenizer_t *best = ioopm_tokenizer_create(Delimiters);
+    ioopm_tokenizer_t *scalar = ioopm_tokenizer_create_using(Delimiters, "scalar");
+    char text[100];
+
+    CU_ASSERT_PTR_NOT_NULL(scalar);
+
+    // every length around the block sizes, with short and long words
+    srand(7);
+    bool agree = true;
+    for (size_t length = 0; length <= sizeof(text); length++)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            text[i] = rand() % 4 == 0 ? " .\n"[rand() % 3] : 'a' + rand() % 26;
+        }
+
+        size_t best_letters = 0;
+        size_t scalar_letters = 0;
+        size_t best_words = ioopm_tokenize(best, text, length, count_word, &best_letters);
+        size_t scalar_words = ioopm_tokenize(scalar, text, length, count_word, &scalar_letters);
+        agree = agree && best_words == scalar_words && best_letters == scalar_letters;
+    }
+    CU_ASSERT_TRUE(agree);
+
+    ioopm_tokenizer_destroy(scalar);
+    ioopm_tokenizer_destroy(best);
+
+    // delimiters spread over more than 8 upper halves only work one byte at a time
+    ioopm_tokenizer_t *spread = ioopm_tokenizer_create("\x0f\x1f\x2f\x3f\x4f\x5f\x6f\x7f\x8f");
+    CU_ASSERT_STRING_EQUAL(ioopm_tokenizer_kind(spread), "scalar");
+    CU_ASSERT_PTR_NULL(ioopm_tokenizer_create_using("\x0f\x1f\x2f\x3f\x4f\x5f\x6f\x7f\x8f", "avx2"));
+
+    char *expected[] = {"a", "b\x82"};
+    check_words(spread, "a\x8f" "b\x82", 4, expected, 2);
+    ioopm_tokenizer_destroy(spread);
+}
+
+// Runs check on a normalizing tokenizer of every kind this processor supports
+static void for_each_normalizing_kind(const char *delimiters, void (*check)(ioopm_tokenizer_t *tokenizer))
+{
+    for (int i = 0; i < 3; i++)
+    {
+        ioopm_tokenizer_t *tokenizer = ioopm_tokenizer_create_normalizing(delimiters, kinds[i]);
+
+        if (tokenizer != NULL)
+        {
+            CU_ASSERT_TRUE(ioopm_tokenizer_normalizes(tokenizer));
+            check(tokenizer);
+            ioopm_tokenizer_destroy(tokenizer);
+        }
+    }
+}
+
+static void check_folding(ioopm_tokenizer_t *tokenizer)
+{
+    char *text = "The THE tHe, R\xc3\x84KSM\xc3\x96RG\xc3\x85S \xce\x9a\xce\x91\xce\x8c\xce\xa3 \xd0\x9f\xd0\xa0\xd0\x98\xd0\x92\xd0\x95\xd0\xa2 \xc5\xb8 \xf0\x9f\x98\x80X";
+    char *expected[] = {"the", "the", "the", "r\xc3\xa4ksm\xc3\xb6rg\xc3\xa5s", "\xce\xba\xce\xb1\xcf\x8c\xcf\x83",
+                        "\xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82", "\xc3\xbf", "\xf0\x9f\x98\x80x"};
+
+    check_words(tokenizer, text, strlen(text), expected, 8);
+
+    // letters whose lower case takes more bytes, and lower case letters, are kept
+    char *kept[] = {"\xc4\xb0", "\xc3\x9f\xc3\xa4"};
+    check_words(tokenizer, "\xc4\xb0 \xc3\x9f\xc3\xa4", 7, kept, 2);
+}
+
+void test_tokenize_folding()
+{
+    for_each_normalizing_kind(Delimiters, check_folding);
+}
+
+static void check_invalid_utf8(ioopm_tokenizer_t *tokenizer)
+{
+    // a stray continuation byte, a cut off character, an overlong encoding, a surrogate,
+    // a code point above U+10FFFF and a character cut off by the end of the text
+    char *text = "a\x80" "b c\xc3 d\xc0\xaf e\xed\xa0\x80 f\xf4\x90\x80\x80 g\xe2\x82";
+    char *expected[] = {"a\xef\xbf\xbd" "b", "c\xef\xbf\xbd", "d\xef\xbf\xbd\xef\xbf\xbd",
+                        "e\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd",
+                        "f\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd", "g\xef\xbf\xbd\xef\xbf\xbd"};
+
+    check_words(tokenizer, text, strlen(text), expected, 6);
+}
+
+void test_tokenize_invalid_utf8()
+{
+    for_each_normalizing_kind(Delimiters, check_invalid_utf8);
+
+    // delimiters that folding could change, or that could be part of a character
+    CU_ASSERT_PTR_NULL(ioopm_tokenizer_create_normalizing(" a", NULL));
+    CU_ASSERT_PTR_NULL(ioopm_tokenizer_create_normalizing(" Q", NULL));
+    CU_ASSERT_PTR_NULL(ioopm_tokenizer_create_normalizing(" \xa0", NULL));
+
+    ioopm_tokenizer_t *plain = ioopm_tokenizer_create(Delimiters);
+    CU_ASSERT_FALSE(ioopm_tokenizer_normalizes(plain));
+    ioopm_tokenizer_destroy(plain);
+}
+
+// Hashes the words in order, so that the words of two tokenizers can be compared
+static void hash_words(const char *word, size_t length, void *extra)
+{
+    *(size_t *) extra += length;
+    for (size_t i = 0; i < length; i++)
+    {
+        *(size_t *) extra = *(size_t *) extra * 31 + (unsigned char) word[i];
+    }
+}
+
+void test_normalizing_kinds_agree()
+{
+    // mixed ASCII, two and three byte characters and invalid bytes, in texts longer than
+    // a chunk so that words cross the chunks
+    char alphabet[] = "aZ \xc3\x85\xc3\xa5\xd0\x9f\xe2\x82\xac\xff.";
+    size_t length = 100000;
+    char *text = calloc(length, 1);
+    ioopm_tokenizer_t *scalar = ioopm_tokenizer_create_normalizing(Delimiters, "scalar");
+    ioopm_tokenizer_t *best = ioopm_tokenizer_create_normalizing(Delimiters, NULL);
+
+    srand(11);
+    for (size_t i = 0; i < length; i++)
+    {
+        text[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+    }
+    // a word longer than a chunk
+    memset(text + 40000, 'Q', 30000);
+
+    bool agree = true;
+    for (size_t end = length - 40; end <= length; end++)
+    {
+        size_t scalar_hash = 0;
+        size_t best_hash = 0;
+        size_t scalar_words = ioopm_tokenize(scalar, text, end, hash_words, &scalar_hash);
+        size_t best_words = ioopm_tokenize(best, text, end, hash_words, &best_hash);
+        agree = agree && scalar_words == best_words && scalar_hash == best_hash;
+    }
+    CU_ASSERT_TRUE(agree);
+
+    words_t words = {.count = 0};
+    ioopm_tokenize(scalar, text + 39990, 30020, collect_word, &words);
+    CU_ASSERT_TRUE(words.count >= 1);
+    CU_ASSERT_TRUE(strspn(words.found[words.count > 1 ? 1 : 0], "q") >= 30000);
+    words_clear(&words);
+
+    ioopm_tokenizer_destroy(best);
+    ioopm_tokenizer_destroy(scalar);
+    free(text);
+}
+
+int main()
+{
+    // First we try to set up CUnit, and exit if we fail
+    if (CU_initialize_registry() != CUE_SUCCESS)
+        return CU_get_error();
+
+    // We then create an empty test suite and specify the name and
+    // the init and cleanup functions
+    CU_pSuite my_test_suite = CU_add_suite("Tests for tokenizer.c", init_suite, clean_suite);
+    if (my_test_suite == NULL)
+    {
+        // If the test suite could not be added, tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // This is where we add the test functions to our test suite.
+    // For each call to CU_add_test we specify the test suite, the
+    // name or description of the test, and the function that runs
+    // the test in question. If you want to add another test, just
+    // copy a line below and change the information
+    if (
+        (CU_add_test(my_test_suite, "Split a text into words", test_tokenize_simple) == NULL ||
+         CU_add_test(my_test_suite, "Words are slices of an unchanged text", test_tokenize_slices) == NULL ||
+         CU_add_test(my_test_suite, "Same words as strtok on a random text", test_tokenize_like_strtok) == NULL ||
+         CU_add_test(my_test_suite, "Vector and byte at a time tokenizers agree", test_tokenize_kinds_agree) == NULL ||
+         CU_add_test(my_test_suite, "Fold words to lower case", test_tokenize_folding) == NULL ||
+         CU_add_test(my_test_suite, "Replace invalid UTF-8", test_tokenize_invalid_utf8) == NULL ||
+         CU_add_test(my_test_suite, "Vector and byte at a time folding agree", test_normalizing_kinds_agree) == NULL))
+    {
+        // If adding any of the tests fails, we tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Set the running mode. Use CU_BRM_VERBOSE for maximum output.
+    // Use CU_BRM_NORMAL to only print errors and a summary
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+
+    // This is where the tests are actually run!
+    CU_basic_run_tests();
+
+    // Tear down CUnit before exiting
+    CU_cleanup_registry();
+    return CU_get_error();
+}
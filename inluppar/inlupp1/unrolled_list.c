@@ -0,0 +1,943 @@
+#include <stdlib.h>
+#include "linked_list.h"
+#include "iterator.h"
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+/// Unrolled backend for linked_list.h, link with unrolled_list.o instead of linked_list.o.
+/// Every chunk holds up to CHUNK_CAPACITY elements next to each other, so a chunk
+/// together with its header fills two cache lines on a 64-bit machine.
+#define CHUNK_CAPACITY 13
+#define CHUNK_MIN_FILL (CHUNK_CAPACITY / 2)
+
+/// Lists with at least SKIP_MIN_SIZE elements get an index of where every chunk starts,
+/// used when a lookup by index is more than SKIP_DISTANCE elements from any known chunk.
+#define SKIP_DISTANCE 32
+#define SKIP_MIN_SIZE 128
+
+typedef struct chunk chunk_t;
+typedef struct skip skip_t;
+
+struct chunk
+{
+    chunk_t *prev;
+    chunk_t *next;
+    int count; // number of used slots in values, never 0 for a chunk in a list
+    elem_t values[CHUNK_CAPACITY];
+};
+
+struct skip
+{
+    chunk_t *chunk;
+    int start; // index of the first element in chunk
+};
+
+struct list
+{
+    chunk_t *first;
+    chunk_t *last;
+    size_t size;
+    ioopm_eq_function eq_fun;
+    chunk_t *cursor;      // last chunk found by index, NULL when unknown
+    int cursor_start;     // index of the first element in cursor
+    skip_t *skips;        // the chunks in order with their start indices
+    size_t skip_count;    // number of valid entries in skips, 0 after the list has changed
+    size_t skip_capacity;
+    size_t skip_size;     // size of the list when skips was built
+};
+
+struct iter
+{
+    chunk_t *chunk; // NULL when positioned after the last element (before the first if reversed)
+    int index;      // index of the current element in chunk
+    bool reversed;  // true if next moves towards the first element
+    ioopm_list_t *list;
+};
+
+ioopm_list_t *ioopm_linked_list_create(ioopm_eq_function eq_fun)
+{
+    ioopm_list_t *list = calloc(1, sizeof(struct list));
+    list->eq_fun = eq_fun;
+    return list;
+}
+
+void ioopm_linked_list_destroy(ioopm_list_t *list)
+{
+    if (!ioopm_linked_list_is_empty(list))
+    {
+        ioopm_linked_list_clear(list);
+    }
+    free(list->skips);
+    free(list);
+}
+
+// Creates an empty chunk between prev and next, where either may be NULL for the ends
+static chunk_t *chunk_insert(ioopm_list_t *list, chunk_t *prev, chunk_t *next)
+{
+    chunk_t *new_chunk = calloc(1, sizeof(chunk_t));
+    new_chunk->prev = prev;
+    new_chunk->next = next;
+
+    if (prev == NULL)
+    {
+        list->first = new_chunk;
+    }
+    else
+    {
+        prev->next = new_chunk;
+    }
+
+    if (next == NULL)
+    {
+        list->last = new_chunk;
+    }
+    else
+    {
+        next->prev = new_chunk;
+    }
+
+    return new_chunk;
+}
+
+static void chunk_unlink(ioopm_list_t *list, chunk_t *chunk)
+{
+    list->skip_count = 0;
+    if (list->cursor == chunk)
+    {
+        list->cursor = NULL;
+    }
+
+    if (chunk->prev == NULL)
+    {
+        list->first = chunk->next;
+    }
+    else
+    {
+        chunk->prev->next = chunk->next;
+    }
+
+    if (chunk->next == NULL)
+    {
+        list->last = chunk->prev;
+    }
+    else
+    {
+        chunk->next->prev = chunk->prev;
+    }
+
+    free(chunk);
+}
+
+static void skip_index_build(ioopm_list_t *list)
+{
+    size_t count = 0;
+
+    for (chunk_t *current = list->first; current != NULL; current = current->next)
+    {
+        count++;
+    }
+
+    if (count > list->skip_capacity)
+    {
+        list->skips = realloc(list->skips, count * sizeof(skip_t));
+        list->skip_capacity = count;
+    }
+
+    int start = 0;
+    chunk_t *current = list->first;
+    for (size_t i = 0; i < count; i++)
+    {
+        list->skips[i] = (skip_t){.chunk = current, .start = start};
+        start += current->count;
+        current = current->next;
+    }
+
+    list->skip_count = count;
+    list->skip_size = list->size;
+}
+
+// Binary search for the last chunk in the skip index starting at or before index
+static skip_t *skip_index_find(ioopm_list_t *list, int index)
+{
+    size_t low = 0;
+    size_t high = list->skip_count;
+
+    while (high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+
+        if (list->skips[middle].start <= index)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return &list->skips[low];
+}
+
+// Keeps the cursor and the skip index correct when an element is added to (delta 1) or
+// removed from (delta -1) chunk. Only changes to the last chunk keep every start index.
+static void index_cache_update(ioopm_list_t *list, chunk_t *chunk, int delta)
+{
+    if (chunk == list->last)
+    {
+        return;
+    }
+
+    list->skip_count = 0;
+    if (list->cursor != NULL && list->cursor != chunk)
+    {
+        if (chunk == list->first)
+        {
+            list->cursor_start += delta;
+        }
+        else
+        {
+            list->cursor = NULL;
+        }
+    }
+}
+
+// Finds the chunk holding the element at a valid index and the position of the element
+// in it. The walk starts from the closest of the first chunk, the last chunk and the chunk
+// found by the previous lookup, so looking up consecutive indices takes O(1) time each.
+// Long jumps on long lists start from the skip index.
+static chunk_t *chunk_for_index(ioopm_list_t *list, int index, int *pos)
+{
+    int size = list->size;
+    chunk_t *current = list->first;
+    int start = 0;
+
+    if (size - list->last->count - index < index)
+    {
+        current = list->last;
+        start = size - list->last->count;
+    }
+
+    if (list->cursor != NULL && abs(index - list->cursor_start) < abs(index - start))
+    {
+        current = list->cursor;
+        start = list->cursor_start;
+    }
+
+    if (abs(index - start) > SKIP_DISTANCE && size >= SKIP_MIN_SIZE)
+    {
+        if (list->skip_count == 0 || index >= list->skip_size)
+        {
+            skip_index_build(list);
+        }
+
+        skip_t *skip = skip_index_find(list, index);
+        current = skip->chunk;
+        start = skip->start;
+    }
+
+    while (index >= start + current->count)
+    {
+        start += current->count;
+        current = current->next;
+    }
+    while (index < start)
+    {
+        current = current->prev;
+        start -= current->count;
+    }
+
+    list->cursor = current;
+    list->cursor_start = start;
+    *pos = index - start;
+    return current;
+}
+
+// Moves the upper half of a full chunk into a new chunk placed after it
+static void chunk_split(ioopm_list_t *list, chunk_t *chunk)
+{
+    chunk_t *new_chunk = chunk_insert(list, chunk, chunk->next);
+    int keep = chunk->count / 2;
+
+    new_chunk->count = chunk->count - keep;
+    memcpy(new_chunk->values, chunk->values + keep, new_chunk->count * sizeof(elem_t));
+    chunk->count = keep;
+}
+
+// Keeps chunks at least half full by merging chunk with its successor when both fit in one chunk
+static void chunk_merge_next(ioopm_list_t *list, chunk_t *chunk)
+{
+    chunk_t *next = chunk->next;
+
+    if (chunk->count >= CHUNK_MIN_FILL || next == NULL || chunk->count + next->count > CHUNK_CAPACITY)
+    {
+        return;
+    }
+
+    memcpy(chunk->values + chunk->count, next->values, next->count * sizeof(elem_t));
+    chunk->count += next->count;
+    chunk_unlink(list, next);
+}
+
+// Inserts value at pos in a chunk with room for it
+static void chunk_insert_at(ioopm_list_t *list, chunk_t *chunk, int pos, elem_t value)
+{
+    memmove(chunk->values + pos + 1, chunk->values + pos, (chunk->count - pos) * sizeof(elem_t));
+    chunk->values[pos] = value;
+    chunk->count++;
+    list->size++;
+    index_cache_update(list, chunk, 1);
+}
+
+// Removes the element at pos in a chunk, returning true if the chunk was emptied and freed
+static bool chunk_remove_at(ioopm_list_t *list, chunk_t *chunk, int pos)
+{
+    memmove(chunk->values + pos, chunk->values + pos + 1, (chunk->count - pos - 1) * sizeof(elem_t));
+    chunk->count--;
+    list->size--;
+    index_cache_update(list, chunk, -1);
+
+    if (chunk->count == 0)
+    {
+        chunk_unlink(list, chunk);
+        return true;
+    }
+
+    chunk_merge_next(list, chunk);
+    return false;
+}
+
+void ioopm_linked_list_append(ioopm_list_t *list, elem_t value)
+{
+    if (list->last == NULL || list->last->count == CHUNK_CAPACITY)
+    {
+        // if empty list or the last chunk is full
+        chunk_insert(list, list->last, NULL);
+    }
+
+    chunk_insert_at(list, list->last, list->last->count, value);
+}
+
+void ioopm_linked_list_prepend(ioopm_list_t *list, elem_t value)
+{
+    if (list->first == NULL || list->first->count == CHUNK_CAPACITY)
+    {
+        // if empty list or the first chunk is full
+        chunk_insert(list, NULL, list->first);
+    }
+
+    chunk_insert_at(list, list->first, 0, value);
+}
+
+void ioopm_linked_list_insert(ioopm_list_t *list, int index, elem_t value)
+{
+    size_t linked_list_size = ioopm_linked_list_size(list);
+
+    if (index < 0 || index > linked_list_size)
+    {
+        return;
+    }
+    else if (index == 0)
+    {
+        ioopm_linked_list_prepend(list, value);
+    }
+    else if (index == linked_list_size)
+    {
+        ioopm_linked_list_append(list, value);
+    }
+    else
+    {
+        int pos;
+        chunk_t *chunk = chunk_for_index(list, index, &pos);
+
+        if (chunk->count == CHUNK_CAPACITY)
+        {
+            chunk_split(list, chunk);
+
+            if (pos > chunk->count)
+            {
+                pos -= chunk->count;
+                chunk = chunk->next;
+            }
+        }
+
+        chunk_insert_at(list, chunk, pos, value);
+    }
+}
+
+void ioopm_linked_list_insert_sorted(ioopm_list_t *list, elem_t value, ioopm_cmp_function cmp_fun)
+{
+    // values not smaller than the last element, as when loading sorted data, are appended directly
+    if (list->last == NULL || cmp_fun(list->last->values[list->last->count - 1], value) <= 0)
+    {
+        ioopm_linked_list_append(list, value);
+        return;
+    }
+
+    // skip whole chunks by their last element
+    chunk_t *chunk = list->first;
+    while (cmp_fun(chunk->values[chunk->count - 1], value) <= 0)
+    {
+        chunk = chunk->next;
+    }
+
+    int pos = 0;
+    while (cmp_fun(chunk->values[pos], value) <= 0)
+    {
+        pos++;
+    }
+
+    if (chunk->count == CHUNK_CAPACITY)
+    {
+        chunk_split(list, chunk);
+
+        if (pos > chunk->count)
+        {
+            pos -= chunk->count;
+            chunk = chunk->next;
+        }
+    }
+
+    chunk_insert_at(list, chunk, pos, value);
+}
+
+elem_t ioopm_linked_list_remove(ioopm_list_t *list, int index)
+{
+    if (list == NULL || index < 0 || index >= ioopm_linked_list_size(list))
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+
+    int pos;
+    chunk_t *chunk = chunk_for_index(list, index, &pos);
+    elem_t value = chunk->values[pos];
+
+    chunk_remove_at(list, chunk, pos);
+    return value;
+}
+
+elem_t ioopm_linked_list_remove_last(ioopm_list_t *list)
+{
+    if (list->last == NULL)
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+
+    chunk_t *last = list->last;
+    elem_t value = last->values[last->count - 1];
+
+    chunk_remove_at(list, last, last->count - 1);
+    return value;
+}
+
+// Moves the elements from pos onwards into a new chunk placed after chunk, 0 < pos < count
+static chunk_t *chunk_cut(ioopm_list_t *list, chunk_t *chunk, int pos)
+{
+    chunk_t *new_chunk = chunk_insert(list, chunk, chunk->next);
+
+    new_chunk->count = chunk->count - pos;
+    memcpy(new_chunk->values, chunk->values + pos, new_chunk->count * sizeof(elem_t));
+    chunk->count = pos;
+    return new_chunk;
+}
+
+// Finds the chunk starting at a valid index, cutting the chunk holding it in two if needed
+static chunk_t *chunk_starting_at(ioopm_list_t *list, int index)
+{
+    int pos;
+    chunk_t *chunk = chunk_for_index(list, index, &pos);
+
+    return pos == 0 ? chunk : chunk_cut(list, chunk, pos);
+}
+
+// Moves the chunks of src between prev and next in list, leaving src empty
+static void chain_insert(ioopm_list_t *list, chunk_t *prev, chunk_t *next, ioopm_list_t *src)
+{
+    src->first->prev = prev;
+    src->last->next = next;
+
+    if (prev == NULL)
+    {
+        list->first = src->first;
+    }
+    else
+    {
+        prev->next = src->first;
+    }
+
+    if (next == NULL)
+    {
+        list->last = src->last;
+    }
+    else
+    {
+        next->prev = src->last;
+    }
+
+    list->size += src->size;
+
+    src->first = NULL;
+    src->last = NULL;
+    src->size = 0;
+    src->cursor = NULL;
+    src->skip_count = 0;
+}
+
+void ioopm_linked_list_concat(ioopm_list_t *list, ioopm_list_t *src)
+{
+    if (list == src || src->first == NULL)
+    {
+        return;
+    }
+
+    // appending keeps the cursor and skip index valid
+    chain_insert(list, list->last, NULL, src);
+}
+
+void ioopm_linked_list_splice(ioopm_list_t *list, int index, ioopm_list_t *src)
+{
+    size_t linked_list_size = ioopm_linked_list_size(list);
+
+    if (list == src || src->first == NULL || index < 0 || index > linked_list_size)
+    {
+        return;
+    }
+    else if (index == linked_list_size)
+    {
+        ioopm_linked_list_concat(list, src);
+        return;
+    }
+
+    chunk_t *next = chunk_starting_at(list, index);
+
+    chain_insert(list, next->prev, next, src);
+    list->cursor = NULL;
+    list->skip_count = 0;
+}
+
+ioopm_list_t *ioopm_linked_list_split_at(ioopm_list_t *list, int index)
+{
+    size_t linked_list_size = ioopm_linked_list_size(list);
+
+    if (index < 0 || index > linked_list_size)
+    {
+        return NULL;
+    }
+
+    ioopm_list_t *rest = ioopm_linked_list_create(list->eq_fun);
+
+    if (index == linked_list_size)
+    {
+        return rest;
+    }
+
+    chunk_t *first = chunk_starting_at(list, index);
+
+    rest->first = first;
+    rest->last = list->last;
+    rest->size = linked_list_size - index;
+
+    list->last = first->prev;
+    if (list->last == NULL)
+    {
+        list->first = NULL;
+    }
+    else
+    {
+        list->last->next = NULL;
+    }
+    first->prev = NULL;
+
+    list->size = index;
+    list->cursor = NULL;
+    list->skip_count = 0;
+
+    return rest;
+}
+
+elem_t ioopm_linked_list_get(ioopm_list_t *list, int index)
+{
+    // if correct index input
+    if (index >= 0 && index < ioopm_linked_list_size(list))
+    {
+        int pos;
+        chunk_t *chunk = chunk_for_index(list, index, &pos);
+
+        return chunk->values[pos];
+    }
+    else
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+}
+
+// Merges the sorted runs from[start, middle) and from[middle, end) into to[start, end),
+// taking from the left run on ties to keep the sort stable
+static void values_merge(elem_t *from, elem_t *to, size_t start, size_t middle, size_t end, ioopm_cmp_function cmp_fun)
+{
+    size_t left = start;
+    size_t right = middle;
+
+    for (size_t i = start; i < end; i++)
+    {
+        if (left < middle && (right == end || cmp_fun(from[right], from[left]) >= 0))
+        {
+            to[i] = from[left++];
+        }
+        else
+        {
+            to[i] = from[right++];
+        }
+    }
+}
+
+void ioopm_linked_list_sort(ioopm_list_t *list, ioopm_cmp_function cmp_fun)
+{
+    size_t size = list->size;
+
+    if (size < 2)
+    {
+        return;
+    }
+
+    // the elements are copied to an array, merge sorted bottom-up between it and a second
+    // array, and written back to the same chunks so the cursor and skip index stay valid
+    elem_t *values = malloc(2 * size * sizeof(elem_t));
+    elem_t *from = values;
+    elem_t *to = values + size;
+    size_t i = 0;
+
+    for (chunk_t *current = list->first; current != NULL; current = current->next)
+    {
+        memcpy(from + i, current->values, current->count * sizeof(elem_t));
+        i += current->count;
+    }
+
+    for (size_t width = 1; width < size; width *= 2)
+    {
+        for (size_t start = 0; start < size; start += 2 * width)
+        {
+            size_t middle = start + width < size ? start + width : size;
+            size_t end = start + 2 * width < size ? start + 2 * width : size;
+            values_merge(from, to, start, middle, end, cmp_fun);
+        }
+
+        elem_t *tmp = from;
+        from = to;
+        to = tmp;
+    }
+
+    i = 0;
+    for (chunk_t *current = list->first; current != NULL; current = current->next)
+    {
+        memcpy(current->values, from + i, current->count * sizeof(elem_t));
+        i += current->count;
+    }
+
+    free(values);
+}
+
+bool ioopm_linked_list_contains(ioopm_list_t *list, elem_t element)
+{
+    for (chunk_t *current = list->first; current != NULL; current = current->next)
+    {
+        for (int i = 0; i < current->count; i++)
+        {
+            if (list->eq_fun(current->values[i], element))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+size_t ioopm_linked_list_size(ioopm_list_t *list)
+{
+    return list->size;
+}
+
+bool ioopm_linked_list_is_empty(ioopm_list_t *list)
+{
+    return list->size == 0;
+}
+
+void ioopm_linked_list_clear(ioopm_list_t *list)
+{
+    chunk_t *current = list->first;
+
+    while (current != NULL)
+    {
+        chunk_t *next = current->next;
+        free(current);
+        current = next;
+    }
+
+    list->first = NULL;
+    list->last = NULL;
+    list->size = 0;
+    list->cursor = NULL;
+    list->skip_count = 0;
+}
+
+bool ioopm_linked_list_all(ioopm_list_t *list, ioopm_int_predicate prop, void *extra)
+{
+    for (chunk_t *current = list->first; current != NULL; current = current->next)
+    {
+        for (int i = 0; i < current->count; i++)
+        {
+            if (!prop(current->values[i], extra))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ioopm_linked_list_any(ioopm_list_t *list, ioopm_int_predicate prop, void *extra)
+{
+    for (chunk_t *current = list->first; current != NULL; current = current->next)
+    {
+        for (int i = 0; i < current->count; i++)
+        {
+            if (prop(current->values[i], extra))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void ioopm_linked_list_apply_to_all(ioopm_list_t *list, ioopm_apply_int_function fun, void *extra)
+{
+    for (chunk_t *current = list->first; current != NULL; current = current->next)
+    {
+        for (int i = 0; i < current->count; i++)
+        {
+            fun(&current->values[i], extra);
+        }
+    }
+}
+
+ioopm_list_iterator_t *ioopm_list_iterator(ioopm_list_t *list)
+{
+    ioopm_list_iterator_t *iter = calloc(1, sizeof(ioopm_list_iterator_t));
+
+    iter->list = list;
+    iter->reversed = false;
+    ioopm_iterator_reset(iter);
+
+    return iter;
+}
+
+ioopm_list_iterator_t *ioopm_list_reverse_iterator(ioopm_list_t *list)
+{
+    ioopm_list_iterator_t *iter = calloc(1, sizeof(ioopm_list_iterator_t));
+
+    iter->list = list;
+    iter->reversed = true;
+    ioopm_iterator_reset(iter);
+
+    return iter;
+}
+
+bool ioopm_iterator_has_next(ioopm_list_iterator_t *iter)
+{
+    if (iter->chunk == NULL)
+    {
+        return false;
+    }
+    else if (iter->reversed)
+    {
+        return iter->index > 0 || iter->chunk->prev != NULL;
+    }
+    else
+    {
+        return iter->index + 1 < iter->chunk->count || iter->chunk->next != NULL;
+    }
+}
+
+// Moves the iterator one element in its direction, or past the end
+static void iterator_step(ioopm_list_iterator_t *iter)
+{
+    if (iter->reversed)
+    {
+        iter->index--;
+
+        if (iter->index < 0)
+        {
+            iter->chunk = iter->chunk->prev;
+            iter->index = iter->chunk != NULL ? iter->chunk->count - 1 : 0;
+        }
+    }
+    else
+    {
+        iter->index++;
+
+        if (iter->index == iter->chunk->count)
+        {
+            iter->chunk = iter->chunk->next;
+            iter->index = 0;
+        }
+    }
+}
+
+elem_t ioopm_iterator_next(ioopm_list_iterator_t *iter)
+{
+    if (!ioopm_iterator_has_next(iter))
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+
+    iterator_step(iter);
+    return iter->chunk->values[iter->index];
+}
+
+void ioopm_iterator_reset(ioopm_list_iterator_t *iter)
+{
+    if (iter->reversed)
+    {
+        iter->chunk = iter->list->last;
+        iter->index = iter->chunk != NULL ? iter->chunk->count - 1 : 0;
+    }
+    else
+    {
+        iter->chunk = iter->list->first;
+        iter->index = 0;
+    }
+}
+
+bool ioopm_iterator_has_current(ioopm_list_iterator_t *iter)
+{
+    return iter->chunk != NULL;
+}
+
+elem_t ioopm_iterator_current(ioopm_list_iterator_t *iter)
+{
+    if (iter->chunk != NULL)
+    {
+        return iter->chunk->values[iter->index];
+    }
+    else
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+}
+
+elem_t ioopm_iterator_set(ioopm_list_iterator_t *iter, elem_t value)
+{
+    if (iter->chunk == NULL)
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+
+    elem_t old_value = iter->chunk->values[iter->index];
+    iter->chunk->values[iter->index] = value;
+    return old_value;
+}
+
+// Inserts value at pos in the chunk of the iterator, where the current element is
+// at iter->index. Splits a full chunk first and follows the current element.
+static void iterator_chunk_insert(ioopm_list_iterator_t *iter, int pos, elem_t value)
+{
+    chunk_t *chunk = iter->chunk;
+
+    if (chunk->count == CHUNK_CAPACITY)
+    {
+        chunk_split(iter->list, chunk);
+        int keep = chunk->count;
+
+        if (iter->index >= keep)
+        {
+            iter->chunk = chunk->next;
+            iter->index -= keep;
+            pos -= keep;
+        }
+    }
+
+    chunk_insert_at(iter->list, iter->chunk, pos, value);
+}
+
+void ioopm_iterator_insert_before(ioopm_list_iterator_t *iter, elem_t value)
+{
+    if (iter->chunk == NULL)
+    {
+        // past the end the iterator walked off
+        if (iter->reversed)
+        {
+            ioopm_linked_list_prepend(iter->list, value);
+        }
+        else
+        {
+            ioopm_linked_list_append(iter->list, value);
+        }
+        return;
+    }
+
+    iterator_chunk_insert(iter, iter->index, value);
+    iter->index++;
+}
+
+void ioopm_iterator_insert_after(ioopm_list_iterator_t *iter, elem_t value)
+{
+    if (iter->chunk == NULL)
+    {
+        ioopm_iterator_insert_before(iter, value);
+        return;
+    }
+
+    iterator_chunk_insert(iter, iter->index + 1, value);
+}
+
+elem_t ioopm_iterator_remove(ioopm_list_iterator_t *iter)
+{
+    chunk_t *chunk = iter->chunk;
+
+    if (chunk == NULL)
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+
+    elem_t value = chunk->values[iter->index];
+    chunk_t *prev = chunk->prev;
+    chunk_t *next = chunk->next;
+
+    if (chunk_remove_at(iter->list, chunk, iter->index))
+    {
+        // the chunk was emptied and freed
+        iter->chunk = iter->reversed ? prev : next;
+        iter->index = iter->reversed && prev != NULL ? prev->count - 1 : 0;
+    }
+    else if (iter->reversed)
+    {
+        // the element before the removed one
+        iter->index--;
+
+        if (iter->index < 0)
+        {
+            iter->chunk = prev;
+            iter->index = prev != NULL ? prev->count - 1 : 0;
+        }
+    }
+    else if (iter->index == chunk->count)
+    {
+        // the removed element was the last one of its chunk
+        iter->chunk = chunk->next;
+        iter->index = 0;
+    }
+
+    return value;
+}
+
+void ioopm_iterator_destroy(ioopm_list_iterator_t *iter)
+{
+    free(iter);
+}
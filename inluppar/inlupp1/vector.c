@@ -0,0 +1,240 @@
+#include <stdlib.h>
+#include "vector.h"
+#include "common.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY 16
+
+struct vector
+{
+    elem_t *values;
+    size_t size;
+    size_t capacity;
+    ioopm_eq_function eq_fun;
+};
+
+struct vector_iter
+{
+    size_t index; // equal to the size of the vector when there is no current element
+    ioopm_vector_t *vector;
+};
+
+ioopm_vector_t *ioopm_vector_create(ioopm_eq_function eq_fun)
+{
+    ioopm_vector_t *vector = calloc(1, sizeof(struct vector));
+    vector->eq_fun = eq_fun;
+    return vector;
+}
+
+void ioopm_vector_destroy(ioopm_vector_t *vector)
+{
+    free(vector->values);
+    free(vector);
+}
+
+// Makes room for at least one more element, doubling the capacity when full
+static void vector_reserve(ioopm_vector_t *vector)
+{
+    if (vector->size < vector->capacity)
+    {
+        return;
+    }
+
+    vector->capacity = vector->capacity == 0 ? INITIAL_CAPACITY : vector->capacity * 2;
+    vector->values = realloc(vector->values, vector->capacity * sizeof(elem_t));
+}
+
+void ioopm_vector_append(ioopm_vector_t *vector, elem_t value)
+{
+    vector_reserve(vector);
+    vector->values[vector->size++] = value;
+}
+
+void ioopm_vector_prepend(ioopm_vector_t *vector, elem_t value)
+{
+    ioopm_vector_insert(vector, 0, value);
+}
+
+void ioopm_vector_insert(ioopm_vector_t *vector, int index, elem_t value)
+{
+    if (index < 0 || index > vector->size)
+    {
+        return;
+    }
+
+    vector_reserve(vector);
+    memmove(vector->values + index + 1, vector->values + index, (vector->size - index) * sizeof(elem_t));
+    vector->values[index] = value;
+    vector->size++;
+}
+
+elem_t ioopm_vector_remove(ioopm_vector_t *vector, int index)
+{
+    if (vector == NULL || index < 0 || index >= vector->size)
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+
+    elem_t value = vector->values[index];
+    memmove(vector->values + index, vector->values + index + 1, (vector->size - index - 1) * sizeof(elem_t));
+    vector->size--;
+    return value;
+}
+
+elem_t ioopm_vector_remove_last(ioopm_vector_t *vector)
+{
+    if (vector->size == 0)
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+
+    return vector->values[--vector->size];
+}
+
+elem_t ioopm_vector_get(ioopm_vector_t *vector, int index)
+{
+    if (index >= 0 && index < vector->size)
+    {
+        return vector->values[index];
+    }
+    else
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+}
+
+elem_t ioopm_vector_set(ioopm_vector_t *vector, int index, elem_t value)
+{
+    if (index < 0 || index >= vector->size)
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+
+    elem_t old_value = vector->values[index];
+    vector->values[index] = value;
+    return old_value;
+}
+
+elem_t *ioopm_vector_data(ioopm_vector_t *vector)
+{
+    return vector->values;
+}
+
+bool ioopm_vector_contains(ioopm_vector_t *vector, elem_t element)
+{
+    for (size_t i = 0; i < vector->size; i++)
+    {
+        if (vector->eq_fun(vector->values[i], element))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t ioopm_vector_size(ioopm_vector_t *vector)
+{
+    return vector->size;
+}
+
+bool ioopm_vector_is_empty(ioopm_vector_t *vector)
+{
+    return vector->size == 0;
+}
+
+void ioopm_vector_clear(ioopm_vector_t *vector)
+{
+    vector->size = 0;
+}
+
+bool ioopm_vector_all(ioopm_vector_t *vector, ioopm_int_predicate prop, void *extra)
+{
+    for (size_t i = 0; i < vector->size; i++)
+    {
+        if (!prop(vector->values[i], extra))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ioopm_vector_any(ioopm_vector_t *vector, ioopm_int_predicate prop, void *extra)
+{
+    for (size_t i = 0; i < vector->size; i++)
+    {
+        if (prop(vector->values[i], extra))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ioopm_vector_apply_to_all(ioopm_vector_t *vector, ioopm_apply_int_function fun, void *extra)
+{
+    for (size_t i = 0; i < vector->size; i++)
+    {
+        fun(&vector->values[i], extra);
+    }
+}
+
+ioopm_vector_iterator_t *ioopm_vector_iterator(ioopm_vector_t *vector)
+{
+    ioopm_vector_iterator_t *iter = calloc(1, sizeof(ioopm_vector_iterator_t));
+
+    iter->vector = vector;
+    iter->index = 0;
+
+    return iter;
+}
+
+bool ioopm_vector_iterator_has_next(ioopm_vector_iterator_t *iter)
+{
+    return iter->index + 1 < iter->vector->size;
+}
+
+elem_t ioopm_vector_iterator_next(ioopm_vector_iterator_t *iter)
+{
+    if (!ioopm_vector_iterator_has_next(iter))
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+
+    return iter->vector->values[++iter->index];
+}
+
+void ioopm_vector_iterator_reset(ioopm_vector_iterator_t *iter)
+{
+    iter->index = 0;
+}
+
+bool ioopm_vector_iterator_has_current(ioopm_vector_iterator_t *iter)
+{
+    return iter->index < iter->vector->size;
+}
+
+elem_t ioopm_vector_iterator_current(ioopm_vector_iterator_t *iter)
+{
+    return ioopm_vector_get(iter->vector, iter->index);
+}
+
+elem_t ioopm_vector_iterator_set(ioopm_vector_iterator_t *iter, elem_t value)
+{
+    return ioopm_vector_set(iter->vector, iter->index, value);
+}
+
+elem_t ioopm_vector_iterator_remove(ioopm_vector_iterator_t *iter)
+{
+    // the next element moves into the position of the removed one
+    return ioopm_vector_remove(iter->vector, iter->index);
+}
+
+void ioopm_vector_iterator_destroy(ioopm_vector_iterator_t *iter)
+{
+    free(iter);
+}
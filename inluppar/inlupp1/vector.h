@@ -0,0 +1,178 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include "common.h"
+#include "linked_list.h"
+
+#define ioopm_int_vector_append(vector, value) ioopm_vector_append(vector, int_elem(value))
+#define ioopm_int_vector_prepend(vector, value) ioopm_vector_prepend(vector, int_elem(value))
+#define ioopm_int_vector_insert(vector, index, value) ioopm_vector_insert(vector, index, int_elem(value))
+
+/**
+ * @file vector.h
+ * @author Tuva Björnberg & Gustav Fridén
+ * @date 29/09-2023
+ * @brief A growable array (`vector_t`) with the same operations as the linked list.
+ *
+ * The elements are stored next to each other in one heap allocated array that doubles
+ * in capacity when it is full. Appending is amortized O(1), get and set are O(1) and
+ * inserting or removing elsewhere moves the elements after the index with memmove.
+ *
+ * The vector assumes a suitable equality function to fit the ioopm_eq_function in common.h
+ *
+ * It is also assumed that the user ensures proper memory management when using the
+ * vector, including freeing the memory allocated for elements.
+ *
+ * In certain edge-cases functions will return void pointer to NULL if either imput-value is invalid or
+ * have reach a NULL element. Which functions with this behavior is mentioned below.
+ */
+
+typedef struct vector ioopm_vector_t;
+typedef struct vector_iter ioopm_vector_iterator_t;
+
+/// @brief Creates a new empty vector
+/// @param eq_fun the equality function used by ioopm_vector_contains
+/// @return an empty vector
+ioopm_vector_t *ioopm_vector_create(ioopm_eq_function eq_fun);
+
+/// @brief Tear down the vector and return all its memory (but not the memory of the elements)
+/// @param vector the vector to be destroyed
+void ioopm_vector_destroy(ioopm_vector_t *vector);
+
+/// @brief Insert at the end of a vector in amortized O(1) time
+/// @param vector the vector that will be extended
+/// @param value the value to be appended
+void ioopm_vector_append(ioopm_vector_t *vector, elem_t value);
+
+/// @brief Insert at the front of a vector in O(n) time
+/// @param vector the vector that will be extended
+/// @param value the value to be prepended
+void ioopm_vector_prepend(ioopm_vector_t *vector, elem_t value);
+
+/// @brief Insert an element into a vector in O(n) time.
+/// The valid values of index are [0,n] for a vector of n elements,
+/// where 0 means before the first element and n means after
+/// the last element.
+/// @param vector the vector that will be extended
+/// @param index the position in the vector
+/// @param value the value to be inserted
+void ioopm_vector_insert(ioopm_vector_t *vector, int index, elem_t value);
+
+/// @brief Remove an element from a vector in O(n) time.
+/// The valid values of index are [0,n-1] for a vector of n elements,
+/// where 0 means the first element and n-1 means the last element.
+/// @param vector the vector
+/// @param index the position in the vector
+/// @return the value removed or a void pointer to NULL if invalid index
+elem_t ioopm_vector_remove(ioopm_vector_t *vector, int index);
+
+/// @brief Remove the last element from a vector in O(1) time.
+/// @param vector the vector
+/// @return the value removed or a void pointer to NULL if the vector is empty
+elem_t ioopm_vector_remove_last(ioopm_vector_t *vector);
+
+/// @brief Retrieve an element from a vector in O(1) time.
+/// @param vector the vector
+/// @param index the position in the vector
+/// @return the value at the given position or a void pointer to NULL if invalid index
+elem_t ioopm_vector_get(ioopm_vector_t *vector, int index);
+
+/// @brief Replace an element of a vector in O(1) time.
+/// @param vector the vector
+/// @param index the position in the vector
+/// @param value the new value at the given position
+/// @return the replaced value or a void pointer to NULL if invalid index
+elem_t ioopm_vector_set(ioopm_vector_t *vector, int index, elem_t value);
+
+/// @brief The elements of a vector as an array of ioopm_vector_size elements, for example
+/// to sort them with qsort. The array is only valid until the vector is changed.
+/// @param vector the vector
+/// @return the first element of the vector
+elem_t *ioopm_vector_data(ioopm_vector_t *vector);
+
+/// @brief Test if an element is in the vector
+/// @param vector the vector
+/// @param element the element sought
+/// @return true if element is in the vector, else false
+bool ioopm_vector_contains(ioopm_vector_t *vector, elem_t element);
+
+/// @brief Lookup the number of elements in the vector in O(1) time
+/// @param vector the vector
+/// @return the number of elements in the vector
+size_t ioopm_vector_size(ioopm_vector_t *vector);
+
+/// @brief Test whether a vector is empty or not
+/// @param vector the vector
+/// @return true if the number of elements in the vector is 0, else false
+bool ioopm_vector_is_empty(ioopm_vector_t *vector);
+
+/// @brief Remove all elements from a vector, keeping its capacity
+/// @param vector the vector
+void ioopm_vector_clear(ioopm_vector_t *vector);
+
+/// @brief Test if a supplied property holds for all elements in a vector.
+/// The function returns as soon as the return value can be determined.
+/// @param vector the vector
+/// @param prop the property to be tested (function pointer)
+/// @param extra an additional argument (may be NULL) that will be passed to all internal calls of prop
+/// @return true if prop holds for all elements in the vector, else false
+bool ioopm_vector_all(ioopm_vector_t *vector, ioopm_int_predicate prop, void *extra);
+
+/// @brief Test if a supplied property holds for any element in a vector.
+/// The function returns as soon as the return value can be determined.
+/// @param vector the vector
+/// @param prop the property to be tested
+/// @param extra an additional argument (may be NULL) that will be passed to all internal calls of prop
+/// @return true if prop holds for any elements in the vector, else false
+bool ioopm_vector_any(ioopm_vector_t *vector, ioopm_int_predicate prop, void *extra);
+
+/// @brief Apply a supplied function to all elements in a vector.
+/// @param vector the vector
+/// @param fun the function to be applied
+/// @param extra an additional argument (may be NULL) that will be passed to all internal calls of fun
+void ioopm_vector_apply_to_all(ioopm_vector_t *vector, ioopm_apply_int_function fun, void *extra);
+
+/// @brief Create an iterator for a given vector
+/// @param vector the vector to be iterated over
+/// @return an iteration positioned at the start of vector
+ioopm_vector_iterator_t *ioopm_vector_iterator(ioopm_vector_t *vector);
+
+/// @brief Checks if there are more elements to iterate over
+/// @param iter the iterator
+/// @return true if there is at least one more element
+bool ioopm_vector_iterator_has_next(ioopm_vector_iterator_t *iter);
+
+/// @brief Step the iterator forward one step
+/// @param iter the iterator
+/// @return the next element or a void pointer to NULL if vector has no next element
+elem_t ioopm_vector_iterator_next(ioopm_vector_iterator_t *iter);
+
+/// @brief Reposition the iterator at the start of the underlying vector
+/// @param iter the iterator
+void ioopm_vector_iterator_reset(ioopm_vector_iterator_t *iter);
+
+/// @brief Checks if the iterator is positioned at an element
+/// @param iter the iterator
+/// @return true if there is a current element
+bool ioopm_vector_iterator_has_current(ioopm_vector_iterator_t *iter);
+
+/// @brief Return the current element from the underlying vector
+/// @param iter the iterator
+/// @return the current element or a void pointer to NULL if there is no current element
+elem_t ioopm_vector_iterator_current(ioopm_vector_iterator_t *iter);
+
+/// @brief Replace the current element of the underlying vector in O(1) time
+/// @param iter the iterator
+/// @param value the new value of the current element
+/// @return the replaced element or a void pointer to NULL if there is no current element
+elem_t ioopm_vector_iterator_set(ioopm_vector_iterator_t *iter, elem_t value);
+
+/// @brief Remove the current element in O(n) time. The iterator moves on to the element
+/// after the removed one, or has no current element if the last element was removed.
+/// @param iter the iterator
+/// @return the removed element or a void pointer to NULL if there is no current element
+elem_t ioopm_vector_iterator_remove(ioopm_vector_iterator_t *iter);
+
+/// @brief Destroy the iterator and return its resources
+/// @param iter the iterator
+void ioopm_vector_iterator_destroy(ioopm_vector_iterator_t *iter);
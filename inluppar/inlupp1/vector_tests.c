@@ -0,0 +1,253 @@
+#include <CUnit/Basic.h>
+#include "vector.h"
+#include "common.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+int init_suite(void)
+{
+    return 0;
+}
+
+int clean_suite(void)
+{
+    return 0;
+}
+
+static bool bool_eq_fun(elem_t a, elem_t b)
+{
+    return b.integer == a.integer;
+}
+
+static bool is_positive(elem_t value, void *extra)
+{
+    return value.integer > 0;
+}
+
+static bool is_equal(elem_t value, void *extra)
+{
+    return value.integer == *(int *) extra;
+}
+
+static void add_to_value(elem_t *value, void *extra)
+{
+    value->integer += *(int *) extra;
+}
+
+static void assert_vector_matches(ioopm_vector_t *vector, int *expected, int length)
+{
+    CU_ASSERT_EQUAL(ioopm_vector_size(vector), length);
+
+    for (int i = 0; i < length; i++)
+    {
+        CU_ASSERT_EQUAL(ioopm_vector_get(vector, i).integer, expected[i]);
+        CU_ASSERT_EQUAL(ioopm_vector_data(vector)[i].integer, expected[i]);
+    }
+}
+
+void test_create_destroy()
+{
+    ioopm_vector_t *vector = ioopm_vector_create(bool_eq_fun);
+    CU_ASSERT_PTR_NOT_NULL(vector);
+    CU_ASSERT_TRUE(ioopm_vector_is_empty(vector));
+    ioopm_vector_destroy(vector);
+}
+
+void test_append_prepend_insert()
+{
+    ioopm_vector_t *vector = ioopm_vector_create(bool_eq_fun);
+
+    ioopm_int_vector_append(vector, 2);
+    ioopm_int_vector_prepend(vector, 0);
+    ioopm_int_vector_insert(vector, 1, 1);
+    ioopm_int_vector_insert(vector, 3, 3);
+    int expected[] = {0, 1, 2, 3};
+    assert_vector_matches(vector, expected, 4);
+
+    // invalid indices are ignored
+    ioopm_int_vector_insert(vector, -1, 9);
+    ioopm_int_vector_insert(vector, 5, 9);
+    assert_vector_matches(vector, expected, 4);
+
+    ioopm_vector_destroy(vector);
+}
+
+void test_get_set_remove()
+{
+    ioopm_vector_t *vector = ioopm_vector_create(bool_eq_fun);
+    CU_ASSERT_PTR_NULL(ioopm_vector_get(vector, 0).void_ptr);
+    CU_ASSERT_PTR_NULL(ioopm_vector_remove(vector, 0).void_ptr);
+    CU_ASSERT_PTR_NULL(ioopm_vector_remove_last(vector).void_ptr);
+
+    for (int i = 0; i < 5; i++)
+    {
+        ioopm_int_vector_append(vector, i);
+    }
+
+    CU_ASSERT_EQUAL(ioopm_vector_set(vector, 2, int_elem(20)).integer, 2);
+    CU_ASSERT_PTR_NULL(ioopm_vector_set(vector, 5, int_elem(50)).void_ptr);
+    CU_ASSERT_EQUAL(ioopm_vector_remove(vector, 0).integer, 0);
+    CU_ASSERT_EQUAL(ioopm_vector_remove_last(vector).integer, 4);
+    CU_ASSERT_PTR_NULL(ioopm_vector_remove(vector, 3).void_ptr);
+    int expected[] = {1, 20, 3};
+    assert_vector_matches(vector, expected, 3);
+
+    ioopm_vector_clear(vector);
+    CU_ASSERT_TRUE(ioopm_vector_is_empty(vector));
+    ioopm_int_vector_append(vector, 7);
+    CU_ASSERT_EQUAL(ioopm_vector_get(vector, 0).integer, 7);
+
+    ioopm_vector_destroy(vector);
+}
+
+void test_long_vector()
+{
+    ioopm_vector_t *vector = ioopm_vector_create(bool_eq_fun);
+    int expected[1000];
+    int length = 0;
+
+    // grows through several capacities
+    for (int i = 0; i < 500; i++)
+    {
+        ioopm_int_vector_append(vector, i);
+        expected[length++] = i;
+    }
+    for (int i = 0; i < 250; i++)
+    {
+        ioopm_int_vector_insert(vector, 2 * i, -i);
+        memmove(expected + 2 * i + 1, expected + 2 * i, (length - 2 * i) * sizeof(int));
+        expected[2 * i] = -i;
+        length++;
+    }
+    assert_vector_matches(vector, expected, length);
+
+    for (int i = 0; i < 100; i++)
+    {
+        CU_ASSERT_EQUAL(ioopm_vector_remove(vector, 3 * i).integer, expected[3 * i]);
+        memmove(expected + 3 * i, expected + 3 * i + 1, (length - 3 * i - 1) * sizeof(int));
+        length--;
+    }
+    assert_vector_matches(vector, expected, length);
+
+    ioopm_vector_destroy(vector);
+}
+
+void test_contains_all_any_apply()
+{
+    ioopm_vector_t *vector = ioopm_vector_create(bool_eq_fun);
+    int sought = 3;
+    int added = 10;
+
+    CU_ASSERT_TRUE(ioopm_vector_all(vector, is_positive, NULL));
+    CU_ASSERT_FALSE(ioopm_vector_any(vector, is_positive, NULL));
+
+    for (int i = 1; i <= 4; i++)
+    {
+        ioopm_int_vector_append(vector, i);
+    }
+
+    CU_ASSERT_TRUE(ioopm_vector_contains(vector, int_elem(4)));
+    CU_ASSERT_FALSE(ioopm_vector_contains(vector, int_elem(5)));
+    CU_ASSERT_TRUE(ioopm_vector_all(vector, is_positive, NULL));
+    CU_ASSERT_TRUE(ioopm_vector_any(vector, is_equal, &sought));
+
+    ioopm_vector_apply_to_all(vector, add_to_value, &added);
+    int expected[] = {11, 12, 13, 14};
+    assert_vector_matches(vector, expected, 4);
+    CU_ASSERT_FALSE(ioopm_vector_any(vector, is_equal, &sought));
+
+    ioopm_vector_destroy(vector);
+}
+
+void test_iterator()
+{
+    ioopm_vector_t *vector = ioopm_vector_create(bool_eq_fun);
+    ioopm_vector_iterator_t *iter = ioopm_vector_iterator(vector);
+    CU_ASSERT_FALSE(ioopm_vector_iterator_has_current(iter));
+    CU_ASSERT_FALSE(ioopm_vector_iterator_has_next(iter));
+    CU_ASSERT_PTR_NULL(ioopm_vector_iterator_current(iter).void_ptr);
+    CU_ASSERT_PTR_NULL(ioopm_vector_iterator_next(iter).void_ptr);
+
+    for (int i = 0; i < 6; i++)
+    {
+        ioopm_int_vector_append(vector, i);
+    }
+
+    CU_ASSERT_EQUAL(ioopm_vector_iterator_current(iter).integer, 0);
+    for (int i = 1; i < 6; i++)
+    {
+        CU_ASSERT_TRUE(ioopm_vector_iterator_has_next(iter));
+        CU_ASSERT_EQUAL(ioopm_vector_iterator_next(iter).integer, i);
+    }
+    CU_ASSERT_FALSE(ioopm_vector_iterator_has_next(iter));
+
+    // remove the even numbers and negate the odd ones
+    ioopm_vector_iterator_reset(iter);
+    while (ioopm_vector_iterator_has_current(iter))
+    {
+        int value = ioopm_vector_iterator_current(iter).integer;
+
+        if (value % 2 == 0)
+        {
+            CU_ASSERT_EQUAL(ioopm_vector_iterator_remove(iter).integer, value);
+        }
+        else
+        {
+            CU_ASSERT_EQUAL(ioopm_vector_iterator_set(iter, int_elem(-value)).integer, value);
+            if (!ioopm_vector_iterator_has_next(iter)) break;
+            ioopm_vector_iterator_next(iter);
+        }
+    }
+    int expected[] = {-1, -3, -5};
+    assert_vector_matches(vector, expected, 3);
+    ioopm_vector_iterator_destroy(iter);
+
+    ioopm_vector_destroy(vector);
+}
+
+int main()
+{
+    // First we try to set up CUnit, and exit if we fail
+    if (CU_initialize_registry() != CUE_SUCCESS)
+        return CU_get_error();
+
+    // We then create an empty test suite and specify the name and
+    // the init and cleanup functions
+    CU_pSuite my_test_suite = CU_add_suite("Tests for vector.c", init_suite, clean_suite);
+    if (my_test_suite == NULL)
+    {
+        // If the test suite could not be added, tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // This is where we add the test functions to our test suite.
+    // For each call to CU_add_test we specify the test suite, the
+    // name or description of the test, and the function that runs
+    // the test in question. If you want to add another test, just
+    // copy a line below and change the information
+    if (
+        (CU_add_test(my_test_suite, "A simple create and destroy test", test_create_destroy) == NULL ||
+         CU_add_test(my_test_suite, "Append, prepend and insert elements", test_append_prepend_insert) == NULL ||
+         CU_add_test(my_test_suite, "Get, set and remove elements", test_get_set_remove) == NULL ||
+         CU_add_test(my_test_suite, "Insert and remove across a long vector", test_long_vector) == NULL ||
+         CU_add_test(my_test_suite, "Contains, all, any and apply to all", test_contains_all_any_apply) == NULL ||
+         CU_add_test(my_test_suite, "Iterate, set and remove through an iterator", test_iterator) == NULL))
+    {
+        // If adding any of the tests fails, we tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Set the running mode. Use CU_BRM_VERBOSE for maximum output.
+    // Use CU_BRM_NORMAL to only print errors and a summary
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+
+    // This is where the tests are actually run!
+    CU_basic_run_tests();
+
+    // Tear down CUnit before exiting
+    CU_cleanup_registry();
+    return CU_get_error();
+}
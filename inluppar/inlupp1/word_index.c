@@ -0,0 +1,492 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "word_index.h"
+#include "hash_table.h"
+#include "writer.h"
+#include "common.h"
+
+#define Index_Magic "freq-count index 1 "
+#define Write_Buffer_Size (1 << 16)
+
+enum entry_state
+{
+    ENTRY_SAVED,        // in the index file, not checked yet
+    ENTRY_KEPT,         // checked and unchanged, the saved counts are used
+    ENTRY_REPLACED,     // counted again
+};
+
+typedef struct stamp stamp_t;
+typedef struct index_entry index_entry_t;
+typedef enum entry_state entry_state_t;
+
+// The fingerprint of the contents of a file
+struct stamp
+{
+    unsigned long long size;
+    long long seconds;              // the modification time
+    long nanoseconds;
+    unsigned long long hash;
+};
+
+struct index_entry
+{
+    char *path;
+    stamp_t stamp;
+    entry_state_t state;
+    const char *body;               // the saved counts in the index file, or NULL for a new file
+    size_t body_length;
+    ioopm_hash_table_t *counts;     // the new counts of a replaced file
+};
+
+struct word_index
+{
+    char *path;
+    char *settings;
+    char *text;                     // the index file mapped into memory, or NULL
+    size_t length;
+    const char *files;              // the first file line, after the header
+    const char *total;              // the saved total counts
+    size_t total_length;
+    index_entry_t **entries;        // in the order they are saved
+    size_t entry_count;
+    size_t entry_capacity;
+    ioopm_hash_table_t *paths;      // finds the entry of a path
+};
+
+static unsigned path_hash(elem_t key)
+{
+    unsigned result = 2166136261u;
+    for (const char *c = key.string; *c != '\0'; c++)
+    {
+        result = (result ^ (unsigned char) *c) * 16777619u;
+    }
+    return result;
+}
+
+static bool path_eq(elem_t a, elem_t b)
+{
+    return strcmp(a.string, b.string) == 0;
+}
+
+// A hash of the contents of a file, 8 bytes at a time
+static unsigned long long content_hash(const unsigned char *bytes, size_t length)
+{
+    uint64_t hash = 0x9e3779b97f4a7c15ull ^ length;
+    size_t i = 0;
+
+    for (; i + 8 <= length; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = ((hash ^ word) << 31 | (hash ^ word) >> 33) * 0xff51afd7ed558ccdull;
+    }
+    for (; i < length; i++)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// Takes the size and modification time of a file, and its hash if with_hash is true.
+// Returns false if the file cannot be read.
+static bool stamp_take(const char *filename, stamp_t *stamp, bool with_hash)
+{
+    struct stat info;
+    int fd = open(filename, O_RDONLY);
+    bool success = fd >= 0 && fstat(fd, &info) == 0;
+
+    if (success)
+    {
+        stamp->size = info.st_size;
+        stamp->seconds = info.st_mtim.tv_sec;
+        stamp->nanoseconds = info.st_mtim.tv_nsec;
+        stamp->hash = 0;
+    }
+    if (success && with_hash && info.st_size > 0)
+    {
+        unsigned char *bytes = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        success = bytes != MAP_FAILED;
+        if (success)
+        {
+            madvise(bytes, info.st_size, MADV_SEQUENTIAL);
+            stamp->hash = content_hash(bytes, info.st_size);
+            munmap(bytes, info.st_size);
+        }
+    }
+    else if (success && with_hash)
+    {
+        stamp->hash = content_hash(NULL, 0);
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return success;
+}
+
+static index_entry_t *entry_add(ioopm_word_index_t *index, const char *path)
+{
+    index_entry_t *entry = calloc(1, sizeof(index_entry_t));
+    entry->path = strdup(path);
+
+    if (index->entry_count == index->entry_capacity)
+    {
+        index->entry_capacity = index->entry_capacity > 0 ? 2 * index->entry_capacity : 16;
+        index->entries = realloc(index->entries, index->entry_capacity * sizeof(index_entry_t *));
+    }
+    index->entries[index->entry_count++] = entry;
+    ioopm_hash_table_insert(index->paths, str_elem(entry->path), (elem_t) {.void_ptr = entry});
+
+    return entry;
+}
+
+static index_entry_t *entry_find(ioopm_word_index_t *index, const char *path)
+{
+    option_t *lookup_result = ioopm_hash_table_lookup(index->paths, str_elem((char *) path));
+    index_entry_t *entry = lookup_result->success ? lookup_result->value.void_ptr : NULL;
+
+    free(lookup_result);
+    return entry;
+}
+
+// Reads the line starting at *next into a '\0' terminated copy and moves next past it.
+// Returns NULL if there is no whole line left.
+static char *line_take(const char **next, const char *end)
+{
+    const char *newline = memchr(*next, '\n', end - *next);
+
+    if (newline == NULL)
+    {
+        return NULL;
+    }
+
+    char *line = strndup(*next, newline - *next);
+    *next = newline + 1;
+    return line;
+}
+
+// Reads the file lines and the total of a mapped index, returning false if it is damaged
+static bool index_parse(ioopm_word_index_t *index)
+{
+    const char *next = index->files;
+    const char *end = index->text + index->length;
+    char *line;
+
+    while ((line = line_take(&next, end)) != NULL)
+    {
+        stamp_t stamp;
+        size_t bytes;
+        int path_start = 0;
+        bool total = sscanf(line, "total %zu", &bytes) == 1;
+        bool file = !total && sscanf(line, "file %llu %lld %ld %llx %zu %n", &stamp.size, &stamp.seconds, &stamp.nanoseconds, &stamp.hash, &bytes, &path_start) == 5 && path_start > 0;
+
+        if ((!total && !file) || bytes > (size_t) (end - next) || (file && entry_find(index, line + path_start) != NULL))
+        {
+            free(line);
+            return false;
+        }
+
+        if (total)
+        {
+            index->total = next;
+            index->total_length = bytes;
+        }
+        else
+        {
+            index_entry_t *entry = entry_add(index, line + path_start);
+            entry->stamp = stamp;
+            entry->state = ENTRY_SAVED;
+            entry->body = next;
+            entry->body_length = bytes;
+        }
+        next += bytes;
+        free(line);
+
+        // the total comes last
+        if (total)
+        {
+            return next == end;
+        }
+    }
+    return false;
+}
+
+// Forgets the saved counts of every file, for an index that cannot be used
+static void index_forget(ioopm_word_index_t *index)
+{
+    for (size_t i = 0; i < index->entry_count; i++)
+    {
+        free(index->entries[i]->path);
+        free(index->entries[i]);
+    }
+    index->entry_count = 0;
+    ioopm_hash_table_clear(index->paths);
+    index->total = NULL;
+    index->total_length = 0;
+}
+
+ioopm_word_index_t *ioopm_word_index_open(const char *path, const char *settings)
+{
+    ioopm_word_index_t *index = calloc(1, sizeof(ioopm_word_index_t));
+    index->path = strdup(path);
+    index->settings = strdup(settings);
+    index->paths = ioopm_hash_table_create(path_hash, path_eq);
+
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        index->text = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        index->length = info.st_size;
+
+        if (index->text == MAP_FAILED)
+        {
+            perror(path);
+            index->text = NULL;
+        }
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    if (index->text != NULL)
+    {
+        const char *next = index->text;
+        char *header = line_take(&next, index->text + index->length);
+        bool same_settings = header != NULL && strncmp(header, Index_Magic, strlen(Index_Magic)) == 0 &&
+                             strcmp(header + strlen(Index_Magic), settings) == 0;
+
+        index->files = next;
+        if (same_settings && !index_parse(index))
+        {
+            fprintf(stderr, "freq-count: %s is damaged, every file is counted again\n", path);
+            index_forget(index);
+        }
+        free(header);
+    }
+
+    return index;
+}
+
+void ioopm_word_index_close(ioopm_word_index_t *index)
+{
+    index_forget(index);
+    if (index->text != NULL)
+    {
+        munmap(index->text, index->length);
+    }
+    ioopm_hash_table_destroy(index->paths);
+    free(index->entries);
+    free(index->settings);
+    free(index->path);
+    free(index);
+}
+
+bool ioopm_word_index_check(ioopm_word_index_t *index, const char *filename)
+{
+    index_entry_t *entry = entry_find(index, filename);
+    stamp_t stamp;
+
+    if (entry == NULL || !stamp_take(filename, &stamp, false))
+    {
+        return false;
+    }
+    if (entry->state != ENTRY_SAVED)
+    {
+        return true;
+    }
+    if (stamp.size != entry->stamp.size)
+    {
+        return false;
+    }
+
+    // a file that was only touched has the same contents
+    if (stamp.seconds != entry->stamp.seconds || stamp.nanoseconds != entry->stamp.nanoseconds)
+    {
+        if (!stamp_take(filename, &stamp, true) || stamp.hash != entry->stamp.hash)
+        {
+            return false;
+        }
+        entry->stamp = stamp;
+    }
+
+    entry->state = ENTRY_KEPT;
+    return true;
+}
+
+bool ioopm_word_index_replace(ioopm_word_index_t *index, const char *filename, ioopm_hash_table_t *counts)
+{
+    stamp_t stamp;
+
+    // the path ends the line of the file in the index
+    if (strchr(filename, '\n') != NULL || !stamp_take(filename, &stamp, true))
+    {
+        return false;
+    }
+
+    index_entry_t *entry = entry_find(index, filename);
+    if (entry == NULL)
+    {
+        entry = entry_add(index, filename);
+    }
+    entry->stamp = stamp;
+    entry->state = ENTRY_REPLACED;
+    entry->counts = counts;
+    return true;
+}
+
+// Calls fun for every "COUNT WORD" line of saved counts, with the count times sign
+static bool body_apply(const char *body, size_t length, int sign, ioopm_word_count_function fun, void *extra)
+{
+    const char *end = body + length;
+
+    while (body < end)
+    {
+        const char *newline = memchr(body, '\n', end - body);
+        char *after;
+        long count = strtol(body, &after, 10);
+
+        if (newline == NULL || after == body || *after != ' ')
+        {
+            return false;
+        }
+
+        fun(after + 1, newline - after - 1, sign * count, extra);
+        body = newline + 1;
+    }
+    return true;
+}
+
+bool ioopm_word_index_totals(ioopm_word_index_t *index, ioopm_word_count_function fun, void *extra)
+{
+    bool success = body_apply(index->total, index->total_length, 1, fun, extra);
+
+    for (size_t i = 0; i < index->entry_count && success; i++)
+    {
+        index_entry_t *entry = index->entries[i];
+
+        if (entry->body != NULL && entry->state != ENTRY_KEPT)
+        {
+            success = body_apply(entry->body, entry->body_length, -1, fun, extra);
+        }
+    }
+    return success;
+}
+
+static size_t digits(long long value)
+{
+    size_t count = 1;
+
+    for (; value >= 10; value /= 10)
+    {
+        count++;
+    }
+    return count;
+}
+
+static void add_line_bytes(elem_t key, elem_t *value, void *extra)
+{
+    if (value->integer > 0)
+    {
+        *(size_t *) extra += digits(value->integer) + 1 + strlen(key.string) + 1;
+    }
+}
+
+// The number of bytes of the "COUNT WORD" lines of counts, which leave out words counted 0
+static size_t counts_bytes(ioopm_hash_table_t *counts)
+{
+    size_t bytes = 0;
+
+    ioopm_hash_table_apply_to_all(counts, add_line_bytes, &bytes);
+    return bytes;
+}
+
+static void write_count(elem_t key, elem_t *value, void *extra)
+{
+    if (value->integer > 0)
+    {
+        ioopm_writer_int(extra, value->integer);
+        ioopm_writer_char(extra, ' ');
+        ioopm_writer_string(extra, key.string);
+        ioopm_writer_char(extra, '\n');
+    }
+}
+
+bool ioopm_word_index_save(ioopm_word_index_t *index, ioopm_hash_table_t *totals)
+{
+    size_t path_length = strlen(index->path);
+    char *temporary = calloc(path_length + 5, 1);
+    memcpy(temporary, index->path, path_length);
+    memcpy(temporary + path_length, ".tmp", 4);
+
+    int fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        perror(temporary);
+        free(temporary);
+        return false;
+    }
+
+    ioopm_writer_t *writer = ioopm_writer_create(fd, Write_Buffer_Size);
+    ioopm_writer_string(writer, Index_Magic);
+    ioopm_writer_string(writer, index->settings);
+    ioopm_writer_char(writer, '\n');
+
+    for (size_t i = 0; i < index->entry_count; i++)
+    {
+        index_entry_t *entry = index->entries[i];
+        char line[160];
+
+        // files no longer counted are left out
+        if (entry->state == ENTRY_SAVED)
+        {
+            continue;
+        }
+
+        snprintf(line, sizeof(line), "file %llu %lld %ld %016llx ", entry->stamp.size, entry->stamp.seconds, entry->stamp.nanoseconds, entry->stamp.hash);
+        ioopm_writer_string(writer, line);
+        ioopm_writer_int(writer, entry->state == ENTRY_KEPT ? entry->body_length : counts_bytes(entry->counts));
+        ioopm_writer_char(writer, ' ');
+        ioopm_writer_string(writer, entry->path);
+        ioopm_writer_char(writer, '\n');
+
+        // the counts of an unchanged file are copied without being read
+        if (entry->state == ENTRY_KEPT)
+        {
+            ioopm_writer_bytes(writer, entry->body, entry->body_length);
+        }
+        else
+        {
+            ioopm_hash_table_apply_to_all(entry->counts, write_count, writer);
+        }
+    }
+
+    ioopm_writer_string(writer, "total ");
+    ioopm_writer_int(writer, counts_bytes(totals));
+    ioopm_writer_char(writer, '\n');
+    ioopm_hash_table_apply_to_all(totals, write_count, writer);
+
+    bool success = ioopm_writer_destroy(writer);
+    success = close(fd) == 0 && success;
+    if (!success || rename(temporary, index->path) != 0)
+    {
+        perror(index->path);
+        unlink(temporary);
+        success = false;
+    }
+
+    free(temporary);
+    return success;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include "hash_table.h"
+
+/**
+ * @file word_index.h
+ * @author Tuva Björnberg & Gustav Fridén
+ * @date 29/09-2023
+ * @brief Word counts saved between runs (`word_index_t`), so that only new and changed
+ * files have to be counted again.
+ *
+ * An index file holds the counts of every file counted, each with the size, modification
+ * time and a hash of the contents of the file when it was counted, and the total counts
+ * of all of them. A file is unchanged if it has the same size and modification time, or
+ * the same size and contents. The totals of a new run are the saved totals, minus the
+ * counts of the files that changed or are no longer counted, plus the new counts of the
+ * changed and new files. The counts of unchanged files are copied to the new index as
+ * they are, without being read.
+ *
+ * The index is text: a line "freq-count index 1 SETTINGS", then for every file a line
+ * "file SIZE SECONDS NANOSECONDS HASH BYTES PATH" followed by BYTES bytes of "COUNT WORD"
+ * lines, and last a line "total BYTES" followed by the total counts. Words may not hold
+ * spaces or newlines. An index made with other settings is not used.
+ *
+ * Files are known by the path they were given as. Counts are tables with words as string
+ * keys and counts as integer values.
+ */
+
+typedef struct word_index ioopm_word_index_t;
+
+typedef void(*ioopm_word_count_function)(const char *word, size_t length, int count, void *extra);
+
+/// @brief Opens an index file
+/// @param path the index file, which need not exist
+/// @param settings a word naming the settings that change the counts, which must be the
+/// same as when the index was saved for it to be used
+/// @return the index, empty if the file does not exist, was saved with other settings or
+/// is damaged (after printing why)
+ioopm_word_index_t *ioopm_word_index_open(const char *path, const char *settings);
+
+/// @brief Return the memory of an index and close its file
+/// @param index the index to be closed
+void ioopm_word_index_close(ioopm_word_index_t *index);
+
+/// @brief Check if a file is unchanged since it was counted, keeping its counts if it is.
+/// A file checked more than once is only counted the first time, later checks return true,
+/// so a caller that counts repeated files must reject them.
+/// @param index the index
+/// @param filename the file
+/// @return true if the saved counts of the file can be used
+bool ioopm_word_index_check(ioopm_word_index_t *index, const char *filename);
+
+/// @brief Record new counts of a file, which replace its saved counts
+/// @param index the index
+/// @param filename the file, checked with ioopm_word_index_check first
+/// @param counts the counts of the file, which must be kept until the index is saved
+/// @return false if the file could not be read to take its fingerprint, then its counts
+/// are not saved
+bool ioopm_word_index_replace(ioopm_word_index_t *index, const char *filename, ioopm_hash_table_t *counts);
+
+/// @brief Call a function with the changes to the saved totals: every saved total count,
+/// and the negated saved counts of every file that was replaced or not checked. The new
+/// counts given to ioopm_word_index_replace are not included.
+/// @param index the index, after checking every file
+/// @param fun the function called for each word and count
+/// @param extra an additional argument (may be NULL) that will be passed to all calls of fun
+/// @return false if the index is damaged
+bool ioopm_word_index_totals(ioopm_word_index_t *index, ioopm_word_count_function fun, void *extra);
+
+/// @brief Save the index with the counts of every file checked or replaced since it was
+/// opened. The file is replaced in one step, so a failed save leaves the old index.
+/// @param index the index
+/// @param totals the total counts of all of those files
+/// @return false if the index could not be written
+bool ioopm_word_index_save(ioopm_word_index_t *index, ioopm_hash_table_t *totals);
@@ -0,0 +1,297 @@
+#include <CUnit/Basic.h>
+#include "word_index.h"
+#include "hash_table.h"
+#include "common.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static char directory[] = "/tmp/word_index_testsXXXXXX";
+static char index_path[64];
+static char first_path[64];
+static char second_path[64];
+
+int init_suite(void)
+{
+    if (mkdtemp(directory) == NULL)
+    {
+        return 1;
+    }
+    snprintf(index_path, sizeof(index_path), "%s/index", directory);
+    snprintf(first_path, sizeof(first_path), "%s/first.txt", directory);
+    snprintf(second_path, sizeof(second_path), "%s/second.txt", directory);
+    return 0;
+}
+
+int clean_suite(void)
+{
+    unlink(index_path);
+    unlink(first_path);
+    unlink(second_path);
+    rmdir(directory);
+    return 0;
+}
+
+static unsigned string_hash(elem_t key)
+{
+    unsigned result = 0;
+    for (char *c = key.string; *c != '\0'; c++)
+    {
+        result = result * 31 + *c;
+    }
+    return result;
+}
+
+static bool string_eq(elem_t a, elem_t b)
+{
+    return strcmp(a.string, b.string) == 0;
+}
+
+// Writes a file and gives it a modification time, so that changes do not depend on how
+// fine the clock of the file system is
+static void write_file(char *path, char *contents, time_t modified)
+{
+    FILE *f = fopen(path, "w");
+    fputs(contents, f);
+    fclose(f);
+
+    struct timespec times[2] = {{.tv_sec = modified}, {.tv_sec = modified}};
+    utimensat(AT_FDCWD, path, times, 0);
+}
+
+// A table of counts with string literals as keys
+static ioopm_hash_table_t *counts_of(char *words[], int counts[], int count)
+{
+    ioopm_hash_table_t *ht = ioopm_hash_table_create(string_hash, string_eq);
+
+    for (int i = 0; i < count; i++)
+    {
+        ioopm_hash_table_insert(ht, str_elem(words[i]), int_elem(counts[i]));
+    }
+    return ht;
+}
+
+static void add_count(const char *word, size_t length, int count, void *extra)
+{
+    ioopm_hash_table_t *ht = extra;
+    char *key = strndup(word, length);
+    option_t *lookup_result = ioopm_hash_table_lookup(ht, str_elem(key));
+
+    if (lookup_result->success)
+    {
+        ioopm_hash_table_insert(ht, str_elem(key), int_elem(lookup_result->value.integer + count));
+        free(key);
+    }
+    else
+    {
+        ioopm_hash_table_insert(ht, str_elem(key), int_elem(count));
+    }
+    free(lookup_result);
+}
+
+static void free_key(elem_t key, elem_t *value, void *extra)
+{
+    free(key.string);
+}
+
+// The count of a word in the changes from ioopm_word_index_totals
+static int total_of(ioopm_hash_table_t *totals, char *word)
+{
+    option_t *lookup_result = ioopm_hash_table_lookup(totals, str_elem(word));
+    int count = lookup_result->success ? lookup_result->value.integer : 0;
+
+    free(lookup_result);
+    return count;
+}
+
+static ioopm_hash_table_t *totals_of(ioopm_word_index_t *index)
+{
+    ioopm_hash_table_t *totals = ioopm_hash_table_create(string_hash, string_eq);
+
+    CU_ASSERT_TRUE(ioopm_word_index_totals(index, add_count, totals));
+    return totals;
+}
+
+static void totals_destroy(ioopm_hash_table_t *totals)
+{
+    ioopm_hash_table_apply_to_all(totals, free_key, NULL);
+    ioopm_hash_table_destroy(totals);
+}
+
+void test_index_save_and_reuse()
+{
+    char *first_words[] = {"the", "cat"};
+    int first_counts[] = {2, 1};
+    char *second_words[] = {"the", "dog"};
+    int second_counts[] = {1, 3};
+    char *total_words[] = {"the", "cat", "dog"};
+    int total_counts[] = {3, 1, 3};
+
+    write_file(first_path, "the cat the", 1000);
+    write_file(second_path, "the dog dog dog", 1000);
+
+    // no index yet, so every file is new
+    ioopm_word_index_t *index = ioopm_word_index_open(index_path, "plain");
+    CU_ASSERT_FALSE(ioopm_word_index_check(index, first_path));
+    CU_ASSERT_FALSE(ioopm_word_index_check(index, second_path));
+
+    ioopm_hash_table_t *first = counts_of(first_words, first_counts, 2);
+    ioopm_hash_table_t *second = counts_of(second_words, second_counts, 2);
+    CU_ASSERT_TRUE(ioopm_word_index_replace(index, first_path, first));
+    CU_ASSERT_TRUE(ioopm_word_index_replace(index, second_path, second));
+    CU_ASSERT_FALSE(ioopm_word_index_replace(index, "/no/such/file", first));
+    // a file given twice is only counted once
+    CU_ASSERT_TRUE(ioopm_word_index_check(index, first_path));
+
+    ioopm_hash_table_t *totals = totals_of(index);
+    CU_ASSERT_TRUE(ioopm_hash_table_is_empty(totals));
+    totals_destroy(totals);
+
+    ioopm_hash_table_t *all = counts_of(total_words, total_counts, 3);
+    CU_ASSERT_TRUE(ioopm_word_index_save(index, all));
+    ioopm_word_index_close(index);
+    ioopm_hash_table_destroy(first);
+    ioopm_hash_table_destroy(second);
+
+    // unchanged files are reused
+    index = ioopm_word_index_open(index_path, "plain");
+    CU_ASSERT_TRUE(ioopm_word_index_check(index, first_path));
+    CU_ASSERT_TRUE(ioopm_word_index_check(index, second_path));
+
+    totals = totals_of(index);
+    CU_ASSERT_EQUAL(ioopm_hash_table_size(totals), 3);
+    CU_ASSERT_EQUAL(total_of(totals, "the"), 3);
+    CU_ASSERT_EQUAL(total_of(totals, "dog"), 3);
+    totals_destroy(totals);
+
+    // saving again copies the saved counts
+    CU_ASSERT_TRUE(ioopm_word_index_save(index, all));
+    ioopm_word_index_close(index);
+    index = ioopm_word_index_open(index_path, "plain");
+    CU_ASSERT_TRUE(ioopm_word_index_check(index, first_path));
+    CU_ASSERT_TRUE(ioopm_word_index_check(index, second_path));
+    totals = totals_of(index);
+    CU_ASSERT_EQUAL(total_of(totals, "cat"), 1);
+    totals_destroy(totals);
+    ioopm_word_index_close(index);
+
+    // an index saved with other settings is not used
+    index = ioopm_word_index_open(index_path, "normalize");
+    CU_ASSERT_FALSE(ioopm_word_index_check(index, first_path));
+    totals = totals_of(index);
+    CU_ASSERT_TRUE(ioopm_hash_table_is_empty(totals));
+    totals_destroy(totals);
+    ioopm_word_index_close(index);
+
+    ioopm_hash_table_destroy(all);
+}
+
+void test_index_changes()
+{
+    char *changed_words[] = {"the", "bat"};
+    int changed_counts[] = {2, 1};
+    char *total_words[] = {"the", "bat"};
+    int total_counts[] = {2, 1};
+
+    // touched: a new modification time but the same contents
+    write_file(second_path, "the dog dog dog", 2000);
+    // changed: the same size and a new modification time, but other contents
+    write_file(first_path, "the bat the", 3000);
+
+    ioopm_word_index_t *index = ioopm_word_index_open(index_path, "plain");
+    CU_ASSERT_TRUE(ioopm_word_index_check(index, second_path));
+    CU_ASSERT_FALSE(ioopm_word_index_check(index, first_path));
+
+    ioopm_hash_table_t *changed = counts_of(changed_words, changed_counts, 2);
+    CU_ASSERT_TRUE(ioopm_word_index_replace(index, first_path, changed));
+
+    // the old counts of the changed file are taken away from the saved totals
+    ioopm_hash_table_t *totals = totals_of(index);
+    CU_ASSERT_EQUAL(total_of(totals, "the"), 1);
+    CU_ASSERT_EQUAL(total_of(totals, "cat"), 0);
+    CU_ASSERT_EQUAL(total_of(totals, "dog"), 3);
+    totals_destroy(totals);
+    ioopm_word_index_close(index);
+
+    // the second file is no longer counted, so all of its counts are taken away
+    index = ioopm_word_index_open(index_path, "plain");
+    CU_ASSERT_FALSE(ioopm_word_index_check(index, first_path));
+    CU_ASSERT_TRUE(ioopm_word_index_replace(index, first_path, changed));
+    ioopm_hash_table_t *all = counts_of(total_words, total_counts, 2);
+    CU_ASSERT_TRUE(ioopm_word_index_save(index, all));
+    ioopm_word_index_close(index);
+
+    index = ioopm_word_index_open(index_path, "plain");
+    CU_ASSERT_TRUE(ioopm_word_index_check(index, first_path));
+    CU_ASSERT_FALSE(ioopm_word_index_check(index, second_path));
+    totals = totals_of(index);
+    CU_ASSERT_EQUAL(ioopm_hash_table_size(totals), 2);
+    CU_ASSERT_EQUAL(total_of(totals, "bat"), 1);
+    totals_destroy(totals);
+    ioopm_word_index_close(index);
+
+    ioopm_hash_table_destroy(all);
+    ioopm_hash_table_destroy(changed);
+}
+
+void test_index_damaged()
+{
+    FILE *f = fopen(index_path, "w");
+    fputs("freq-count index 1 plain\nfile 11 1000 0 0 999 first.txt\n2 the\n", f);
+    fclose(f);
+
+    ioopm_word_index_t *index = ioopm_word_index_open(index_path, "plain");
+    CU_ASSERT_FALSE(ioopm_word_index_check(index, first_path));
+    ioopm_hash_table_t *totals = totals_of(index);
+    CU_ASSERT_TRUE(ioopm_hash_table_is_empty(totals));
+    totals_destroy(totals);
+    ioopm_word_index_close(index);
+}
+
+int main()
+{
+    // First we try to set up CUnit, and exit if we fail
+    if (CU_initialize_registry() != CUE_SUCCESS)
+        return CU_get_error();
+
+    // We then create an empty test suite and specify the name and
+    // the init and cleanup functions
+    CU_pSuite my_test_suite = CU_add_suite("Tests for word_index.c", init_suite, clean_suite);
+    if (my_test_suite == NULL)
+    {
+        // If the test suite could not be added, tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // This is where we add the test functions to our test suite.
+    // For each call to CU_add_test we specify the test suite, the
+    // name or description of the test, and the function that runs
+    // the test in question. If you want to add another test, just
+    // copy a line below and change the information
+    if (
+        (CU_add_test(my_test_suite, "Save counts and reuse them for unchanged files", test_index_save_and_reuse) == NULL ||
+         CU_add_test(my_test_suite, "Take away the counts of changed and dropped files", test_index_changes) == NULL ||
+         CU_add_test(my_test_suite, "A damaged index is not used", test_index_damaged) == NULL))
+    {
+        // If adding any of the tests fails, we tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Set the running mode. Use CU_BRM_VERBOSE for maximum output.
+    // Use CU_BRM_NORMAL to only print errors and a summary
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+
+    // This is where the tests are actually run!
+    CU_basic_run_tests();
+
+    // Tear down CUnit before exiting
+    CU_cleanup_registry();
+    return CU_get_error();
+}
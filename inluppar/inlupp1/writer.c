@@ -0,0 +1,184 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "writer.h"
+
+struct writer
+{
+    int fd;
+    char *buffer;
+    size_t size;        // bytes waiting in buffer
+    size_t capacity;
+    bool failed;        // a write has failed, later output is dropped
+};
+
+ioopm_writer_t *ioopm_writer_create(int fd, size_t capacity)
+{
+    ioopm_writer_t *writer = calloc(1, sizeof(ioopm_writer_t));
+    writer->fd = fd;
+    writer->capacity = capacity > 0 ? capacity : 1;
+    writer->buffer = calloc(writer->capacity, 1);
+
+    return writer;
+}
+
+bool ioopm_writer_destroy(ioopm_writer_t *writer)
+{
+    bool success = ioopm_writer_flush(writer);
+
+    free(writer->buffer);
+    free(writer);
+    return success;
+}
+
+// Writes all of text, retrying after partial writes and interrupts
+static void write_all(ioopm_writer_t *writer, const char *text, size_t length)
+{
+    while (length > 0 && !writer->failed)
+    {
+        ssize_t written = write(writer->fd, text, length);
+
+        if (written > 0)
+        {
+            text += written;
+            length -= written;
+        }
+        else if (written == 0 || errno != EINTR)
+        {
+            writer->failed = true;
+        }
+    }
+}
+
+bool ioopm_writer_flush(ioopm_writer_t *writer)
+{
+    write_all(writer, writer->buffer, writer->size);
+    writer->size = 0;
+
+    return !writer->failed;
+}
+
+void ioopm_writer_bytes(ioopm_writer_t *writer, const char *text, size_t length)
+{
+    if (writer->size + length > writer->capacity)
+    {
+        ioopm_writer_flush(writer);
+
+        // too long to be worth copying into the buffer
+        if (length >= writer->capacity)
+        {
+            write_all(writer, text, length);
+            return;
+        }
+    }
+
+    memcpy(writer->buffer + writer->size, text, length);
+    writer->size += length;
+}
+
+void ioopm_writer_string(ioopm_writer_t *writer, const char *string)
+{
+    ioopm_writer_bytes(writer, string, strlen(string));
+}
+
+void ioopm_writer_char(ioopm_writer_t *writer, char c)
+{
+    if (writer->size == writer->capacity)
+    {
+        ioopm_writer_flush(writer);
+    }
+    writer->buffer[writer->size++] = c;
+}
+
+void ioopm_writer_int(ioopm_writer_t *writer, long long value)
+{
+    char digits[24];
+    char *start = digits + sizeof(digits);
+    // negated as unsigned so that the smallest value works too
+    unsigned long long magnitude = value < 0 ? 0ull - (unsigned long long) value : (unsigned long long) value;
+
+    do
+    {
+        *--start = '0' + magnitude % 10;
+        magnitude /= 10;
+    }
+    while (magnitude > 0);
+
+    if (value < 0)
+    {
+        *--start = '-';
+    }
+    ioopm_writer_bytes(writer, start, digits + sizeof(digits) - start);
+}
+
+// The length of the valid UTF-8 sequence at the start of text, or 0 if it is not one.
+// Overlong forms, surrogates and code points past U+10FFFF are not valid.
+static size_t utf8_length(const unsigned char *text)
+{
+    unsigned char lead = text[0];
+    size_t length = lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : 2;
+    // the range of the second byte, which rules out the forms that are not valid
+    unsigned char low = lead == 0xe0 ? 0xa0 : lead == 0xf0 ? 0x90 : 0x80;
+    unsigned char high = lead == 0xed ? 0x9f : lead == 0xf4 ? 0x8f : 0xbf;
+
+    if (lead < 0xc2 || lead > 0xf4 || text[1] < low || text[1] > high)
+    {
+        return 0;
+    }
+    // a '\0' ends the check, since it is no continuation byte
+    for (size_t i = 2; i < length; i++)
+    {
+        if (text[i] < 0x80 || text[i] > 0xbf)
+        {
+            return 0;
+        }
+    }
+    return length;
+}
+
+void ioopm_writer_json_string(ioopm_writer_t *writer, const char *string)
+{
+    static const char hex[] = "0123456789abcdef";
+    const char *plain = string;
+
+    ioopm_writer_char(writer, '"');
+    for (const char *c = string; *c != '\0'; c++)
+    {
+        unsigned char byte = *c;
+        size_t length = byte >= 0x80 ? utf8_length((const unsigned char *) c) : 1;
+
+        if (length > 1)
+        {
+            c += length - 1;
+            continue;
+        }
+        if (byte >= 0x20 && byte < 0x80 && byte != '"' && byte != '\\')
+        {
+            continue;
+        }
+
+        // write the run of characters that need no escape before this one
+        ioopm_writer_bytes(writer, plain, c - plain);
+        plain = c + 1;
+
+        if (byte >= 0x80)
+        {
+            // JSON must be valid Unicode, so a byte outside a valid sequence becomes U+FFFD
+            ioopm_writer_bytes(writer, "\\ufffd", 6);
+        }
+        else if (byte == '"' || byte == '\\')
+        {
+            char escaped[] = {'\\', byte};
+            ioopm_writer_bytes(writer, escaped, 2);
+        }
+        else
+        {
+            char escaped[] = {'\\', 'u', '0', '0', hex[byte >> 4], hex[byte & 15]};
+            ioopm_writer_bytes(writer, escaped, 6);
+        }
+    }
+    ioopm_writer_string(writer, plain);
+    ioopm_writer_char(writer, '"');
+}
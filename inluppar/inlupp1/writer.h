@@ -0,0 +1,62 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file writer.h
+ * @author Tuva Björnberg & Gustav Fridén
+ * @date 29/09-2023
+ * @brief Buffered output (`writer_t`) to a file descriptor for large amounts of text.
+ *
+ * Text is formatted straight into one reusable buffer and written with write(2) when the
+ * buffer is full, so printing a line costs a copy instead of a call to printf. Integers
+ * are formatted by hand and strings can be written quoted for JSON.
+ *
+ * The first failed write is remembered and later output is dropped, so callers can check
+ * for errors once with ioopm_writer_flush.
+ */
+
+typedef struct writer ioopm_writer_t;
+
+/// @brief Creates a writer with a buffer of its own
+/// @param fd the file descriptor written to, which is not closed by the writer
+/// @param capacity the size of the buffer in bytes, at least 1
+/// @return a new writer
+ioopm_writer_t *ioopm_writer_create(int fd, size_t capacity);
+
+/// @brief Flush a writer and return its memory
+/// @param writer the writer to be destroyed
+/// @return false if any write failed
+bool ioopm_writer_destroy(ioopm_writer_t *writer);
+
+/// @brief Write everything in the buffer to the file descriptor
+/// @param writer the writer
+/// @return false if this or an earlier write failed
+bool ioopm_writer_flush(ioopm_writer_t *writer);
+
+/// @brief Add bytes to the output
+/// @param writer the writer
+/// @param text the bytes, which need not end with '\0'
+/// @param length the number of bytes
+void ioopm_writer_bytes(ioopm_writer_t *writer, const char *text, size_t length);
+
+/// @brief Add a string to the output
+/// @param writer the writer
+/// @param string the string
+void ioopm_writer_string(ioopm_writer_t *writer, const char *string);
+
+/// @brief Add a character to the output
+/// @param writer the writer
+/// @param c the character
+void ioopm_writer_char(ioopm_writer_t *writer, char c);
+
+/// @brief Add an integer in decimal to the output
+/// @param writer the writer
+/// @param value the integer
+void ioopm_writer_int(ioopm_writer_t *writer, long long value);
+
+/// @brief Add a string in double quotes to the output, escaped as a JSON string. Valid
+/// UTF-8 is written as it is, and every byte that is not part of a valid sequence as \ufffd.
+/// @param writer the writer
+/// @param string the string
+void ioopm_writer_json_string(ioopm_writer_t *writer, const char *string);
@@ -0,0 +1,175 @@
+#include <CUnit/Basic.h>
+#include "writer.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define Output_Size (1 << 16)
+
+int init_suite(void)
+{
+    return 0;
+}
+
+int clean_suite(void)
+{
+    return 0;
+}
+
+static FILE *file;
+static char output[Output_Size];
+
+static ioopm_writer_t *writer_to_file(size_t capacity)
+{
+    file = tmpfile();
+    return ioopm_writer_create(fileno(file), capacity);
+}
+
+// Destroys the writer and reads back what it wrote
+static char *written_text(ioopm_writer_t *writer)
+{
+    CU_ASSERT_TRUE(ioopm_writer_destroy(writer));
+
+    lseek(fileno(file), 0, SEEK_SET);
+    ssize_t length = read(fileno(file), output, sizeof(output) - 1);
+    output[length > 0 ? length : 0] = '\0';
+    fclose(file);
+
+    return output;
+}
+
+void test_writer_text()
+{
+    ioopm_writer_t *writer = writer_to_file(64);
+
+    ioopm_writer_string(writer, "word");
+    ioopm_writer_char(writer, ':');
+    ioopm_writer_bytes(writer, " 12345", 3);
+    ioopm_writer_char(writer, '\n');
+    CU_ASSERT_STRING_EQUAL(written_text(writer), "word: 12\n");
+
+    // nothing is written until the buffer is full or flushed
+    writer = writer_to_file(64);
+    ioopm_writer_string(writer, "buffered");
+    CU_ASSERT_EQUAL(lseek(fileno(file), 0, SEEK_END), 0);
+    CU_ASSERT_TRUE(ioopm_writer_flush(writer));
+    CU_ASSERT_EQUAL(lseek(fileno(file), 0, SEEK_END), 8);
+    CU_ASSERT_STRING_EQUAL(written_text(writer), "buffered");
+}
+
+void test_writer_small_buffer()
+{
+    ioopm_writer_t *writer = writer_to_file(5);
+    char expected[1000] = "";
+
+    // output both shorter and longer than the buffer
+    for (int i = 0; i < 30; i++)
+    {
+        ioopm_writer_string(writer, i % 3 == 0 ? "a rather long piece of text" : "ab");
+        ioopm_writer_char(writer, '|');
+        strcat(expected, i % 3 == 0 ? "a rather long piece of text|" : "ab|");
+    }
+    CU_ASSERT_STRING_EQUAL(written_text(writer), expected);
+}
+
+void test_writer_int()
+{
+    ioopm_writer_t *writer = writer_to_file(16);
+    long long values[] = {0, 7, -7, 10, 1234567890, -1000, INT_MAX, INT_MIN, LLONG_MAX, LLONG_MIN};
+    char expected[1000] = "";
+
+    for (int i = 0; i < 10; i++)
+    {
+        ioopm_writer_int(writer, values[i]);
+        ioopm_writer_char(writer, ' ');
+        sprintf(expected + strlen(expected), "%lld ", values[i]);
+    }
+    CU_ASSERT_STRING_EQUAL(written_text(writer), expected);
+}
+
+void test_writer_json_string()
+{
+    ioopm_writer_t *writer = writer_to_file(8);
+
+    ioopm_writer_json_string(writer, "plain");
+    ioopm_writer_json_string(writer, "");
+    ioopm_writer_json_string(writer, "say \"hi\"\\\t\x01");
+    ioopm_writer_json_string(writer, "r\xc3\xa4v");
+    CU_ASSERT_STRING_EQUAL(written_text(writer), "\"plain\"\"\"\"say \\\"hi\\\"\\\\\\u0009\\u0001\"\"r\xc3\xa4v\"");
+}
+
+void test_writer_json_invalid_utf8()
+{
+    ioopm_writer_t *writer = writer_to_file(8);
+
+    // Latin-1, a cut off sequence, a stray continuation byte, an overlong '/', a
+    // surrogate and a code point past U+10FFFF, then a four byte sequence that is valid
+    ioopm_writer_json_string(writer, "caf\xe9");
+    ioopm_writer_json_string(writer, "\xe2\x82");
+    ioopm_writer_json_string(writer, "\x80" "a");
+    ioopm_writer_json_string(writer, "\xc0\xaf");
+    ioopm_writer_json_string(writer, "\xed\xa0\x80");
+    ioopm_writer_json_string(writer, "\xf4\x90\x80\x80");
+    ioopm_writer_json_string(writer, "\xf0\x9f\x98\x80");
+    CU_ASSERT_STRING_EQUAL(written_text(writer), "\"caf\\ufffd\"\"\\ufffd\\ufffd\"\"\\ufffda\"\"\\ufffd\\ufffd\"\"\\ufffd\\ufffd\\ufffd\""
+                           "\"\\ufffd\\ufffd\\ufffd\\ufffd\"\"\xf0\x9f\x98\x80\"");
+}
+
+void test_writer_failure()
+{
+    ioopm_writer_t *writer = ioopm_writer_create(-1, 4);
+
+    ioopm_writer_string(writer, "lost");
+    CU_ASSERT_FALSE(ioopm_writer_flush(writer));
+    ioopm_writer_string(writer, "also lost");
+    CU_ASSERT_FALSE(ioopm_writer_destroy(writer));
+}
+
+int main()
+{
+    // First we try to set up CUnit, and exit if we fail
+    if (CU_initialize_registry() != CUE_SUCCESS)
+        return CU_get_error();
+
+    // We then create an empty test suite and specify the name and
+    // the init and cleanup functions
+    CU_pSuite my_test_suite = CU_add_suite("Tests for writer.c", init_suite, clean_suite);
+    if (my_test_suite == NULL)
+    {
+        // If the test suite could not be added, tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // This is where we add the test functions to our test suite.
+    // For each call to CU_add_test we specify the test suite, the
+    // name or description of the test, and the function that runs
+    // the test in question. If you want to add another test, just
+    // copy a line below and change the information
+    if (
+        (CU_add_test(my_test_suite, "Write and flush text", test_writer_text) == NULL ||
+         CU_add_test(my_test_suite, "Text longer than the buffer", test_writer_small_buffer) == NULL ||
+         CU_add_test(my_test_suite, "Format integers", test_writer_int) == NULL ||
+         CU_add_test(my_test_suite, "Escape JSON strings", test_writer_json_string) == NULL ||
+         CU_add_test(my_test_suite, "Replace invalid UTF-8 in JSON strings", test_writer_json_invalid_utf8) == NULL ||
+         CU_add_test(my_test_suite, "Report failed writes", test_writer_failure) == NULL))
+    {
+        // If adding any of the tests fails, we tear down CUnit and exit
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // Set the running mode. Use CU_BRM_VERBOSE for maximum output.
+    // Use CU_BRM_NORMAL to only print errors and a summary
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+
+    // This is where the tests are actually run!
+    CU_basic_run_tests();
+
+    // Tear down CUnit before exiting
+    CU_cleanup_registry();
+    return CU_get_error();
+}
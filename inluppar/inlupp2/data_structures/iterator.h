@@ -24,6 +24,14 @@
 /// @return an iteration positioned at the start of list
 ioopm_list_iterator_t *ioopm_list_iterator(ioopm_list_t *list);
 
+/// @brief Create an iterator that traverses a given list from the last element to the first.
+/// All iterator functions work the same on it, except that next moves towards the start of 
+/// the list and reset repositions the iterator at the last element. Before and after in 
+/// insert_before and insert_after still refer to the order of the list.
+/// @param list the list to be iterated over
+/// @return an iteration positioned at the end of list
+ioopm_list_iterator_t *ioopm_list_reverse_iterator(ioopm_list_t *list);
+
 /// @brief Checks if there are more elements to iterate over
 /// @param iter the iterator
 /// @return true if there is at least one more element 
@@ -34,16 +42,49 @@ bool ioopm_iterator_has_next(ioopm_list_iterator_t *iter);
 /// @return the next element or a void pointer to NULL if list has no next element
 elem_t ioopm_iterator_next(ioopm_list_iterator_t *iter);
 
-/// @brief Reposition the iterator at the start of the underlying list
-/// @param iter the iterator. It is assumed that ioopm_iterator_has_next has been called before 
-/// using this function to ensure that there is a next element.
+/// @brief Reposition the iterator at the start of the underlying list (the end for a reverse iterator)
+/// @param iter the iterator
 void ioopm_iterator_reset(ioopm_list_iterator_t *iter);
 
+/// @brief Checks if the iterator is positioned at an element. It is not when the list 
+/// is empty or when the last element has been removed through the iterator.
+/// @param iter the iterator
+/// @return true if there is a current element
+bool ioopm_iterator_has_current(ioopm_list_iterator_t *iter);
+
 /// @brief Return the current element from the underlying list
 /// @param iter the iterator
 /// @return the current element if list has elements or a void pointer to NULL is list has no current element
 elem_t ioopm_iterator_current(ioopm_list_iterator_t *iter);
 
+/// @brief Replace the current element of the underlying list in O(1) time
+/// @param iter the iterator
+/// @param value the new value of the current element
+/// @return the replaced element or a void pointer to NULL if there is no current element
+elem_t ioopm_iterator_set(ioopm_list_iterator_t *iter, elem_t value);
+
+/// @brief Insert an element before the current element in O(1) time. The iterator 
+/// stays at the same current element. Without a current element the value is appended, 
+/// or prepended for a reverse iterator.
+/// @param iter the iterator
+/// @param value the value to be inserted
+void ioopm_iterator_insert_before(ioopm_list_iterator_t *iter, elem_t value);
+
+/// @brief Insert an element after the current element in O(1) time. The iterator 
+/// stays at the same current element. Without a current element the value is appended, 
+/// or prepended for a reverse iterator.
+/// @param iter the iterator
+/// @param value the value to be inserted
+void ioopm_iterator_insert_after(ioopm_list_iterator_t *iter, elem_t value);
+
+/// @brief Remove the current element in O(1) time. The iterator moves on to the element 
+/// after the removed one (before it for a reverse iterator), or has no current element 
+/// if there is no such element.
+/// Other iterators over the same list must not be used after this call.
+/// @param iter the iterator
+/// @return the removed element or a void pointer to NULL if there is no current element
+elem_t ioopm_iterator_remove(ioopm_list_iterator_t *iter);
+
 /// @brief Destroy the iterator and return its resources
 /// @param iter the iterator
 void ioopm_iterator_destroy(ioopm_list_iterator_t *iter);
\ No newline at end of file
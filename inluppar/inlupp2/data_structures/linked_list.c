@@ -7,12 +7,18 @@
 #include <string.h>
 #include <assert.h>
 
+/// Lists with at least SKIP_MIN_SIZE elements get a skip index holding every
+/// SKIP_STRIDE:th link, used when a lookup by index is far from any known link.
+#define SKIP_STRIDE 32
+#define SKIP_MIN_SIZE 128
+
 typedef struct link link_t;
 
 struct link
 {
     elem_t value;
     struct link *next;
+    struct link *prev;
 };
 struct list
 {
@@ -20,11 +26,18 @@ struct list
     link_t *last;
     size_t size;
     ioopm_eq_function eq_fun; 
+    link_t *cursor;       // last link found by index, NULL when unknown
+    int cursor_index;     // index of cursor
+    link_t **skips;       // skips[i] is the link at index i * SKIP_STRIDE
+    size_t skip_count;    // number of valid entries in skips, 0 after the list has changed
+    size_t skip_capacity;
+    size_t skip_size;     // size of the list when skips was built
 };
 
 struct iter
 {
-    link_t *current;
+    link_t *current; // NULL when positioned after the last element (before the first if reversed)
+    bool reversed;   // true if next moves towards the first element
     ioopm_list_t *list;
 };
 
@@ -42,156 +55,446 @@ void ioopm_linked_list_destroy(ioopm_list_t *list)
     {
         ioopm_linked_list_clear(list);
     }
+    free(list->skips);
     free(list);
 }
 
-static link_t *link_create(elem_t value, link_t *next)
+static link_t *link_create(elem_t value, link_t *prev, link_t *next)
 {
     link_t *new_link = calloc(1, sizeof(link_t));
     new_link->value = value;
+    new_link->prev = prev;
     new_link->next = next;
     return new_link;
 }
 
-void ioopm_linked_list_append(ioopm_list_t *list, elem_t value)
+// Creates a link for value between prev and next, where either may be NULL for the ends
+static link_t *link_insert(ioopm_list_t *list, link_t *prev, link_t *next, elem_t value)
 {
-    link_t *new_link = link_create(value, NULL);
+    link_t *new_link = link_create(value, prev, next);
+
+    if (prev == NULL)
+    {
+        list->first = new_link;
+    }
+    else
+    {
+        prev->next = new_link;
+    }
 
-    if (new_link != NULL) 
+    if (next == NULL)
     {
-        if (list->last == NULL)
+        list->last = new_link;
+    }
+    else
+    {
+        next->prev = new_link;
+    }
+
+    // appending keeps the indices of all other links
+    if (next != NULL)
+    {
+        list->skip_count = 0;
+
+        if (prev == NULL)
         {
-            // if empty list
-            list->first = new_link;
+            list->cursor_index++;
         }
         else
         {
-            // if non-empty list
-            list->last->next = new_link;
+            list->cursor = NULL;
         }
+    }
 
-        list->last = new_link;
-        list->size++;
+    list->size++;
+    return new_link;
+}
+
+// Unlinks and frees a link in O(1) time, returning its value
+static elem_t link_remove(ioopm_list_t *list, link_t *link)
+{
+    elem_t value = link->value;
+
+    list->skip_count = 0;
+    if (link == list->cursor || (link->prev != NULL && link->next != NULL))
+    {
+        list->cursor = NULL;
+    }
+    else if (link->prev == NULL)
+    {
+        list->cursor_index--;
+    }
+
+    if (link->prev == NULL)
+    {
+        list->first = link->next;
+    }
+    else
+    {
+        link->prev->next = link->next;
     }
+
+    if (link->next == NULL)
+    {
+        list->last = link->prev;
+    }
+    else
+    {
+        link->next->prev = link->prev;
+    }
+
+    free(link);
+    list->size--;
+    return value;
 }
 
-void ioopm_linked_list_prepend(ioopm_list_t *list, elem_t value)
+static void skip_index_build(ioopm_list_t *list)
 {
-    link_t *new_link = link_create(value, list->first);
+    size_t count = (list->size + SKIP_STRIDE - 1) / SKIP_STRIDE;
 
-    if (new_link != NULL) 
+    if (count > list->skip_capacity)
     {
-        list->first = new_link;
+        list->skips = realloc(list->skips, count * sizeof(link_t *));
+        list->skip_capacity = count;
+    }
 
-        if (list->last == NULL)
+    link_t *current = list->first;
+    for (size_t i = 0; i < count; i++)
+    {
+        list->skips[i] = current;
+        for (int j = 0; j < SKIP_STRIDE && current != NULL; j++)
         {
-            // if empty list
-            list->last = new_link;
+            current = current->next;
         }
+    }
+
+    list->skip_count = count;
+    list->skip_size = list->size;
+}
 
-        list->size++;
+// Finds the link at a valid index. The walk starts from the closest of the first link,
+// the last link and the link found by the previous lookup, so looking up consecutive
+// indices takes O(1) time each. Long jumps on long lists start from the skip index.
+static link_t *link_at(ioopm_list_t *list, int index)
+{
+    int size = list->size;
+    link_t *current = list->first;
+    int position = 0;
+
+    if (size - 1 - index < index)
+    {
+        current = list->last;
+        position = size - 1;
+    }
+
+    if (list->cursor != NULL && abs(index - list->cursor_index) < abs(index - position))
+    {
+        current = list->cursor;
+        position = list->cursor_index;
+    }
+
+    if (abs(index - position) > SKIP_STRIDE && size >= SKIP_MIN_SIZE)
+    {
+        if (list->skip_count == 0 || index >= list->skip_size)
+        {
+            skip_index_build(list);
+        }
+
+        current = list->skips[index / SKIP_STRIDE];
+        position = index - index % SKIP_STRIDE;
     }
+
+    for (; position < index; position++)
+    {
+        current = current->next;
+    }
+    for (; position > index; position--)
+    {
+        current = current->prev;
+    }
+
+    list->cursor = current;
+    list->cursor_index = index;
+    return current;
+}
+
+void ioopm_linked_list_append(ioopm_list_t *list, elem_t value)
+{
+    link_insert(list, list->last, NULL, value);
+}
+
+void ioopm_linked_list_prepend(ioopm_list_t *list, elem_t value)
+{
+    link_insert(list, NULL, list->first, value);
 }
 
 void ioopm_linked_list_insert(ioopm_list_t *list, int index, elem_t value)
 {
-    link_t *current = list->first;
-    int counter = 0;
     size_t linked_list_size = ioopm_linked_list_size(list);
 
     if (index < 0 || index > linked_list_size)
     {
         return;
     }
-    else if (index == 0)
-    {
-        ioopm_linked_list_prepend(list, value);
-    }
     else if (index == linked_list_size)
     {
         ioopm_linked_list_append(list, value);
     }
     else
     {
-        while (index > 0 && index < linked_list_size - 1 && counter < index)
+        link_t *next = link_at(list, index);
+
+        list->cursor = link_insert(list, next->prev, next, value);
+        list->cursor_index = index;
+    }
+}
+
+void ioopm_linked_list_insert_sorted(ioopm_list_t *list, elem_t value, ioopm_cmp_function cmp_fun)
+{
+    link_t *next = NULL;
+
+    // values not smaller than the last element, as when loading sorted data, are appended directly
+    if (list->last != NULL && cmp_fun(list->last->value, value) > 0)
+    {
+        next = list->first;
+        while (cmp_fun(next->value, value) <= 0)
         {
-            if (counter == index - 1)
-            {
-                link_t *new_link = link_create(value, NULL);
-                link_t *tmp = current->next;
-                current->next = new_link;
-                new_link->next = tmp;
-                list->size++;
-            }
-            counter++;
-            current = current->next;
+            next = next->next;
         }
     }
+
+    link_insert(list, next == NULL ? list->last : next->prev, next, value);
 }
 
 elem_t ioopm_linked_list_remove(ioopm_list_t *list, int index)
 {
-    link_t *current = list->first;
-    int counter = 0;
+    if (list == NULL || index < 0 || index >= ioopm_linked_list_size(list))
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+
+    link_t *link = link_at(list, index);
+    link_t *next = link->next;
+    elem_t value = link_remove(list, link);
+
+    // the link after the removed one takes its index
+    list->cursor = next;
+    list->cursor_index = index;
+    return value;
+}
+
+elem_t ioopm_linked_list_remove_last(ioopm_list_t *list)
+{
+    if (list->last == NULL)
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+
+    return link_remove(list, list->last);
+}
+
+// Moves the links of src between prev and next in list, leaving src empty
+static void chain_insert(ioopm_list_t *list, link_t *prev, link_t *next, ioopm_list_t *src)
+{
+    src->first->prev = prev;
+    src->last->next = next;
+
+    if (prev == NULL)
+    {
+        list->first = src->first;
+    }
+    else
+    {
+        prev->next = src->first;
+    }
+
+    if (next == NULL)
+    {
+        list->last = src->last;
+    }
+    else
+    {
+        next->prev = src->last;
+    }
+
+    list->size += src->size;
+
+    src->first = NULL;
+    src->last = NULL;
+    src->size = 0;
+    src->cursor = NULL;
+    src->skip_count = 0;
+}
+
+void ioopm_linked_list_concat(ioopm_list_t *list, ioopm_list_t *src)
+{
+    if (list == src || src->first == NULL)
+    {
+        return;
+    }
+
+    // appending keeps the cursor and skip index valid
+    chain_insert(list, list->last, NULL, src);
+}
+
+void ioopm_linked_list_splice(ioopm_list_t *list, int index, ioopm_list_t *src)
+{
     size_t linked_list_size = ioopm_linked_list_size(list);
-    elem_t value = {.void_ptr = NULL};
 
-    if (list != NULL)
+    if (list == src || src->first == NULL || index < 0 || index > linked_list_size)
     {
-        if (index < 0 || index >= linked_list_size)
-        {
-            return (elem_t){.void_ptr = NULL};
-        }
-        // first index
-        else if (index == 0)
+        return;
+    }
+    else if (index == linked_list_size)
+    {
+        ioopm_linked_list_concat(list, src);
+        return;
+    }
+
+    link_t *next = link_at(list, index);
+
+    chain_insert(list, next->prev, next, src);
+    list->cursor = NULL;
+    list->skip_count = 0;
+}
+
+ioopm_list_t *ioopm_linked_list_split_at(ioopm_list_t *list, int index)
+{
+    size_t linked_list_size = ioopm_linked_list_size(list);
+
+    if (index < 0 || index > linked_list_size)
+    {
+        return NULL;
+    }
+
+    ioopm_list_t *rest = ioopm_linked_list_create(list->eq_fun);
+
+    if (index == linked_list_size)
+    {
+        return rest;
+    }
+
+    link_t *first = link_at(list, index);
+
+    rest->first = first;
+    rest->last = list->last;
+    rest->size = linked_list_size - index;
+
+    list->last = first->prev;
+    if (list->last == NULL)
+    {
+        list->first = NULL;
+    }
+    else
+    {
+        list->last->next = NULL;
+    }
+    first->prev = NULL;
+
+    list->size = index;
+    list->cursor = NULL;
+    list->skip_count = 0;
+
+    return rest;
+}
+
+elem_t ioopm_linked_list_get(ioopm_list_t *list, int index)
+{
+    // if correct index input
+    if (index >= 0 && index < ioopm_linked_list_size(list)) 
+    {
+        return link_at(list, index)->value;
+    }
+    else
+    {
+        return (elem_t){.void_ptr = NULL};
+    }
+}
+
+// Cuts a chain of links after count links and returns the rest of the chain
+static link_t *chain_split(link_t *chain, size_t count)
+{
+    for (size_t i = 1; chain != NULL && i < count; i++)
+    {
+        chain = chain->next;
+    }
+
+    if (chain == NULL)
+    {
+        return NULL;
+    }
+
+    link_t *rest = chain->next;
+    chain->next = NULL;
+    return rest;
+}
+
+// Merges two sorted chains into *out, taking from left on ties to keep the sort stable.
+// Returns the last link of the merged chain.
+static link_t *chain_merge(link_t *left, link_t *right, ioopm_cmp_function cmp_fun, link_t **out)
+{
+    link_t *last = NULL;
+
+    while (left != NULL && right != NULL)
+    {
+        if (cmp_fun(right->value, left->value) < 0)
         {
-            value = list->first->value;
-            link_t *tmp = list->first->next;
-            free(list->first);
-            list->first = tmp;
-            list->size--;
+            *out = right;
+            right = right->next;
         }
         else
         {
-            while (index > 0 && index < linked_list_size && counter < index)
-            {
-                // middle and last index
-                if (counter == index - 1)
-                {
-                    value = current->next->value;
-                    link_t *tmp = current->next->next;
-                    free(current->next);
-                    current->next = tmp;
-                    list->size--;
-                }
-
-                counter++;
-                current = current->next;
-            }
+            *out = left;
+            left = left->next;
         }
+        last = *out;
+        out = &last->next;
     }
-    return value;
+
+    *out = left != NULL ? left : right;
+    while (*out != NULL)
+    {
+        last = *out;
+        out = &last->next;
+    }
+
+    return last;
 }
 
-elem_t ioopm_linked_list_get(ioopm_list_t *list, int index)
+void ioopm_linked_list_sort(ioopm_list_t *list, ioopm_cmp_function cmp_fun)
 {
-    link_t *current = list->first;
-    int counter = 0;
-    // if correct index input
-    if (index >= 0 && index < ioopm_linked_list_size(list)) 
+    if (list->size < 2)
+    {
+        return;
+    }
+
+    // bottom-up: merge neighbouring sorted runs of width 1, 2, 4, ... following only next
+    link_t *head = list->first;
+    for (size_t width = 1; width < list->size; width *= 2)
     {
-        while (counter != index)
+        link_t *rest = head;
+        link_t *tail = NULL;
+
+        while (rest != NULL)
         {
-            current = current->next;
-            counter++;
+            link_t *left = rest;
+            link_t *right = chain_split(left, width);
+            rest = chain_split(right, width);
+            tail = chain_merge(left, right, cmp_fun, tail == NULL ? &head : &tail->next);
         }
-
-        return current->value;
     }
-    else
+
+    link_t *prev = NULL;
+    for (link_t *current = head; current != NULL; current = current->next)
     {
-        return (elem_t){.void_ptr = NULL};
+        current->prev = prev;
+        prev = current;
     }
+
+    list->first = head;
+    list->last = prev;
+    list->cursor = NULL;
+    list->skip_count = 0;
 }
 
 bool ioopm_linked_list_contains(ioopm_list_t *list, elem_t element)
@@ -232,6 +535,11 @@ void ioopm_linked_list_clear(ioopm_list_t *list)
         current = next;
         list->size--;
     }
+
+    list->first = NULL;
+    list->last = NULL;
+    list->cursor = NULL;
+    list->skip_count = 0;
 }
 
 bool ioopm_linked_list_all(ioopm_list_t *list, ioopm_int_predicate prop, void *extra)
@@ -285,15 +593,33 @@ ioopm_list_iterator_t *ioopm_list_iterator(ioopm_list_t *list)
 
     iter->list = list;
     iter->current = list->first;
+    iter->reversed = false;
 
     return iter;
 }
 
+ioopm_list_iterator_t *ioopm_list_reverse_iterator(ioopm_list_t *list)
+{
+    ioopm_list_iterator_t *iter = calloc(1, sizeof(ioopm_list_iterator_t));
+
+    iter->list = list;
+    iter->current = list->last;
+    iter->reversed = true;
+
+    return iter;
+}
+
+// The link after current in the direction of the iterator
+static link_t *iterator_step(ioopm_list_iterator_t *iter, link_t *link)
+{
+    return iter->reversed ? link->prev : link->next;
+}
+
 bool ioopm_iterator_has_next(ioopm_list_iterator_t *iter)
 {
     if (iter->current != NULL)
     {
-        return iter->current->next != NULL;
+        return iterator_step(iter, iter->current) != NULL;
     }
     else
     {
@@ -309,33 +635,89 @@ elem_t ioopm_iterator_next(ioopm_list_iterator_t *iter)
         return (elem_t){.void_ptr = NULL};
     }
 
-    iter->current = iter->current->next;
+    iter->current = iterator_step(iter, iter->current);
     return iter->current->value;
 }
 
 void ioopm_iterator_reset(ioopm_list_iterator_t *iter)
+{
+    iter->current = iter->reversed ? iter->list->last : iter->list->first;
+}
+
+bool ioopm_iterator_has_current(ioopm_list_iterator_t *iter)
+{
+    return iter->current != NULL;
+}
+
+elem_t ioopm_iterator_current(ioopm_list_iterator_t *iter)
 {
     if (iter->current != NULL)
     {
-        iter->current = iter->list->first;
+        return iter->current->value;
     }
     else
     {
-        iter->list->first = NULL;
+        return (elem_t){.void_ptr = NULL};
     }
 }
 
-elem_t ioopm_iterator_current(ioopm_list_iterator_t *iter)
+elem_t ioopm_iterator_set(ioopm_list_iterator_t *iter, elem_t value)
 {
-    if (iter->current != NULL)
+    if (iter->current == NULL)
     {
-        return iter->current->value;
+        return (elem_t){.void_ptr = NULL};
     }
-    else
+
+    elem_t old_value = iter->current->value;
+    iter->current->value = value;
+    return old_value;
+}
+
+void ioopm_iterator_insert_before(ioopm_list_iterator_t *iter, elem_t value)
+{
+    ioopm_list_t *list = iter->list;
+
+    if (iter->current == NULL)
+    {
+        // past the end the iterator walked off
+        if (iter->reversed)
+        {
+            ioopm_linked_list_prepend(list, value);
+        }
+        else
+        {
+            ioopm_linked_list_append(list, value);
+        }
+        return;
+    }
+
+    link_insert(list, iter->current->prev, iter->current, value);
+}
+
+void ioopm_iterator_insert_after(ioopm_list_iterator_t *iter, elem_t value)
+{
+    if (iter->current == NULL)
+    {
+        ioopm_iterator_insert_before(iter, value);
+        return;
+    }
+
+    link_insert(iter->list, iter->current, iter->current->next, value);
+}
+
+elem_t ioopm_iterator_remove(ioopm_list_iterator_t *iter)
+{
+    link_t *current = iter->current;
+
+    if (current == NULL)
     {
         return (elem_t){.void_ptr = NULL};
     }
+
+    iter->current = iterator_step(iter, current);
+    return link_remove(iter->list, current);
 }
+
 void ioopm_iterator_destroy(ioopm_list_iterator_t *iter)
 {
     free(iter);
@@ -12,7 +12,7 @@
  * @date 29/09-2023
  * @brief The program includes functions to create and destroy a linked list, perform various operations. 
  *
- * The linked list is implemented using a singly linked structure (`link_t`) with a `list_t` 
+ * The linked list is implemented using a doubly linked structure (`link_t`) with a `list_t` 
  * structure holding the first and last links, the size, and an equality function. 
  * 
  * The linked list assumes a suitable equality function to fit the ioopm_eq_function in common.h 
@@ -58,6 +58,13 @@ void ioopm_linked_list_prepend(ioopm_list_t *list, elem_t value);
 /// @param value the value to be inserted 
 void ioopm_linked_list_insert(ioopm_list_t *list, int index, elem_t value);
 
+/// @brief Insert an element into a sorted linked list in O(n) time, after every element that 
+/// is not greater than it, so the list stays sorted. Inserting at the end is O(1).
+/// @param list the linked list, sorted in ascending order by cmp_fun
+/// @param value the value to be inserted
+/// @param cmp_fun a compare function returning <0, 0 or >0 like strcmp
+void ioopm_linked_list_insert_sorted(ioopm_list_t *list, elem_t value, ioopm_cmp_function cmp_fun);
+
 /// @brief Remove an element from a linked list in O(n) time.
 /// The valid values of index are [0,n-1] for a list of n elements,
 /// where 0 means the first element and n-1 means the last element.
@@ -66,7 +73,37 @@ void ioopm_linked_list_insert(ioopm_list_t *list, int index, elem_t value);
 /// @return the value removed
 elem_t ioopm_linked_list_remove(ioopm_list_t *list, int index);
 
-/// @brief Retrieve an element from a linked list in O(n) time.
+/// @brief Remove the last element from a linked list in O(1) time.
+/// @param list the linked list
+/// @return the value removed or a void pointer to NULL if the list is empty
+elem_t ioopm_linked_list_remove_last(ioopm_list_t *list);
+
+/// @brief Move all elements of src to the end of a linked list in O(1) time, without 
+/// allocating or copying. src is left empty but must still be destroyed.
+/// @param list the linked list that will be extended
+/// @param src the linked list whose elements are moved, must not be list
+void ioopm_linked_list_concat(ioopm_list_t *list, ioopm_list_t *src);
+
+/// @brief Move all elements of src into a linked list before the element at index, without 
+/// allocating or copying. It takes O(1) time at the ends of the list and otherwise the time 
+/// of finding index. src is left empty but must still be destroyed.
+/// The valid values of index are [0,n] for a list of n elements.
+/// @param list the linked list that will be extended
+/// @param index the position in the list
+/// @param src the linked list whose elements are moved, must not be list
+void ioopm_linked_list_splice(ioopm_list_t *list, int index, ioopm_list_t *src);
+
+/// @brief Split a linked list in two, without copying the elements. The list keeps the 
+/// elements before index and the rest are moved to a new list with the same equality function. 
+/// The valid values of index are [0,n] for a list of n elements.
+/// @param list the linked list to split
+/// @param index the position of the first element of the new list
+/// @return a new list with the elements from index onwards, or NULL if invalid index
+ioopm_list_t *ioopm_linked_list_split_at(ioopm_list_t *list, int index);
+
+/// @brief Retrieve an element from a linked list in O(n) time. The list remembers the last 
+/// position looked up, so getting the indices of a list in order takes O(1) time per call, 
+/// and keeps a skip index that shortens long jumps in long lists.
 /// The valid values of index are [0,n-1] for a list of n elements,
 /// where 0 means the first element and n-1 means the last element.
 /// @param list the linked list that will be extended
@@ -114,4 +151,10 @@ bool ioopm_linked_list_any(ioopm_list_t *list, ioopm_int_predicate prop, void *e
 /// @param list the linked list
 /// @param fun the function to be applied
 /// @param extra an additional argument (may be NULL) that will be passed to all internal calls of fun
-void ioopm_linked_list_apply_to_all(ioopm_list_t *list, ioopm_apply_int_function fun, void *extra);
\ No newline at end of file
+void ioopm_linked_list_apply_to_all(ioopm_list_t *list, ioopm_apply_int_function fun, void *extra);
+
+/// @brief Sort a linked list in ascending order in O(n log n) time. The sort is stable, 
+/// so equal elements keep their order, and the links are relinked in place without allocating.
+/// @param list the linked list
+/// @param cmp_fun a compare function returning <0, 0 or >0 like strcmp
+void ioopm_linked_list_sort(ioopm_list_t *list, ioopm_cmp_function cmp_fun);
\ No newline at end of file
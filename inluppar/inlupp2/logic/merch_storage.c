@@ -202,33 +202,15 @@ static int stock_size_get(ioopm_merch_t *merch)
     return merch->stock_size; 
 }
 
-static void location_insert(ioopm_merch_t *merch, location_t *location)
+static int location_cmp(elem_t a, elem_t b)
 {
-    ioopm_list_t *stock = merch->stock;
-
-    if (ioopm_linked_list_is_empty(stock) || strcmp(location->shelf, shelf_get(ioopm_linked_list_get(stock, 0).void_ptr)) < 0)
-    {
-        ioopm_linked_list_prepend(stock, void_elem(location));
-    }
-    else
-    {
-        size_t index = 0;
-
-        while (index < ioopm_linked_list_size(stock) - 1)
-        {
-            location_t *current_location = (location_t *)ioopm_linked_list_get(stock, index).void_ptr;
-            location_t *next_location = (location_t *)ioopm_linked_list_get(stock, index + 1).void_ptr;
-
-            if (strcmp(location->shelf, current_location->shelf) >= 0 && strcmp(location->shelf, next_location->shelf) < 0)
-            {
-                ioopm_linked_list_insert(stock, index + 1, void_elem(location));
-                return;
-            }
+    return strcmp(shelf_get(a.void_ptr), shelf_get(b.void_ptr));
+}
 
-            index++;
-        }
-        ioopm_linked_list_append(stock, void_elem(location));
-    }
+// Inserts a location after the locations with smaller shelves, keeping the stock sorted
+static void location_insert(ioopm_merch_t *merch, location_t *location)
+{
+    ioopm_linked_list_insert_sorted(merch->stock, void_elem(location), location_cmp);
 }
 
 void ioopm_location_add(ioopm_merch_t *merch, char *shelf, int amount)
@@ -116,32 +116,34 @@ int ioopm_cost_calculate(ioopm_store_t *store, ioopm_carts_t *storage_carts, int
     return total_cost;
 }
 
+// Takes amount items from the last shelves first, removing the shelves that are emptied.
 static void stock_update(elem_t name, elem_t *amount, void *store)
 {
   ioopm_merch_t *merch = ioopm_merch_get(store, name.string);
   merch->reserved_stock -= amount->integer;
   merch->stock_size -= amount->integer;
 
-  ioopm_list_t *stock = merch->stock;
+  ioopm_list_iterator_t *iter = ioopm_list_reverse_iterator(merch->stock);
+  int remaining = amount->integer;
 
-  for (int i = ioopm_linked_list_size(stock) - 1; i >= 0; i--)
+  while (ioopm_iterator_has_current(iter))
   {
-    location_t *shelf = ioopm_linked_list_get(stock, i).void_ptr;
-    
-    if (amount->integer > shelf->quantity) 
-    {
-      amount->integer -= shelf->quantity;
+    location_t *shelf = ioopm_iterator_current(iter).void_ptr;
 
+    if (remaining > shelf->quantity) 
+    {
+      remaining -= shelf->quantity;
       free(shelf->shelf);
       free(shelf);
-      ioopm_linked_list_remove(stock, i);
+      ioopm_iterator_remove(iter);
     } 
     else 
     {
-      shelf->quantity -= amount->integer;
-      return;
+      shelf->quantity -= remaining;
+      break;
     }
   }
+  ioopm_iterator_destroy(iter);
 }
 
 void ioopm_cart_checkout(ioopm_store_t *store, ioopm_carts_t *storage_carts, int id)
@@ -203,6 +203,29 @@ void checkout_cart_test()
     ioopm_store_destroy(store); 
 }
 
+void checkout_shelves_test()
+{
+    ioopm_carts_t *storage_carts = ioopm_cart_storage_create(); 
+    ioopm_store_t *store = store_with_inputs(); 
+    ioopm_cart_create(storage_carts); 
+    storage_carts->total_carts++; 
+
+    ioopm_merch_t *apple = ioopm_merch_get(store, "Apple"); 
+
+    // shelves are A4: 4, B36: 0, R62: 1, and the last shelves are emptied first
+    ioopm_cart_add(storage_carts, 0, apple->name, 2); 
+    ioopm_cart_checkout(store, storage_carts, 0); 
+
+    CU_ASSERT_EQUAL(ioopm_linked_list_size(apple->stock), 1); 
+    location_t *location = ioopm_linked_list_get(apple->stock, 0).void_ptr; 
+    CU_ASSERT_STRING_EQUAL(location->shelf, "A4"); 
+    CU_ASSERT_EQUAL(location->quantity, 3); 
+    CU_ASSERT_EQUAL(apple->stock_size, 3);
+
+    ioopm_cart_storage_destroy(storage_carts); 
+    ioopm_store_destroy(store); 
+}
+
 int main()
 {
     // First we try to set up CUnit, and exit if we fail
@@ -232,6 +255,7 @@ int main()
          CU_add_test(my_test_suite, "Has merch in cart test", has_merch_in_cart_test) == NULL ||
          CU_add_test(my_test_suite, "Calculate total in cart", cost_calculate_test) == NULL ||
          CU_add_test(my_test_suite, "Checkout cart test", checkout_cart_test) == NULL ||
+         CU_add_test(my_test_suite, "Checkout empties the last shelves first", checkout_shelves_test) == NULL ||
          CU_add_test(my_test_suite, "Test for removing a cart with items", remove_cart_test) == NULL
         )
     )